@@ -0,0 +1,858 @@
+/*
+* File: nav_grid.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program finds walking paths for mobs over the block grid in two
+			   levels. Mobs walk on the top surface of each column, stepping up or
+			   down one block at a time. Every chunk is a cluster of an abstract graph
+			   whose nodes are portals where walkable ground crosses a chunk border,
+			   and the walking cost between the portals of a chunk is cached. A path
+			   is searched over the portals first and only then walked out cell by
+			   cell with jump point search inside each chunk it crosses. Changed
+			   columns only rebuild the portals and costs of their own chunk and the
+			   borders they lie on
+*/
+
+#ifndef NAV_GRID_H
+#define NAV_GRID_H
+
+#include "../world/chunk.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Scratch memory of one path search, each thread searching at once needs its own
+class NavSearch
+{
+private:
+	friend class NavGrid;
+
+	static constexpr int cells{ Chunk::sizeX * Chunk::sizeZ };
+
+	struct Entry
+	{
+		float priority{};
+		float cost{};
+		int node{};
+
+		bool operator>(const Entry& other) const
+		{
+			return priority > other.priority;
+		}
+	};
+
+	// Within one chunk, indexed by local cell
+	float m_cost[cells]{};
+	int m_parent[cells]{};
+	float m_startCosts[cells]{};
+	float m_goalCosts[cells]{};
+
+	// Over the portal graph, entries older than the current generation count as unvisited
+	std::vector<float> m_nodeCost{};
+	std::vector<int> m_nodeParent{};
+	std::vector<std::uint32_t> m_nodeGeneration{};
+	std::uint32_t m_generation{ 0 };
+
+	// Cells of the flood by whole units of cost, a step is never worth two units
+	static constexpr int bucketCount{ 3 };
+	std::vector<int> m_buckets[bucketCount]{};
+
+	std::vector<Entry> m_open{};
+	std::vector<int> m_portals{};
+	std::vector<int> m_jumpPoints{};
+};
+
+class NavGrid
+{
+public:
+	// Height marking a column nothing can stand on, a pool of lava or no ground at all
+	static constexpr std::int8_t blocked{ std::numeric_limits<std::int8_t>::min() };
+	// Highest step up or down between neighbouring columns
+	static constexpr int maxStep{ 1 };
+
+	/*
+	* Adds or replaces the walkable surface of a loaded chunk. Takes effect at the next rebuild
+	* Parameters:
+	* - chunk: The loaded chunk
+	* Returns: void
+	*/
+	void addChunk(const Chunk& chunk)
+	{
+		NavChunk& nav{ m_chunks[chunk.coord] };
+		for (int z{ 0 }; z < Chunk::sizeZ; ++z)
+			for (int x{ 0 }; x < Chunk::sizeX; ++x)
+				nav.heights[cellIndex(x, z)] = surfaceOf(chunk, x, z);
+
+		markChunk(chunk.coord, nav);
+		nav.eastDirty = true;
+		nav.southDirty = true;
+		markBorder(ChunkCoord{ chunk.coord.x - 1, chunk.coord.z }, true);
+		markBorder(ChunkCoord{ chunk.coord.x, chunk.coord.z - 1 }, false);
+	}
+
+	/*
+	* Drops an unloaded chunk along with every portal leading into it, right away
+	* Parameters:
+	* - coord: Coordinate of the chunk
+	* Returns: void
+	*/
+	void removeChunk(const ChunkCoord& coord)
+	{
+		auto found{ m_chunks.find(coord) };
+		if (found == m_chunks.end())
+			return;
+
+		clearBorder(coord, true);
+		clearBorder(coord, false);
+		clearBorder(ChunkCoord{ coord.x - 1, coord.z }, true);
+		clearBorder(ChunkCoord{ coord.x, coord.z - 1 }, false);
+		m_chunks.erase(coord);
+	}
+
+	/*
+	* Re-reads one column after a block in it changed. Nothing is invalidated unless the
+	* surface moved, and only borders the column lies on are rebuilt
+	* Parameters:
+	* - chunk: The loaded chunk holding the column
+	* - x: Local x of the column
+	* - z: Local z of the column
+	* Returns: void
+	*/
+	void updateColumn(const Chunk& chunk, int x, int z)
+	{
+		auto found{ m_chunks.find(chunk.coord) };
+		if (found == m_chunks.end())
+			return;
+
+		NavChunk& nav{ found->second };
+		std::int8_t height{ surfaceOf(chunk, x, z) };
+		if (nav.heights[cellIndex(x, z)] == height)
+			return;
+
+		nav.heights[cellIndex(x, z)] = height;
+		markChunk(chunk.coord, nav);
+		if (x == Chunk::sizeX - 1)
+			nav.eastDirty = true;
+		if (z == Chunk::sizeZ - 1)
+			nav.southDirty = true;
+		if (x == 0)
+			markBorder(ChunkCoord{ chunk.coord.x - 1, chunk.coord.z }, true);
+		if (z == 0)
+			markBorder(ChunkCoord{ chunk.coord.x, chunk.coord.z - 1 }, false);
+	}
+
+	/*
+	* Rebuilds the portals of changed borders and the cached costs of changed chunks. Must
+	* not run while paths are being searched
+	* Parameters: None
+	* Returns: void
+	*/
+	void rebuild()
+	{
+		// Rebuilding a border dirties the chunks on both sides, which are appended to the list
+		for (std::size_t i{ 0 }; i < m_dirty.size(); ++i)
+		{
+			auto found{ m_chunks.find(m_dirty[i]) };
+			if (found == m_chunks.end())
+				continue;
+
+			if (found->second.eastDirty)
+				buildBorder(m_dirty[i], true);
+			if (found->second.southDirty)
+				buildBorder(m_dirty[i], false);
+		}
+
+		for (const ChunkCoord& coord : m_dirty)
+		{
+			auto found{ m_chunks.find(coord) };
+			if (found == m_chunks.end() || !found->second.queued)
+				continue;
+
+			buildMoves(found->second);
+			buildEdges(found->second);
+			found->second.queued = false;
+			++m_rebuiltChunks;
+		}
+		m_dirty.clear();
+	}
+
+	/*
+	* Finds a shortest walk over the portal graph and walks it out cell by cell. Only reads
+	* the grid, so any number of threads may search at once with their own scratch, but
+	* changes must have been rebuilt first
+	* Parameters:
+	* - start: World block the mob stands in, only x and z are used
+	* - goal: World block to walk to, only x and z are used
+	* - path: Receives every column stepped on from start to goal, y is the block stood in
+	* - search: Scratch memory of the calling thread
+	* Returns: False if either end isn't walkable or loaded, or no path connects them
+	*/
+	bool findPath(const glm::ivec3& start, const glm::ivec3& goal, std::vector<glm::ivec3>& path, NavSearch& search) const
+	{
+		path.clear();
+
+		ChunkCoord startCoord{ Chunk::floorDiv(start.x, Chunk::sizeX), Chunk::floorDiv(start.z, Chunk::sizeZ) };
+		ChunkCoord goalCoord{ Chunk::floorDiv(goal.x, Chunk::sizeX), Chunk::floorDiv(goal.z, Chunk::sizeZ) };
+		auto startChunk{ m_chunks.find(startCoord) };
+		auto goalChunk{ m_chunks.find(goalCoord) };
+		if (startChunk == m_chunks.end() || goalChunk == m_chunks.end())
+			return false;
+
+		int startCell{ cellIndex(start.x - startCoord.x * Chunk::sizeX, start.z - startCoord.z * Chunk::sizeZ) };
+		int goalCell{ cellIndex(goal.x - goalCoord.x * Chunk::sizeX, goal.z - goalCoord.z * Chunk::sizeZ) };
+		const NavChunk& startNav{ startChunk->second };
+		const NavChunk& goalNav{ goalChunk->second };
+		if (startNav.heights[startCell] == blocked || goalNav.heights[goalCell] == blocked)
+			return false;
+
+		// Costs from the start to its chunk's portals and from the goal chunk's portals to the goal
+		flood(startNav.moves, startCell, search.m_startCosts, search);
+		flood(goalNav.moves, goalCell, search.m_goalCosts, search);
+
+		const int startNode{ static_cast<int>(m_nodes.size()) };
+		float best{ infinity };
+		int goalParent{ -1 };
+		if (startCoord == goalCoord && search.m_goalCosts[startCell] < infinity)
+		{
+			best = search.m_goalCosts[startCell];
+			goalParent = startNode;
+		}
+
+		searchPortals(startNav, goalCoord, goal, best, goalParent, search);
+		if (goalParent < 0)
+			return false;
+
+		// Portals from the goal back to the start
+		search.m_portals.clear();
+		for (int node{ goalParent }; node != startNode; node = search.m_nodeParent[node])
+			search.m_portals.push_back(node);
+
+		path.push_back(glm::ivec3(start.x, startNav.heights[startCell], start.z));
+		ChunkCoord fromCoord{ startCoord };
+		const NavChunk* fromNav{ &startNav };
+		int fromCell{ startCell };
+		for (auto it{ search.m_portals.rbegin() }; it != search.m_portals.rend(); ++it)
+		{
+			const Node& node{ m_nodes[*it] };
+			if (node.chunk != fromCoord)
+			{
+				// Crossing a border is a single step into the partner portal
+				fromCoord = node.chunk;
+				fromNav = &m_chunks.find(fromCoord)->second;
+				fromCell = node.cell;
+				appendCell(fromCoord, fromCell, fromNav->heights, path);
+				continue;
+			}
+
+			walkChunk(fromCoord, *fromNav, fromCell, node.cell, path, search);
+			fromCell = node.cell;
+		}
+		walkChunk(fromCoord, *fromNav, fromCell, goalCell, path, search);
+		return true;
+	}
+
+	std::size_t getChunkCount() const
+	{
+		return m_chunks.size();
+	}
+
+	// Portals in the abstract graph, each border crossing counts one on either side
+	int getNodeCount() const
+	{
+		return static_cast<int>(m_nodes.size() - m_freeNodes.size());
+	}
+
+	// Chunks whose cached costs were rebuilt since creation
+	int getRebuiltCount() const
+	{
+		return m_rebuiltChunks;
+	}
+
+	/*
+	* Reads the height a mob stands at on a column
+	* Parameters:
+	* - x: World block x-coordinate
+	* - z: World block z-coordinate
+	* Returns: World y of the block stood in, blocked if nothing can stand there or it isn't loaded
+	*/
+	int getHeight(int x, int z) const
+	{
+		ChunkCoord coord{ Chunk::floorDiv(x, Chunk::sizeX), Chunk::floorDiv(z, Chunk::sizeZ) };
+		auto found{ m_chunks.find(coord) };
+		if (found == m_chunks.end())
+			return blocked;
+		return found->second.heights[cellIndex(x - coord.x * Chunk::sizeX, z - coord.z * Chunk::sizeZ)];
+	}
+
+private:
+	static constexpr int cells{ NavSearch::cells };
+	static constexpr float infinity{ std::numeric_limits<float>::infinity() };
+	static constexpr float diagonalCost{ 1.41421356f };
+	// Walkable runs along a border at least this long get a portal at both ends instead of one in the middle
+	static constexpr int longRun{ 6 };
+
+	struct Edge
+	{
+		int node{};
+		float cost{};
+	};
+
+	struct Node
+	{
+		ChunkCoord chunk{};
+		int cell{};
+		// True for portals on the chunk's east or south border, false for the west or north one
+		bool outgoing{};
+		bool east{};
+		// Portal on the other side of the border, one step away
+		int partner{ -1 };
+		// Cached walking costs to the other portals of the chunk
+		std::vector<Edge> edges{};
+	};
+
+	struct NavChunk
+	{
+		std::int8_t heights[cells]{};
+		// Bit per direction a mob can move in from each cell, see moveBit
+		std::uint16_t moves[cells]{};
+		std::vector<int> nodes{};
+		// The chunk owns the borders with its east and south neighbours
+		bool eastDirty{ false };
+		bool southDirty{ false };
+		// Cached costs need rebuilding, the chunk is in the dirty list
+		bool queued{ false };
+	};
+
+	std::unordered_map<ChunkCoord, NavChunk, ChunkCoordHash> m_chunks{};
+	std::vector<Node> m_nodes{};
+	std::vector<int> m_freeNodes{};
+	std::vector<ChunkCoord> m_dirty{};
+	int m_rebuiltChunks{ 0 };
+
+	// Scratch of the main thread, used while rebuilding
+	NavSearch m_rebuildSearch{};
+
+	static int cellIndex(int x, int z)
+	{
+		return z * Chunk::sizeX + x;
+	}
+
+	static std::int8_t surfaceOf(const Chunk& chunk, int x, int z)
+	{
+		for (int y{ Chunk::sizeY - 1 }; y >= 0; --y)
+		{
+			BlockType block{ chunk.get(x, y, z) };
+			if (!isSolid(block))
+				continue;
+			// Nothing stands on lava, and the sky above the top block is always clear
+			return block == BlockType::lava ? blocked : static_cast<std::int8_t>(y + 1 + Chunk::minY);
+		}
+		return blocked;
+	}
+
+	// Octile distance, the walking cost over open ground
+	static float distance(int dx, int dz)
+	{
+		dx = std::abs(dx);
+		dz = std::abs(dz);
+		return static_cast<float>(std::max(dx, dz) - std::min(dx, dz)) + diagonalCost * static_cast<float>(std::min(dx, dz));
+	}
+
+	static bool stepAllowed(const std::int8_t* heights, int x, int z, int dx, int dz)
+	{
+		int toX{ x + dx };
+		int toZ{ z + dz };
+		if (toX < 0 || toX >= Chunk::sizeX || toZ < 0 || toZ >= Chunk::sizeZ)
+			return false;
+
+		std::int8_t to{ heights[cellIndex(toX, toZ)] };
+		return to != blocked && std::abs(to - heights[cellIndex(x, z)]) <= maxStep;
+	}
+
+	// Diagonal moves need both straight routes around the corner open, mobs never cut corners
+	static bool moveAllowed(const std::int8_t* heights, int x, int z, int dx, int dz)
+	{
+		if (heights[cellIndex(x, z)] == blocked)
+			return false;
+		if (dx == 0 || dz == 0)
+			return stepAllowed(heights, x, z, dx, dz);
+		return stepAllowed(heights, x, z, dx, 0) && stepAllowed(heights, x + dx, z, 0, dz)
+			&& stepAllowed(heights, x, z, 0, dz) && stepAllowed(heights, x, z + dz, dx, 0);
+	}
+
+	static std::uint16_t moveBit(int dx, int dz)
+	{
+		return static_cast<std::uint16_t>(1u << ((dz + 1) * 3 + dx + 1));
+	}
+
+	// Index of the lowest set bit, which must exist
+	static int lowestBit(unsigned value)
+	{
+		int index{ 0 };
+		while ((value & 1u) == 0)
+		{
+			value >>= 1;
+			++index;
+		}
+		return index;
+	}
+
+	static bool canMove(const std::uint16_t* moves, int x, int z, int dx, int dz)
+	{
+		return (moves[cellIndex(x, z)] & moveBit(dx, dz)) != 0;
+	}
+
+	// Works out the open moves of every cell once, so searches test a bit instead of four steps
+	static void buildMoves(NavChunk& nav)
+	{
+		for (int z{ 0 }; z < Chunk::sizeZ; ++z)
+		{
+			for (int x{ 0 }; x < Chunk::sizeX; ++x)
+			{
+				std::uint16_t moves{ 0 };
+				for (int dz{ -1 }; dz <= 1; ++dz)
+					for (int dx{ -1 }; dx <= 1; ++dx)
+						if ((dx != 0 || dz != 0) && moveAllowed(nav.heights, x, z, dx, dz))
+							moves |= moveBit(dx, dz);
+				nav.moves[cellIndex(x, z)] = moves;
+			}
+		}
+	}
+
+	void markChunk(const ChunkCoord& coord, NavChunk& nav)
+	{
+		if (nav.queued)
+			return;
+		nav.queued = true;
+		m_dirty.push_back(coord);
+	}
+
+	void markBorder(const ChunkCoord& coord, bool east)
+	{
+		auto found{ m_chunks.find(coord) };
+		if (found == m_chunks.end())
+			return;
+
+		markChunk(coord, found->second);
+		(east ? found->second.eastDirty : found->second.southDirty) = true;
+	}
+
+	int createNode(const ChunkCoord& coord, NavChunk& nav, int cell, bool outgoing, bool east)
+	{
+		int node{};
+		if (m_freeNodes.empty())
+		{
+			node = static_cast<int>(m_nodes.size());
+			m_nodes.emplace_back();
+		}
+		else
+		{
+			node = m_freeNodes.back();
+			m_freeNodes.pop_back();
+		}
+
+		Node& created{ m_nodes[node] };
+		created.chunk = coord;
+		created.cell = cell;
+		created.outgoing = outgoing;
+		created.east = east;
+		created.partner = -1;
+		created.edges.clear();
+		nav.nodes.push_back(node);
+		return node;
+	}
+
+	// Frees the portals of one side of a border, the chunk's costs are rebuilt next
+	void removeNodes(const ChunkCoord& coord, bool outgoing, bool east)
+	{
+		auto found{ m_chunks.find(coord) };
+		if (found == m_chunks.end())
+			return;
+
+		NavChunk& nav{ found->second };
+		auto removed{ std::remove_if(nav.nodes.begin(), nav.nodes.end(), [this, outgoing, east](int node)
+			{
+				if (m_nodes[node].outgoing != outgoing || m_nodes[node].east != east)
+					return false;
+				m_nodes[node].partner = -1;
+				m_nodes[node].edges.clear();
+				m_freeNodes.push_back(node);
+				return true;
+			}) };
+		if (removed == nav.nodes.end())
+			return;
+
+		nav.nodes.erase(removed, nav.nodes.end());
+		markChunk(coord, nav);
+	}
+
+	// Removes the portals on both sides of the east or south border of a chunk
+	void clearBorder(const ChunkCoord& coord, bool east)
+	{
+		ChunkCoord neighbour{ east ? ChunkCoord{ coord.x + 1, coord.z } : ChunkCoord{ coord.x, coord.z + 1 } };
+		removeNodes(coord, true, east);
+		removeNodes(neighbour, false, east);
+	}
+
+	// Places portals along the east or south border of a chunk, one per walkable run
+	void buildBorder(const ChunkCoord& coord, bool east)
+	{
+		NavChunk& nav{ m_chunks.find(coord)->second };
+		(east ? nav.eastDirty : nav.southDirty) = false;
+		clearBorder(coord, east);
+
+		ChunkCoord neighbourCoord{ east ? ChunkCoord{ coord.x + 1, coord.z } : ChunkCoord{ coord.x, coord.z + 1 } };
+		auto neighbour{ m_chunks.find(neighbourCoord) };
+		if (neighbour == m_chunks.end())
+			return;
+
+		NavChunk& other{ neighbour->second };
+		markChunk(coord, nav);
+		markChunk(neighbourCoord, other);
+
+		const int length{ east ? Chunk::sizeZ : Chunk::sizeX };
+		auto inside{ [east](int i) { return east ? cellIndex(Chunk::sizeX - 1, i) : cellIndex(i, Chunk::sizeZ - 1); } };
+		auto outside{ [east](int i) { return east ? cellIndex(0, i) : cellIndex(i, 0); } };
+		auto connected{ [](const std::int8_t* heights, int from, int to)
+			{
+				return std::abs(heights[from] - heights[to]) <= maxStep;
+			} };
+		auto open{ [&](int i)
+			{
+				std::int8_t from{ nav.heights[inside(i)] };
+				std::int8_t to{ other.heights[outside(i)] };
+				return from != blocked && to != blocked && std::abs(from - to) <= maxStep;
+			} };
+
+		for (int first{ 0 }; first < length; )
+		{
+			if (!open(first))
+			{
+				++first;
+				continue;
+			}
+
+			// A run only goes on while the cells along it connect on both sides, so any
+			// crossing in the run is reachable from its portal
+			int last{ first };
+			while (last + 1 < length && open(last + 1) && connected(nav.heights, inside(last), inside(last + 1))
+				&& connected(other.heights, outside(last), outside(last + 1)))
+				++last;
+
+			int ends[2]{ (first + last) / 2, -1 };
+			if (last - first + 1 >= longRun)
+			{
+				ends[0] = first;
+				ends[1] = last;
+			}
+			for (int i : ends)
+			{
+				if (i < 0)
+					continue;
+				int from{ createNode(coord, nav, inside(i), true, east) };
+				int to{ createNode(neighbourCoord, other, outside(i), false, east) };
+				m_nodes[from].partner = to;
+				m_nodes[to].partner = from;
+			}
+			first = last + 1;
+		}
+	}
+
+	// Caches the walking cost between every two portals of a chunk that connect inside it
+	void buildEdges(NavChunk& nav)
+	{
+		for (int node : nav.nodes)
+		{
+			Node& from{ m_nodes[node] };
+			from.edges.clear();
+			flood(nav.moves, from.cell, m_rebuildSearch.m_cost, m_rebuildSearch);
+			for (int other : nav.nodes)
+			{
+				float cost{ m_rebuildSearch.m_cost[m_nodes[other].cell] };
+				if (other != node && cost < infinity)
+					from.edges.push_back(Edge{ other, cost });
+			}
+		}
+	}
+
+	/*
+	* Fills the walking cost from one cell to every cell of its chunk. Steps cost 1 or the
+	* square root of 2, so cells are kept in buckets one unit of cost wide: a bucket can't
+	* improve its own cells and only the next two are ever filled, so no heap is needed
+	* Parameters:
+	* - moves: Open moves of the chunk's cells
+	* - from: Local cell to start from
+	* - costs: Receives the cost per cell, infinity where unreachable
+	* - search: Scratch whose buckets are used
+	* Returns: void
+	*/
+	static void flood(const std::uint16_t* moves, int from, float* costs, NavSearch& search)
+	{
+		std::fill(costs, costs + cells, infinity);
+		costs[from] = 0.0f;
+		for (std::vector<int>& bucket : search.m_buckets)
+			bucket.clear();
+		search.m_buckets[0].push_back(from);
+
+		for (int level{ 0 }; ; ++level)
+		{
+			std::vector<int>& bucket{ search.m_buckets[level % NavSearch::bucketCount] };
+			if (bucket.empty())
+			{
+				if (search.m_buckets[(level + 1) % NavSearch::bucketCount].empty() && search.m_buckets[(level + 2) % NavSearch::bucketCount].empty())
+					break;
+				continue;
+			}
+
+			for (std::size_t i{ 0 }; i < bucket.size(); ++i)
+			{
+				int cell{ bucket[i] };
+				float cost{ costs[cell] };
+				// Cells improved into an earlier bucket were already expanded from there
+				if (static_cast<int>(cost) != level)
+					continue;
+
+				for (unsigned open{ moves[cell] }; open != 0; open &= open - 1)
+				{
+					int direction{ lowestBit(open) };
+					int next{ cell + (direction / 3 - 1) * Chunk::sizeX + direction % 3 - 1 };
+					float nextCost{ cost + (direction % 2 == 0 ? diagonalCost : 1.0f) };
+					if (nextCost >= costs[next])
+						continue;
+
+					costs[next] = nextCost;
+					search.m_buckets[static_cast<int>(nextCost) % NavSearch::bucketCount].push_back(next);
+				}
+			}
+			bucket.clear();
+		}
+	}
+
+	// A* over the portals, seeded with the start chunk's portals, finishing at the goal chunk's
+	void searchPortals(const NavChunk& startChunk, const ChunkCoord& goalCoord, const glm::ivec3& goal, float& best, int& goalParent,
+		NavSearch& search) const
+	{
+		const int startNode{ static_cast<int>(m_nodes.size()) };
+		if (search.m_nodeCost.size() < m_nodes.size())
+		{
+			search.m_nodeCost.resize(m_nodes.size());
+			search.m_nodeParent.resize(m_nodes.size());
+			search.m_nodeGeneration.resize(m_nodes.size(), 0);
+		}
+		++search.m_generation;
+		search.m_open.clear();
+
+		auto heuristic{ [this, &goal](int node)
+			{
+				const Node& n{ m_nodes[node] };
+				return distance(n.chunk.x * Chunk::sizeX + n.cell % Chunk::sizeX - goal.x, n.chunk.z * Chunk::sizeZ + n.cell / Chunk::sizeX - goal.z);
+			} };
+		auto relax{ [&](int node, float cost, int parent)
+			{
+				if (search.m_nodeGeneration[node] == search.m_generation && cost >= search.m_nodeCost[node])
+					return;
+				search.m_nodeGeneration[node] = search.m_generation;
+				search.m_nodeCost[node] = cost;
+				search.m_nodeParent[node] = parent;
+				search.m_open.push_back(NavSearch::Entry{ cost + heuristic(node), cost, node });
+				std::push_heap(search.m_open.begin(), search.m_open.end(), std::greater<>{});
+			} };
+
+		for (int node : startChunk.nodes)
+		{
+			float cost{ search.m_startCosts[m_nodes[node].cell] };
+			if (cost < infinity)
+				relax(node, cost, startNode);
+		}
+
+		while (!search.m_open.empty())
+		{
+			std::pop_heap(search.m_open.begin(), search.m_open.end(), std::greater<>{});
+			NavSearch::Entry entry{ search.m_open.back() };
+			search.m_open.pop_back();
+			// The heuristic never overestimates, so nothing left can beat the best path found
+			if (entry.priority >= best)
+				break;
+			if (entry.cost > search.m_nodeCost[entry.node])
+				continue;
+
+			const Node& node{ m_nodes[entry.node] };
+			if (node.chunk == goalCoord)
+			{
+				float cost{ entry.cost + search.m_goalCosts[node.cell] };
+				if (cost < best)
+				{
+					best = cost;
+					goalParent = entry.node;
+				}
+			}
+
+			if (node.partner >= 0)
+				relax(node.partner, entry.cost + 1.0f, entry.node);
+			for (const Edge& edge : node.edges)
+				relax(edge.node, entry.cost + edge.cost, entry.node);
+		}
+	}
+
+	static void appendCell(const ChunkCoord& coord, int cell, const std::int8_t* heights, std::vector<glm::ivec3>& path)
+	{
+		path.push_back(glm::ivec3(coord.x * Chunk::sizeX + cell % Chunk::sizeX, heights[cell], coord.z * Chunk::sizeZ + cell / Chunk::sizeX));
+	}
+
+	// Jump point search between two cells of a chunk, appending every cell after the first
+	static void walkChunk(const ChunkCoord& coord, const NavChunk& nav, int from, int to, std::vector<glm::ivec3>& path, NavSearch& search)
+	{
+		if (from == to)
+			return;
+
+		const int goalX{ to % Chunk::sizeX };
+		const int goalZ{ to / Chunk::sizeX };
+		std::fill(std::begin(search.m_cost), std::end(search.m_cost), infinity);
+		search.m_cost[from] = 0.0f;
+		search.m_parent[from] = -1;
+		search.m_open.clear();
+		search.m_open.push_back(NavSearch::Entry{ distance(from % Chunk::sizeX - goalX, from / Chunk::sizeX - goalZ), 0.0f, from });
+
+		while (!search.m_open.empty())
+		{
+			std::pop_heap(search.m_open.begin(), search.m_open.end(), std::greater<>{});
+			NavSearch::Entry entry{ search.m_open.back() };
+			search.m_open.pop_back();
+			if (entry.node == to)
+				break;
+			if (entry.cost > search.m_cost[entry.node])
+				continue;
+
+			int x{ entry.node % Chunk::sizeX };
+			int z{ entry.node / Chunk::sizeX };
+			int parent{ search.m_parent[entry.node] };
+			int inX{ parent < 0 ? 0 : sign(x - parent % Chunk::sizeX) };
+			int inZ{ parent < 0 ? 0 : sign(z - parent / Chunk::sizeX) };
+
+			for (int dz{ -1 }; dz <= 1; ++dz)
+			{
+				for (int dx{ -1 }; dx <= 1; ++dx)
+				{
+					if ((dx == 0 && dz == 0) || !isNatural(inX, inZ, dx, dz) || !canMove(nav.moves, x, z, dx, dz))
+						continue;
+
+					int jumpPoint{ jump(nav.moves, x + dx, z + dz, dx, dz, goalX, goalZ) };
+					if (jumpPoint < 0)
+						continue;
+
+					float cost{ entry.cost + distance(jumpPoint % Chunk::sizeX - x, jumpPoint / Chunk::sizeX - z) };
+					if (cost >= search.m_cost[jumpPoint])
+						continue;
+
+					search.m_cost[jumpPoint] = cost;
+					search.m_parent[jumpPoint] = entry.node;
+					float priority{ cost + distance(jumpPoint % Chunk::sizeX - goalX, jumpPoint / Chunk::sizeX - goalZ) };
+					search.m_open.push_back(NavSearch::Entry{ priority, cost, jumpPoint });
+					std::push_heap(search.m_open.begin(), search.m_open.end(), std::greater<>{});
+				}
+			}
+		}
+
+		// Jump points from the goal back, then each straight or diagonal run between them walked out
+		search.m_jumpPoints.clear();
+		for (int cell{ to }; cell != from; cell = search.m_parent[cell])
+			search.m_jumpPoints.push_back(cell);
+
+		int x{ from % Chunk::sizeX };
+		int z{ from / Chunk::sizeX };
+		for (auto it{ search.m_jumpPoints.rbegin() }; it != search.m_jumpPoints.rend(); ++it)
+		{
+			int toX{ *it % Chunk::sizeX };
+			int toZ{ *it / Chunk::sizeX };
+			int dx{ sign(toX - x) };
+			int dz{ sign(toZ - z) };
+			while (x != toX || z != toZ)
+			{
+				x += dx;
+				z += dz;
+				appendCell(coord, cellIndex(x, z), nav.heights, path);
+			}
+		}
+	}
+
+	static int sign(int value)
+	{
+		return (value > 0) - (value < 0);
+	}
+
+	// Directions worth searching from a jump point entered moving (inX, inZ). Diagonal moves
+	// only continue forward, straight ones also turn aside, where forced neighbours lie
+	static bool isNatural(int inX, int inZ, int dx, int dz)
+	{
+		if (inX == 0 && inZ == 0)
+			return true;
+		if (inX != 0 && inZ != 0)
+			return (dx == inX || dx == 0) && (dz == inZ || dz == 0);
+		if (inX != 0)
+			return dx == inX || dx == 0;
+		return dz == inZ || dz == 0;
+	}
+
+	// True if a cell reached moving straight has a neighbour to the side that is only reached
+	// this cheaply through it, because the route around through the previous cell is closed
+	static bool hasForced(const std::uint16_t* moves, int x, int z, int dx, int dz)
+	{
+		int fromX{ x - dx };
+		int fromZ{ z - dz };
+		for (int side{ -1 }; side <= 1; side += 2)
+		{
+			int sideX{ dz != 0 ? side : 0 };
+			int sideZ{ dx != 0 ? side : 0 };
+			if (canMove(moves, x, z, sideX, sideZ)
+				&& !(canMove(moves, fromX, fromZ, sideX, sideZ) && canMove(moves, fromX + sideX, fromZ + sideZ, dx, dz)))
+				return true;
+		}
+		return false;
+	}
+
+	/*
+	* Moves from a cell in one direction until reaching the goal or a cell that has to be
+	* expanded, skipping every cell in between
+	* Parameters:
+	* - moves: Open moves of the chunk's cells
+	* - x, z: Cell just stepped onto
+	* - dx, dz: Direction of the step
+	* - goalX, goalZ: Goal cell
+	* Returns: Local cell of the jump point, -1 if the run ends in a dead end
+	*/
+	static int jump(const std::uint16_t* moves, int x, int z, int dx, int dz, int goalX, int goalZ)
+	{
+		for (;;)
+		{
+			if (x == goalX && z == goalZ)
+				return cellIndex(x, z);
+
+			if (dx != 0 && dz != 0)
+			{
+				// A diagonal run stops wherever one of its straight runs finds something
+				if ((canMove(moves, x, z, dx, 0) && jump(moves, x + dx, z, dx, 0, goalX, goalZ) >= 0)
+					|| (canMove(moves, x, z, 0, dz) && jump(moves, x, z + dz, 0, dz, goalX, goalZ) >= 0))
+					return cellIndex(x, z);
+			}
+			else if (hasForced(moves, x, z, dx, dz))
+			{
+				return cellIndex(x, z);
+			}
+
+			if (!canMove(moves, x, z, dx, dz))
+				return -1;
+			x += dx;
+			z += dz;
+		}
+	}
+};
+
+#endif
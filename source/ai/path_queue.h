@@ -0,0 +1,170 @@
+/*
+* File: path_queue.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program batches the path requests of mobs. Requests wait in a
+			   queue and every tick the oldest ones, up to a fixed budget, are solved
+			   in parallel on the job system, so a crowd asking for paths at once is
+			   spread over several ticks instead of stalling one frame
+*/
+
+#ifndef PATH_QUEUE_H
+#define PATH_QUEUE_H
+
+#include "nav_grid.h"
+#include "../job/job_system.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+enum class PathStatus
+{
+	pending,
+	found,
+	unreachable,
+};
+
+class PathQueue
+{
+public:
+	/*
+	* Creates an empty queue
+	* Parameters:
+	* - requestsPerTick: Most requests solved by one update
+	* Returns: PathQueue object
+	*/
+	explicit PathQueue(int requestsPerTick)
+		: m_requestsPerTick{ requestsPerTick }
+	{
+		m_pending.reserve(static_cast<std::size_t>(requestsPerTick) * 4);
+		m_batch.reserve(static_cast<std::size_t>(requestsPerTick));
+	}
+
+	/*
+	* Queues a path request, solved by one of the following updates
+	* Parameters:
+	* - start: World block the mob stands in
+	* - goal: World block to walk to
+	* Returns: Id of the request, valid until released
+	*/
+	int submit(const glm::ivec3& start, const glm::ivec3& goal)
+	{
+		int request{};
+		if (m_freeRequests.empty())
+		{
+			request = static_cast<int>(m_requests.size());
+			m_requests.emplace_back();
+		}
+		else
+		{
+			request = m_freeRequests.back();
+			m_freeRequests.pop_back();
+		}
+
+		Request& queued{ m_requests[request] };
+		queued.start = start;
+		queued.goal = goal;
+		queued.status = PathStatus::pending;
+		queued.path.clear();
+		m_pending.push_back(request);
+		return request;
+	}
+
+	/*
+	* Hands a request's id back once its path has been read. The path's memory is kept
+	* for the next request given the id. A pending request is dropped from the queue
+	* Parameters:
+	* - request: Id returned by submit
+	* Returns: void
+	*/
+	void release(int request)
+	{
+		if (m_requests[request].status == PathStatus::pending)
+			m_pending.erase(std::find(m_pending.begin(), m_pending.end(), request));
+		m_freeRequests.push_back(request);
+	}
+
+	/*
+	* Rebuilds what changed in the grid, then solves the oldest requests within the budget
+	* Parameters:
+	* - grid: Grid the paths are searched on
+	* - jobs: Job system the requests are spread over
+	* Returns: void
+	*/
+	void update(NavGrid& grid, JobSystem& jobs)
+	{
+		grid.rebuild();
+
+		std::size_t count{ std::min(m_pending.size(), static_cast<std::size_t>(m_requestsPerTick)) };
+		m_batch.assign(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(count));
+		m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(count));
+		if (m_batch.empty())
+			return;
+
+		// A few jobs per thread evens out long and short paths, each job owns one scratch
+		int batchSize{ static_cast<int>(m_batch.size()) };
+		int jobCount{ std::min(batchSize, jobs.getThreadCount() * 4) };
+		if (static_cast<int>(m_searches.size()) < jobCount)
+			m_searches.resize(static_cast<std::size_t>(jobCount));
+
+		jobs.parallelFor(0, jobCount, 1, [&](int first, int last)
+			{
+				for (int job{ first }; job < last; ++job)
+				{
+					int end{ (job + 1) * batchSize / jobCount };
+					for (int i{ job * batchSize / jobCount }; i < end; ++i)
+					{
+						Request& request{ m_requests[m_batch[i]] };
+						bool found{ grid.findPath(request.start, request.goal, request.path, m_searches[job]) };
+						request.status = found ? PathStatus::found : PathStatus::unreachable;
+					}
+				}
+			});
+		m_solved += batchSize;
+	}
+
+	PathStatus getStatus(int request) const
+	{
+		return m_requests[request].status;
+	}
+
+	// Columns stepped on from start to goal, empty unless the status is found
+	const std::vector<glm::ivec3>& getPath(int request) const
+	{
+		return m_requests[request].path;
+	}
+
+	std::size_t getPendingCount() const
+	{
+		return m_pending.size();
+	}
+
+	// Requests solved since creation, found or not
+	long long getSolvedCount() const
+	{
+		return m_solved;
+	}
+
+private:
+	struct Request
+	{
+		glm::ivec3 start{};
+		glm::ivec3 goal{};
+		PathStatus status{ PathStatus::pending };
+		std::vector<glm::ivec3> path{};
+	};
+
+	int m_requestsPerTick{};
+	std::vector<Request> m_requests{};
+	std::vector<int> m_freeRequests{};
+	// Oldest first
+	std::vector<int> m_pending{};
+	std::vector<int> m_batch{};
+	std::vector<NavSearch> m_searches{};
+	long long m_solved{ 0 };
+};
+
+#endif
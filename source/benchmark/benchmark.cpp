@@ -0,0 +1,1153 @@
+/*
+* File: benchmark.cpp
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: The program entry point for the benchmark executable, which times
+			   the CPU hot paths of the engine. Build it as its own executable from
+			   this file and glad.c, linked like the game, in a release
+			   configuration, and run it from the repository root so the assets are
+			   found. The shader cases need an OpenGL 3.3 context, with Mesa
+			   LIBGL_ALWAYS_SOFTWARE=1 gives a software one independent of the GPU
+			   driver. Everything else is seeded and runs without a context
+*/
+
+#include "benchmark.h"
+#include "../ai/nav_grid.h"
+#include "../ai/path_queue.h"
+#include "../camera/camera.h"
+#include "../io/asset_archive.h"
+#include "../job/job_system.h"
+#define ALLOCATION_TRACKER_IMPLEMENTATION
+#include "../memory/allocation_tracker.h"
+#include "../physics/broad_phase.h"
+#include "../render/particle_system.h"
+#include "../shader/shader.h"
+#include "../world/chunk.h"
+#include "../world/chunk_codec.h"
+#include "../world/chunk_mesher.h"
+#include "../world/lod_mesher.h"
+#include "../world/palette_storage.h"
+#include "../world/region_file.h"
+#include "../world/terrain.h"
+#include "../world/voxel_octree.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#define STB_IMAGE_IMPLEMENTATION
+#include "../../external/stbi/stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Chunks of generated terrain shared by the world, job and region cases
+constexpr int benchmarkChunkSide{ 8 };
+
+void benchmarkCamera(benchmark::Runner& runner);
+void benchmarkModelMatrices(benchmark::Runner& runner);
+void benchmarkShaders(benchmark::Runner& runner, const AssetLoader& assets);
+void benchmarkAssets(benchmark::Runner& runner, const AssetLoader& assets);
+void benchmarkImageDecode(benchmark::Runner& runner, const AssetLoader& assets);
+void benchmarkWorld(benchmark::Runner& runner, const TerrainGenerator& generator, const std::vector<Chunk>& chunks);
+void benchmarkPalette(benchmark::Runner& runner, const std::vector<Chunk>& chunks);
+void benchmarkRegions(benchmark::Runner& runner, std::vector<Chunk>& chunks);
+void benchmarkJobs(benchmark::Runner& runner, const TerrainGenerator& generator, const std::vector<Chunk>& chunks, int maxThreads);
+void benchmarkParticles(benchmark::Runner& runner, int maxThreads);
+void benchmarkOctree(benchmark::Runner& runner, const TerrainGenerator& generator);
+void benchmarkLod(benchmark::Runner& runner, const TerrainGenerator& generator);
+void benchmarkBroadPhase(benchmark::Runner& runner, int maxThreads);
+void benchmarkPathfinding(benchmark::Runner& runner, const TerrainGenerator& generator, int maxThreads);
+std::vector<std::string> listAssets();
+
+int main(int argc, char* argv[])
+{
+	// --filter <prefix> runs only the cases whose name starts with it, --list prints the names,
+	// --samples <n> and --min-time <ms> trade run time for stability, --json <file> writes the
+	// results for tracking between releases, --assets <file> picks the asset archive,
+	// --threads <n> sets the most threads the job cases scale to and --no-gl skips the cases
+	// that need an OpenGL context
+	benchmark::Options options{};
+	const char* jsonPath{ nullptr };
+	const char* assetArchivePath{ "assets.pak" };
+	int maxThreads{ std::max(1, static_cast<int>(std::thread::hardware_concurrency())) };
+	bool useGl{ true };
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		bool hasValue{ i + 1 < argc };
+		if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+			options.filter = argv[++i];
+		else if (std::strcmp(argv[i], "--list") == 0)
+			options.list = true;
+		else if (std::strcmp(argv[i], "--samples") == 0 && hasValue)
+			options.samples = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue)
+			options.minSampleMs = std::max(0.1, std::atof(argv[++i]));
+		else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+			jsonPath = argv[++i];
+		else if (std::strcmp(argv[i], "--assets") == 0 && hasValue)
+			assetArchivePath = argv[++i];
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+			maxThreads = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--no-gl") == 0)
+			useGl = false;
+	}
+
+	benchmark::Runner runner{ options };
+	AssetLoader assets{ assetArchivePath };
+	runner.printHeader();
+
+	benchmarkCamera(runner);
+	benchmarkModelMatrices(runner);
+	if (useGl && runner.wants("shader"))
+		benchmarkShaders(runner, assets);
+	benchmarkAssets(runner, assets);
+	benchmarkImageDecode(runner, assets);
+
+	// The same seeded terrain every run, so world results are comparable
+	TerrainGenerator generator{};
+	std::vector<Chunk> chunks{};
+	if (runner.wants("world") || runner.wants("palette") || runner.wants("region") || runner.wants("jobs"))
+	{
+		chunks.reserve(benchmarkChunkSide * benchmarkChunkSide);
+		for (int z{ 0 }; z < benchmarkChunkSide; ++z)
+		{
+			for (int x{ 0 }; x < benchmarkChunkSide; ++x)
+			{
+				chunks.emplace_back(ChunkCoord{ x - benchmarkChunkSide / 2, z - benchmarkChunkSide / 2 });
+				generator.generate(chunks.back());
+			}
+		}
+	}
+
+	benchmarkWorld(runner, generator, chunks);
+	benchmarkPalette(runner, chunks);
+	benchmarkRegions(runner, chunks);
+	benchmarkJobs(runner, generator, chunks, maxThreads);
+	benchmarkParticles(runner, maxThreads);
+	benchmarkOctree(runner, generator);
+	benchmarkLod(runner, generator);
+	benchmarkBroadPhase(runner, maxThreads);
+	benchmarkPathfinding(runner, generator, maxThreads);
+
+	if (jsonPath && !options.list && !runner.writeJson(jsonPath, static_cast<int>(std::thread::hardware_concurrency())))
+		return 1;
+	return 0;
+}
+
+void benchmarkCamera(benchmark::Runner& runner)
+{
+	Camera camera{ glm::vec3(0.0f, 2.0f, 0.0f) };
+
+	runner.run("camera/view_matrix", [&camera]()
+		{
+			benchmark::doNotOptimize(camera.getViewMatrix());
+		});
+
+	// Mouse movement recalculates the camera vectors, alternating keeps the pitch in range
+	float direction{ 1.0f };
+	runner.run("camera/update_vectors", [&camera, &direction]()
+		{
+			camera.processMouseMovement(direction, -direction);
+			direction = -direction;
+			benchmark::doNotOptimize(camera.getFront());
+		});
+}
+
+void benchmarkModelMatrices(benchmark::Runner& runner)
+{
+	// The translate and scale draw list generation builds for every visible cube
+	constexpr int count{ 4096 };
+	std::vector<glm::vec3> positions{};
+	positions.reserve(count);
+	for (int i{ 0 }; i < count; ++i)
+		positions.emplace_back(static_cast<float>(i % 64), static_cast<float>((i / 64) % 8), static_cast<float>(i / 512));
+	std::vector<glm::mat4> models(count);
+
+	runner.run("render/model_matrices", [&positions, &models]()
+		{
+			for (int i{ 0 }; i < count; ++i)
+			{
+				glm::mat4 model{ glm::mat4(1.0f) };
+				model = glm::translate(model, positions[i]);
+				model = glm::scale(model, glm::vec3(0.5f));
+				models[i] = model;
+			}
+			benchmark::doNotOptimize(models.data());
+		}, count);
+}
+
+void benchmarkShaders(benchmark::Runner& runner, const AssetLoader& assets)
+{
+	if (!glfwInit())
+	{
+		std::cout << "ERROR::BENCHMARK::GLFW_INIT_FAILED, skipping shader cases\n";
+		return;
+	}
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window{ glfwCreateWindow(64, 64, "Freakmon benchmark", NULL, NULL) };
+	if (window == NULL)
+	{
+		std::cout << "ERROR::BENCHMARK::NO_OPENGL_CONTEXT, skipping shader cases\n";
+		glfwTerminate();
+		return;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "ERROR::BENCHMARK::GLAD_INIT_FAILED, skipping shader cases\n";
+		glfwTerminate();
+		return;
+	}
+
+	{
+		Shader shader{ assets, "source/shader/lighting.vs", "source/shader/lighting.fs" };
+		shader.use();
+		glm::mat4 view{ glm::lookAt(glm::vec3(0.0f, 2.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)) };
+		glm::vec3 position{ 1.2f, 1.0f, 2.0f };
+
+		// Every setter looks the uniform up by name, which is most of its cost
+		runner.run("shader/set_mat4", [&shader, &view]()
+			{
+				shader.setMat4("view", view);
+			});
+		runner.run("shader/set_vec3", [&shader, &position]()
+			{
+				shader.setVec3("viewPos", position);
+			});
+		runner.run("shader/set_float", [&shader]()
+			{
+				shader.setFloat("material.shininess", 32.0f);
+			});
+		runner.run("shader/set_struct_vec3", [&shader, &position]()
+			{
+				shader.setVec3("spotLight.position", position);
+			});
+
+		// The uniform setup the lit pass does every frame
+		runner.run("shader/frame_uniforms", [&shader, &view, &position]()
+			{
+				shader.setMat4("view", view);
+				shader.setMat4("projection", view);
+				shader.setVec3("viewPos", position);
+				shader.setVec3("spotLight.position", position);
+				shader.setVec3("spotLight.direction", position);
+			}, 5);
+		glFinish();
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+}
+
+void benchmarkAssets(benchmark::Runner& runner, const AssetLoader& assets)
+{
+	if (!runner.wants("assets"))
+		return;
+
+	std::vector<std::string> paths{ listAssets() };
+	AssetLoader loose{ "", true };
+
+	runner.run("assets/open_loose", [&loose, &paths]()
+		{
+			for (const std::string& path : paths)
+				benchmark::doNotOptimize(loose.open(path.c_str()).size());
+		}, static_cast<double>(paths.size()));
+
+	if (assets.hasArchive())
+	{
+		runner.run("assets/open_archive", [&assets, &paths]()
+			{
+				for (const std::string& path : paths)
+					benchmark::doNotOptimize(assets.open(path.c_str()).size());
+			}, static_cast<double>(paths.size()));
+	}
+}
+
+void benchmarkImageDecode(benchmark::Runner& runner, const AssetLoader& assets)
+{
+	if (!runner.wants("image"))
+		return;
+
+	// Decoded from memory so only the decode is timed, the way TextureManager loads them
+	for (const std::string& path : listAssets())
+	{
+		std::string extension{ std::filesystem::path{ path }.extension().string() };
+		if (extension != ".jpg" && extension != ".png")
+			continue;
+
+		Asset image{ assets.open(path.c_str()) };
+		if (!image.isValid())
+			continue;
+
+		int width{}, height{}, channels{};
+		if (!stbi_info_from_memory(image.data(), static_cast<int>(image.size()), &width, &height, &channels))
+			continue;
+
+		runner.run("image/decode/" + path.substr(path.find('/') + 1), [&image]()
+			{
+				int w{}, h{}, c{};
+				unsigned char* pixels{ stbi_load_from_memory(image.data(), static_cast<int>(image.size()), &w, &h, &c, 0) };
+				benchmark::doNotOptimize(pixels);
+				stbi_image_free(pixels);
+			}, static_cast<double>(width) * height, static_cast<double>(image.size()));
+		runner.addCounter("pixels", static_cast<double>(width) * height);
+	}
+}
+
+void benchmarkWorld(benchmark::Runner& runner, const TerrainGenerator& generator, const std::vector<Chunk>& chunks)
+{
+	if (!runner.wants("world"))
+		return;
+
+	int next{ 0 };
+	runner.run("world/generate_chunk", [&generator, &next]()
+		{
+			Chunk chunk{ ChunkCoord{ next % 64, next / 64 } };
+			next = (next + 1) % 4096;
+			generator.generate(chunk);
+			benchmark::doNotOptimize(chunk.getSection(0).getBits());
+		});
+
+	// Light propagation and face emission, the work of a streaming job minus the generation
+	ChunkMesh mesh{};
+	std::size_t index{ 0 };
+	auto outside{ [&generator](int x, int y, int z) { return generator.getBlock(x, y, z); } };
+	runner.run("world/mesh_chunk", [&chunks, &mesh, &index, &outside]()
+		{
+			buildChunkMesh(chunks[index], outside, mesh);
+			index = (index + 1) % chunks.size();
+			benchmark::doNotOptimize(mesh.vertices.data());
+		});
+
+	std::size_t vertices{ 0 };
+	for (const Chunk& chunk : chunks)
+	{
+		buildChunkMesh(chunk, outside, mesh);
+		vertices += mesh.vertices.size() / ChunkMesh::floatsPerVertex;
+	}
+	runner.addCounter("vertices_per_chunk", static_cast<double>(vertices) / chunks.size());
+}
+
+void benchmarkPalette(benchmark::Runner& runner, const std::vector<Chunk>& chunks)
+{
+	if (!runner.wants("palette"))
+		return;
+
+	// Reads every block of a chunk, through the palette and from a plain array for comparison
+	std::vector<BlockType> dense(Chunk::volume);
+	const Chunk& chunk{ chunks[chunks.size() / 2] };
+	for (int y{ 0 }; y < Chunk::sizeY; ++y)
+		for (int z{ 0 }; z < Chunk::sizeZ; ++z)
+			for (int x{ 0 }; x < Chunk::sizeX; ++x)
+				dense[(y * Chunk::sizeZ + z) * Chunk::sizeX + x] = chunk.get(x, y, z);
+
+	runner.run("palette/read_chunk", [&chunk]()
+		{
+			int solid{ 0 };
+			for (int y{ 0 }; y < Chunk::sizeY; ++y)
+				for (int z{ 0 }; z < Chunk::sizeZ; ++z)
+					for (int x{ 0 }; x < Chunk::sizeX; ++x)
+						solid += isSolid(chunk.get(x, y, z));
+			benchmark::doNotOptimize(solid);
+		}, Chunk::volume);
+
+	runner.run("palette/read_dense", [&dense]()
+		{
+			int solid{ 0 };
+			for (BlockType block : dense)
+				solid += isSolid(block);
+			benchmark::doNotOptimize(solid);
+		}, Chunk::volume);
+
+	// Widening from one to four bits as new block types appear, then compacting back
+	runner.run("palette/write_section", []()
+		{
+			PaletteStorage storage{ Chunk::sectionVolume, BlockType::air };
+			for (int i{ 0 }; i < Chunk::sectionVolume; ++i)
+				storage.set(i, static_cast<BlockType>((i * 7 / 5) % blockTypeCount));
+			storage.compact();
+			benchmark::doNotOptimize(storage.getBits());
+		}, Chunk::sectionVolume);
+
+	std::size_t paletteBytes{ 0 };
+	for (const Chunk& generated : chunks)
+		paletteBytes += generated.memoryUsage();
+	runner.addCounter("bytes_per_chunk", static_cast<double>(paletteBytes) / chunks.size());
+	runner.addCounter("dense_bytes_per_chunk", static_cast<double>(Chunk::volume * sizeof(BlockType)));
+}
+
+void benchmarkRegions(benchmark::Runner& runner, std::vector<Chunk>& chunks)
+{
+	if (!runner.wants("region"))
+		return;
+
+	std::error_code error{};
+	std::filesystem::path directory{ std::filesystem::temp_directory_path(error) / "freakmon_benchmark_regions" };
+	std::filesystem::remove_all(directory, error);
+
+	std::size_t payloadBytes{ 0 };
+	std::vector<std::uint8_t> payload{};
+	for (const Chunk& chunk : chunks)
+	{
+		payload.clear();
+		encodeChunk(chunk, payload);
+		payloadBytes += payload.size();
+	}
+
+	{
+		// Every save appends, so the region files grow over the run like they do in play
+		RegionStore regions{ directory.string() };
+		runner.run("region/save", [&regions, &chunks]()
+			{
+				for (Chunk& chunk : chunks)
+					regions.save(chunk);
+			}, static_cast<double>(chunks.size()), static_cast<double>(payloadBytes));
+
+		Chunk loaded{};
+		runner.run("region/load", [&regions, &chunks, &loaded]()
+			{
+				for (const Chunk& chunk : chunks)
+				{
+					loaded.coord = chunk.coord;
+					regions.load(loaded);
+				}
+				benchmark::doNotOptimize(loaded.getSection(0).getBits());
+			}, static_cast<double>(chunks.size()), static_cast<double>(payloadBytes));
+		runner.addCounter("payload_bytes_per_chunk", static_cast<double>(payloadBytes) / chunks.size());
+	}
+
+	std::filesystem::remove_all(directory, error);
+}
+
+void benchmarkJobs(benchmark::Runner& runner, const TerrainGenerator& generator, const std::vector<Chunk>& chunks, int maxThreads)
+{
+	if (!runner.wants("jobs"))
+		return;
+
+	// Powers of two up to the limit, then the limit itself
+	std::vector<int> threadCounts{};
+	for (int threads{ 1 }; threads < maxThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(maxThreads);
+
+	auto outside{ [&generator](int x, int y, int z) { return generator.getBlock(x, y, z); } };
+	std::vector<ChunkMesh> meshes(chunks.size());
+
+	double singleThreaded{ 0.0 };
+	for (int threads : threadCounts)
+	{
+		JobSystem jobs{ threads };
+
+		// Meshing every chunk, the job streaming runs most
+		benchmark::Result* result{ runner.run("jobs/mesh_chunks/threads:" + std::to_string(threads), [&jobs, &chunks, &meshes, &outside]()
+			{
+				jobs.parallelFor(0, static_cast<int>(chunks.size()), 1, [&chunks, &meshes, &outside](int first, int last)
+					{
+						for (int i{ first }; i < last; ++i)
+							buildChunkMesh(chunks[i], outside, meshes[i]);
+					});
+			}, static_cast<double>(chunks.size())) };
+		if (result)
+		{
+			if (threads == 1)
+				singleThreaded = result->medianNs;
+			if (singleThreaded > 0.0)
+				runner.addCounter("speedup", singleThreaded / result->medianNs);
+		}
+
+		// Jobs too small to be worth running, what remains is the scheduling cost
+		runner.run("jobs/empty_jobs/threads:" + std::to_string(threads), [&jobs]()
+			{
+				jobs.parallelFor(0, 1024, 1, [](int first, int last)
+					{
+						benchmark::doNotOptimize(first + last);
+					});
+			}, 1024);
+	}
+}
+
+void benchmarkParticles(benchmark::Runner& runner, int maxThreads)
+{
+	if (!runner.wants("particles"))
+		return;
+
+	// A million embers at 60 Hz, topped up every step so the count holds steady
+	constexpr int count{ 1 << 20 };
+	constexpr float deltaTime{ 1.0f / 60.0f };
+	ParticleSystem particles{ count };
+	ParticleEffect effect{};
+	effect.velocityMin = glm::vec3(-0.3f, 0.6f, -0.3f);
+	effect.velocityMax = glm::vec3(0.3f, 1.4f, 0.3f);
+	effect.lifetimeMin = 2.0f;
+	effect.lifetimeMax = 4.0f;
+	effect.gravity = 0.8f;
+	effect.drag = 0.6f;
+	int ember{ particles.addEffect(effect) };
+	const glm::vec3 wind{ 0.4f, 0.0f, 0.2f };
+	std::vector<ParticleInstance> instances(count);
+
+	std::vector<int> threadCounts{ 1 };
+	if (maxThreads > 1)
+		threadCounts.push_back(maxThreads);
+
+	for (int threads : threadCounts)
+	{
+		JobSystem jobs{ threads };
+		particles.spawn(ember, glm::vec3(0.0f), count - particles.getCount());
+
+		runner.run("particles/update_1m/threads:" + std::to_string(threads), [&particles, &jobs, &wind, ember]()
+			{
+				particles.update(deltaTime, wind, jobs);
+				particles.spawn(ember, glm::vec3(0.0f), count - particles.getCount());
+			}, count);
+		runner.addCounter("simd_width", ParticleSystem::simdWidth);
+
+		runner.run("particles/write_instances_1m/threads:" + std::to_string(threads), [&particles, &jobs, &instances]()
+			{
+				particles.writeInstances(instances.data(), jobs);
+				benchmark::doNotOptimize(instances.data());
+			}, count, static_cast<double>(sizeof(ParticleInstance)) * count);
+	}
+}
+
+// The flat block array the octree is measured against, with a block by block ray walk
+struct DenseVoxelGrid
+{
+	glm::ivec3 origin{};
+	glm::ivec3 size{};
+	std::vector<BlockType> blocks{};
+
+	BlockType get(const glm::ivec3& cell) const
+	{
+		return blocks[(static_cast<std::size_t>(cell.y) * size.z + cell.z) * size.x + cell.x];
+	}
+
+	OctreeRayHit raycast(const glm::vec3& rayOrigin, const glm::vec3& direction, float maxDistance) const
+	{
+		OctreeRayHit result{};
+		const glm::vec3 dir{ glm::normalize(direction) };
+		const glm::vec3 start{ rayOrigin + 0.5f - glm::vec3(origin) };
+
+		float t{ 0.0f };
+		float tLeave{ maxDistance };
+		int axis{ -1 };
+		for (int a{ 0 }; a < 3; ++a)
+		{
+			if (dir[a] == 0.0f)
+			{
+				if (start[a] < 0.0f || start[a] >= static_cast<float>(size[a]))
+					return result;
+				continue;
+			}
+
+			float t0{ -start[a] / dir[a] };
+			float t1{ (static_cast<float>(size[a]) - start[a]) / dir[a] };
+			if (t0 > t1)
+				std::swap(t0, t1);
+			if (t0 > t)
+			{
+				t = t0;
+				axis = a;
+			}
+			tLeave = std::min(tLeave, t1);
+		}
+		if (t > tLeave)
+			return result;
+
+		glm::ivec3 cell{};
+		glm::ivec3 step{};
+		glm::vec3 tMax{};
+		glm::vec3 tDelta{};
+		for (int a{ 0 }; a < 3; ++a)
+		{
+			cell[a] = std::clamp(static_cast<int>(std::floor(start[a] + dir[a] * t)), 0, size[a] - 1);
+			step[a] = dir[a] > 0.0f ? 1 : -1;
+			tDelta[a] = dir[a] != 0.0f ? std::abs(1.0f / dir[a]) : std::numeric_limits<float>::infinity();
+			tMax[a] = dir[a] != 0.0f ? (static_cast<float>(cell[a] + (dir[a] > 0.0f)) - start[a]) / dir[a] : std::numeric_limits<float>::infinity();
+		}
+
+		while (true)
+		{
+			BlockType block{ get(cell) };
+			if (isSolid(block))
+			{
+				result.hit = true;
+				result.block = cell + origin;
+				if (axis >= 0)
+					result.normal[axis] = -step[axis];
+				result.distance = t;
+				result.type = block;
+				return result;
+			}
+
+			axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+			if (tMax[axis] > maxDistance)
+				return result;
+			t = tMax[axis];
+			cell[axis] += step[axis];
+			if (cell[axis] < 0 || cell[axis] >= size[axis])
+				return result;
+			tMax[axis] += tDelta[axis];
+		}
+	}
+
+	long long countSolid(const glm::ivec3& min, const glm::ivec3& max) const
+	{
+		const glm::ivec3 low{ glm::max(min - origin, glm::ivec3(0)) };
+		const glm::ivec3 high{ glm::min(max - origin, size - 1) };
+		long long count{ 0 };
+		for (int y{ low.y }; y <= high.y; ++y)
+			for (int z{ low.z }; z <= high.z; ++z)
+				for (int x{ low.x }; x <= high.x; ++x)
+					count += isSolid(get(glm::ivec3(x, y, z)));
+		return count;
+	}
+
+	bool overlapsSolid(const glm::ivec3& min, const glm::ivec3& max) const
+	{
+		const glm::ivec3 low{ glm::max(min - origin, glm::ivec3(0)) };
+		const glm::ivec3 high{ glm::min(max - origin, size - 1) };
+		for (int y{ low.y }; y <= high.y; ++y)
+			for (int z{ low.z }; z <= high.z; ++z)
+				for (int x{ low.x }; x <= high.x; ++x)
+					if (isSolid(get(glm::ivec3(x, y, z))))
+						return true;
+		return false;
+	}
+};
+
+void benchmarkOctree(benchmark::Runner& runner, const TerrainGenerator& generator)
+{
+	if (!runner.wants("octree"))
+		return;
+
+	// 32 by 32 chunks, 512 by 64 by 512 blocks of the seeded terrain
+	constexpr int side{ 32 };
+	const ChunkCoord minCoord{ -side / 2, -side / 2 };
+	std::vector<Chunk> chunks{};
+	chunks.reserve(side * side);
+	for (int z{ 0 }; z < side; ++z)
+	{
+		for (int x{ 0 }; x < side; ++x)
+		{
+			chunks.emplace_back(ChunkCoord{ minCoord.x + x, minCoord.z + z });
+			generator.generate(chunks.back());
+		}
+	}
+	auto chunkAt{ [&chunks, minCoord](ChunkCoord coord) -> const Chunk*
+		{
+			int x{ coord.x - minCoord.x };
+			int z{ coord.z - minCoord.z };
+			return x >= 0 && x < side && z >= 0 && z < side ? &chunks[static_cast<std::size_t>(z) * side + x] : nullptr;
+		} };
+
+	DenseVoxelGrid dense{};
+	dense.origin = glm::ivec3(minCoord.x * Chunk::sizeX, Chunk::minY, minCoord.z * Chunk::sizeZ);
+	dense.size = glm::ivec3(side * Chunk::sizeX, Chunk::sizeY, side * Chunk::sizeZ);
+	dense.blocks.resize(static_cast<std::size_t>(dense.size.x) * dense.size.y * dense.size.z);
+	for (const Chunk& chunk : chunks)
+		for (int y{ 0 }; y < Chunk::sizeY; ++y)
+			for (int z{ 0 }; z < Chunk::sizeZ; ++z)
+				for (int x{ 0 }; x < Chunk::sizeX; ++x)
+				{
+					glm::ivec3 cell{ chunk.worldX() + x - dense.origin.x, y, chunk.worldZ() + z - dense.origin.z };
+					dense.blocks[(static_cast<std::size_t>(cell.y) * dense.size.z + cell.z) * dense.size.x + cell.x] = chunk.get(x, y, z);
+				}
+
+	VoxelOctree octree{};
+	octree.buildFromChunks(minCoord, side, side, chunkAt);
+	runner.run("octree/build", [&octree, &chunkAt, minCoord]()
+		{
+			octree.buildFromChunks(minCoord, side, side, chunkAt);
+			benchmark::doNotOptimize(octree.getNodeCount());
+		}, static_cast<double>(dense.blocks.size()));
+	runner.addCounter("octree_bytes", static_cast<double>(octree.memoryUsage()));
+	runner.addCounter("dense_bytes", static_cast<double>(dense.blocks.size() * sizeof(BlockType)));
+	runner.addCounter("nodes", static_cast<double>(octree.getNodeCount()));
+
+	// Seeded queries: long look rays from above the terrain, like picking from the camera, and
+	// 16 block boxes from the ground up into the sky, like the space a moving body sweeps
+	std::uint32_t random{ 2463534242u };
+	auto next{ [&random]()
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			return static_cast<float>(random >> 8) * (1.0f / 16777216.0f);
+		} };
+
+	constexpr int rayCount{ 4096 };
+	constexpr float rayLength{ 256.0f };
+	std::vector<glm::vec3> rayOrigins(rayCount);
+	std::vector<glm::vec3> rayDirections(rayCount);
+	for (int i{ 0 }; i < rayCount; ++i)
+	{
+		rayOrigins[i] = glm::vec3(dense.origin.x + 64.0f + next() * (dense.size.x - 128.0f), 30.0f + next() * 10.0f, dense.origin.z + 64.0f + next() * (dense.size.z - 128.0f));
+		float angle{ 6.28318531f * next() };
+		rayDirections[i] = glm::vec3(std::cos(angle), -0.35f + next() * 0.4f, std::sin(angle));
+	}
+
+	constexpr int boxCount{ 4096 };
+	constexpr int boxSide{ 16 };
+	std::vector<glm::ivec3> boxes(boxCount);
+	for (glm::ivec3& box : boxes)
+		box = glm::ivec3(dense.origin.x + static_cast<int>(next() * (dense.size.x - boxSide)), static_cast<int>(-8.0f + next() * 48.0f), dense.origin.z + static_cast<int>(next() * (dense.size.z - boxSide)));
+
+	int hits{ 0 };
+	runner.run("octree/raycast", [&octree, &rayOrigins, &rayDirections, &hits]()
+		{
+			hits = 0;
+			for (int i{ 0 }; i < rayCount; ++i)
+				hits += octree.raycast(rayOrigins[i], rayDirections[i], rayLength).hit;
+			benchmark::doNotOptimize(hits);
+		}, rayCount);
+	runner.addCounter("hit_rate", static_cast<double>(hits) / rayCount);
+
+	runner.run("octree/raycast_dense", [&dense, &rayOrigins, &rayDirections, &hits]()
+		{
+			hits = 0;
+			for (int i{ 0 }; i < rayCount; ++i)
+				hits += dense.raycast(rayOrigins[i], rayDirections[i], rayLength).hit;
+			benchmark::doNotOptimize(hits);
+		}, rayCount);
+	runner.addCounter("hit_rate", static_cast<double>(hits) / rayCount);
+
+	int overlapping{ 0 };
+	runner.run("octree/overlap_box", [&octree, &boxes, &overlapping]()
+		{
+			overlapping = 0;
+			for (const glm::ivec3& box : boxes)
+				overlapping += octree.overlapsSolid(box, box + boxSide - 1);
+			benchmark::doNotOptimize(overlapping);
+		}, boxCount);
+	runner.addCounter("overlap_rate", static_cast<double>(overlapping) / boxCount);
+
+	runner.run("octree/overlap_box_dense", [&dense, &boxes, &overlapping]()
+		{
+			overlapping = 0;
+			for (const glm::ivec3& box : boxes)
+				overlapping += dense.overlapsSolid(box, box + boxSide - 1);
+			benchmark::doNotOptimize(overlapping);
+		}, boxCount);
+	runner.addCounter("overlap_rate", static_cast<double>(overlapping) / boxCount);
+
+	// Counting has to reach every block of the surface, where the tree is at its finest
+	runner.run("octree/count_box", [&octree, &boxes]()
+		{
+			long long solid{ 0 };
+			for (const glm::ivec3& box : boxes)
+				solid += octree.countSolid(box, box + boxSide - 1);
+			benchmark::doNotOptimize(solid);
+		}, boxCount);
+
+	runner.run("octree/count_box_dense", [&dense, &boxes]()
+		{
+			long long solid{ 0 };
+			for (const glm::ivec3& box : boxes)
+				solid += dense.countSolid(box, box + boxSide - 1);
+			benchmark::doNotOptimize(solid);
+		}, boxCount);
+}
+
+void benchmarkLod(benchmark::Runner& runner, const TerrainGenerator& generator)
+{
+	if (!runner.wants("lod"))
+		return;
+
+	// A whole tile at each level, away from spawn's flat clearing
+	const ChunkCoord origin{ 24, 16 };
+	ChunkMesh mesh{};
+	for (int level{ 1 }; level <= lod::maxLevel; ++level)
+	{
+		lod::TileDesc desc{ level, origin, ~std::uint64_t{ 0 } };
+		runner.run("lod/build_tile/level:" + std::to_string(level), [&generator, &desc, &mesh]()
+			{
+				buildLodMesh(generator, desc, mesh);
+				benchmark::doNotOptimize(mesh.vertices.data());
+			}, lod::tileChunks * lod::tileChunks);
+		runner.addCounter("triangles", static_cast<double>(mesh.vertices.size() / ChunkMesh::floatsPerVertex / 3));
+	}
+
+	// Every ring around the camera as the game sets them up, against full detail for the same distance
+	constexpr int nearRadius{ 6 };
+	const lod::Rings rings{ lod::Rings::doubling(nearRadius, lod::maxLevel) };
+	const int farRadius{ nearRadius << lod::maxLevel };
+	const ChunkCoord center{ origin.x + 4, origin.z + 4 };
+	long long ringTriangles[lod::maxLevel + 1]{};
+	runner.run("lod/build_rings", [&]()
+		{
+			std::fill(std::begin(ringTriangles), std::end(ringTriangles), 0);
+			for (int level{ 1 }; level <= lod::maxLevel; ++level)
+			{
+				int low{ Chunk::floorDiv(center.x - farRadius, lod::tileChunks) * lod::tileChunks };
+				int lowZ{ Chunk::floorDiv(center.z - farRadius, lod::tileChunks) * lod::tileChunks };
+				for (int z{ lowZ }; z <= center.z + farRadius; z += lod::tileChunks)
+				{
+					for (int x{ low }; x <= center.x + farRadius; x += lod::tileChunks)
+					{
+						lod::TileDesc desc{ lod::describeTile(rings, center, level, ChunkCoord{ x, z }) };
+						if (desc.members == 0)
+							continue;
+
+						buildLodMesh(generator, desc, mesh);
+						ringTriangles[level] += static_cast<long long>(mesh.vertices.size() / ChunkMesh::floatsPerVertex / 3);
+					}
+				}
+			}
+		});
+
+	int nearChunks{ 0 };
+	int farChunks{ 0 };
+	auto outside{ [&generator](int x, int y, int z) { return generator.getBlock(x, y, z); } };
+	for (int dz{ -farRadius }; dz <= farRadius; ++dz)
+	{
+		for (int dx{ -farRadius }; dx <= farRadius; ++dx)
+		{
+			int level{ rings.levelOf(dx, dz) };
+			farChunks += level >= 0;
+			if (level != 0)
+				continue;
+
+			Chunk chunk{ ChunkCoord{ center.x + dx, center.z + dz } };
+			generator.generate(chunk);
+			buildChunkMesh(chunk, outside, mesh);
+			ringTriangles[0] += static_cast<long long>(mesh.vertices.size() / ChunkMesh::floatsPerVertex / 3);
+			++nearChunks;
+		}
+	}
+
+	long long total{ 0 };
+	for (int level{ 0 }; level <= lod::maxLevel; ++level)
+	{
+		runner.addCounter("triangles_level:" + std::to_string(level), static_cast<double>(ringTriangles[level]));
+		total += ringTriangles[level];
+	}
+	runner.addCounter("triangles_total", static_cast<double>(total));
+	runner.addCounter("full_detail_triangles_estimate", static_cast<double>(ringTriangles[0]) / nearChunks * farChunks);
+	runner.addCounter("view_distance_blocks", static_cast<double>((farRadius + 1) * Chunk::sizeX));
+}
+
+void benchmarkBroadPhase(benchmark::Runner& runner, int maxThreads)
+{
+	if (!runner.wants("physics"))
+		return;
+
+	// Mob sized boxes walking over flat ground at about four square blocks each, moved
+	// every step at 60 Hz and bounced off the edges of the field
+	constexpr float deltaTime{ 1.0f / 60.0f };
+	constexpr float cellSize{ 2.0f };
+	std::uint32_t random{ 2463534242u };
+	auto next{ [&random]()
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			return static_cast<float>(random >> 8) * (1.0f / 16777216.0f);
+		} };
+
+	std::vector<int> threadCounts{ 1 };
+	if (maxThreads > 1)
+		threadCounts.push_back(maxThreads);
+
+	for (int count : { 10000, 100000 })
+	{
+		const float side{ std::sqrt(count * 4.0f) };
+		std::vector<glm::vec3> positions(count);
+		std::vector<glm::vec3> velocities(count);
+		std::vector<glm::vec3> halfSizes(count);
+		for (int i{ 0 }; i < count; ++i)
+		{
+			positions[i] = glm::vec3(next() * side, next() * 2.0f, next() * side);
+			float angle{ 6.28318531f * next() };
+			float speed{ 1.0f + next() * 3.0f };
+			velocities[i] = glm::vec3(std::cos(angle) * speed, 0.0f, std::sin(angle) * speed);
+			halfSizes[i] = glm::vec3(0.3f + next() * 0.4f, 0.5f + next() * 0.5f, 0.3f + next() * 0.4f);
+		}
+		const std::vector<glm::vec3> startPositions{ positions };
+
+		for (int threads : threadCounts)
+		{
+			JobSystem jobs{ threads };
+			positions = startPositions;
+			BroadPhase broadPhase{ cellSize };
+			for (int i{ 0 }; i < count; ++i)
+				broadPhase.add(positions[i] - halfSizes[i], positions[i] + halfSizes[i]);
+			broadPhase.update(jobs);
+
+			std::string name{ "physics/broad_phase/bodies:" + std::to_string(count) + "/threads:" + std::to_string(threads) };
+			runner.run(name, [&]()
+				{
+					jobs.parallelFor(0, count, 0, [&](int first, int last)
+						{
+							for (int i{ first }; i < last; ++i)
+							{
+								glm::vec3& position{ positions[i] };
+								position += velocities[i] * deltaTime;
+								if (position.x < 0.0f || position.x > side)
+									velocities[i].x = -velocities[i].x;
+								if (position.z < 0.0f || position.z > side)
+									velocities[i].z = -velocities[i].z;
+								broadPhase.setBounds(i, position - halfSizes[i], position + halfSizes[i]);
+							}
+						});
+					benchmark::doNotOptimize(broadPhase.update(jobs).size());
+				}, count);
+			runner.addCounter("pairs", static_cast<double>(broadPhase.getPairs().size()));
+			runner.addCounter("rebinned", static_cast<double>(broadPhase.getRebinnedCount()));
+			runner.addCounter("cells", static_cast<double>(broadPhase.getCellCount()));
+		}
+	}
+
+	// What the grid replaces, every box against every other
+	constexpr int bruteCount{ 10000 };
+	const float bruteSide{ std::sqrt(bruteCount * 4.0f) };
+	std::vector<glm::vec3> mins(bruteCount);
+	std::vector<glm::vec3> maxs(bruteCount);
+	for (int i{ 0 }; i < bruteCount; ++i)
+	{
+		glm::vec3 position{ next() * bruteSide, next() * 2.0f, next() * bruteSide };
+		glm::vec3 halfSize{ 0.3f + next() * 0.4f, 0.5f + next() * 0.5f, 0.3f + next() * 0.4f };
+		mins[i] = position - halfSize;
+		maxs[i] = position + halfSize;
+	}
+	runner.run("physics/brute_force/bodies:" + std::to_string(bruteCount), [&mins, &maxs]()
+		{
+			int pairs{ 0 };
+			for (int a{ 0 }; a < bruteCount; ++a)
+			{
+				for (int b{ a + 1 }; b < bruteCount; ++b)
+				{
+					pairs += mins[b].x <= maxs[a].x && maxs[b].x >= mins[a].x && mins[b].y <= maxs[a].y && maxs[b].y >= mins[a].y
+						&& mins[b].z <= maxs[a].z && maxs[b].z >= mins[a].z;
+				}
+			}
+			benchmark::doNotOptimize(pairs);
+		}, bruteCount);
+}
+
+void benchmarkPathfinding(benchmark::Runner& runner, const TerrainGenerator& generator, int maxThreads)
+{
+	if (!runner.wants("path"))
+		return;
+
+	// 16 by 16 chunks, 256 by 256 columns of the seeded terrain
+	constexpr int side{ 16 };
+	const ChunkCoord minCoord{ -side / 2, -side / 2 };
+	std::vector<Chunk> chunks{};
+	chunks.reserve(side * side);
+	for (int z{ 0 }; z < side; ++z)
+	{
+		for (int x{ 0 }; x < side; ++x)
+		{
+			chunks.emplace_back(ChunkCoord{ minCoord.x + x, minCoord.z + z });
+			generator.generate(chunks.back());
+		}
+	}
+
+	NavGrid grid{};
+	runner.run("path/build_grid/chunks:" + std::to_string(side * side), [&grid, &chunks]()
+		{
+			grid = NavGrid{};
+			for (const Chunk& chunk : chunks)
+				grid.addChunk(chunk);
+			grid.rebuild();
+			benchmark::doNotOptimize(grid.getNodeCount());
+		}, static_cast<double>(chunks.size()));
+	runner.addCounter("portals", static_cast<double>(grid.getNodeCount()));
+
+	// Seeded requests between walkable columns 32 to 128 blocks apart, how far a mob would chase or wander
+	const int originX{ minCoord.x * Chunk::sizeX };
+	const int originZ{ minCoord.z * Chunk::sizeZ };
+	const int extent{ side * Chunk::sizeX };
+	std::uint32_t random{ 2463534242u };
+	auto next{ [&random](int range)
+		{
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			return static_cast<int>(random % static_cast<std::uint32_t>(range));
+		} };
+
+	constexpr int requestCount{ 256 };
+	std::vector<std::pair<glm::ivec3, glm::ivec3>> requests{};
+	while (static_cast<int>(requests.size()) < requestCount)
+	{
+		glm::ivec3 start{ originX + next(extent), 0, originZ + next(extent) };
+		glm::ivec3 goal{ originX + next(extent), 0, originZ + next(extent) };
+		int dx{ goal.x - start.x };
+		int dz{ goal.z - start.z };
+		if (dx * dx + dz * dz < 32 * 32 || dx * dx + dz * dz > 128 * 128)
+			continue;
+		if (grid.getHeight(start.x, start.z) == NavGrid::blocked || grid.getHeight(goal.x, goal.z) == NavGrid::blocked)
+			continue;
+		requests.emplace_back(start, goal);
+	}
+
+	std::vector<int> threadCounts{ 1 };
+	if (maxThreads > 1)
+		threadCounts.push_back(maxThreads);
+
+	for (int threads : threadCounts)
+	{
+		JobSystem jobs{ threads };
+		PathQueue queue{ requestCount };
+		std::vector<int> ids(requestCount);
+		runner.run("path/hierarchical/requests:" + std::to_string(requestCount) + "/threads:" + std::to_string(threads), [&]()
+			{
+				for (int i{ 0 }; i < requestCount; ++i)
+					ids[i] = queue.submit(requests[i].first, requests[i].second);
+				queue.update(grid, jobs);
+				for (int id : ids)
+					queue.release(id);
+			}, requestCount);
+
+		int found{ 0 };
+		std::size_t steps{ 0 };
+		for (int i{ 0 }; i < requestCount; ++i)
+			ids[i] = queue.submit(requests[i].first, requests[i].second);
+		queue.update(grid, jobs);
+		for (int id : ids)
+		{
+			found += queue.getStatus(id) == PathStatus::found;
+			steps += queue.getPath(id).size();
+			queue.release(id);
+		}
+		runner.addCounter("found", static_cast<double>(found));
+		runner.addCounter("mean_steps", static_cast<double>(steps) / std::max(1, found));
+	}
+
+	// What the hierarchy replaces, A* over every column of the same area
+	std::vector<int> heights(static_cast<std::size_t>(extent) * extent);
+	for (int z{ 0 }; z < extent; ++z)
+		for (int x{ 0 }; x < extent; ++x)
+			heights[static_cast<std::size_t>(z) * extent + x] = grid.getHeight(originX + x, originZ + z);
+
+	auto canStep{ [&heights, extent](int x, int z, int dx, int dz)
+		{
+			int toX{ x + dx };
+			int toZ{ z + dz };
+			if (toX < 0 || toX >= extent || toZ < 0 || toZ >= extent)
+				return false;
+			int to{ heights[static_cast<std::size_t>(toZ) * extent + toX] };
+			return to != NavGrid::blocked && std::abs(to - heights[static_cast<std::size_t>(z) * extent + x]) <= NavGrid::maxStep;
+		} };
+	auto octile{ [](int dx, int dz)
+		{
+			dx = std::abs(dx);
+			dz = std::abs(dz);
+			return static_cast<float>(std::max(dx, dz) - std::min(dx, dz)) + 1.41421356f * static_cast<float>(std::min(dx, dz));
+		} };
+
+	struct Open
+	{
+		float priority{};
+		float cost{};
+		int cell{};
+
+		bool operator>(const Open& other) const
+		{
+			return priority > other.priority;
+		}
+	};
+	std::vector<float> costs(heights.size());
+	std::vector<Open> open{};
+	constexpr int gridRequestCount{ 32 };
+	runner.run("path/grid_astar/requests:" + std::to_string(gridRequestCount), [&]()
+		{
+			for (int i{ 0 }; i < gridRequestCount; ++i)
+			{
+				int startCell{ (requests[i].first.z - originZ) * extent + requests[i].first.x - originX };
+				int goalX{ requests[i].second.x - originX };
+				int goalZ{ requests[i].second.z - originZ };
+				std::fill(costs.begin(), costs.end(), std::numeric_limits<float>::infinity());
+				costs[startCell] = 0.0f;
+				open.clear();
+				open.push_back(Open{ 0.0f, 0.0f, startCell });
+				while (!open.empty())
+				{
+					std::pop_heap(open.begin(), open.end(), std::greater<>{});
+					Open entry{ open.back() };
+					open.pop_back();
+					int x{ entry.cell % extent };
+					int z{ entry.cell / extent };
+					if (x == goalX && z == goalZ)
+						break;
+					if (entry.cost > costs[entry.cell])
+						continue;
+
+					for (int dz{ -1 }; dz <= 1; ++dz)
+					{
+						for (int dx{ -1 }; dx <= 1; ++dx)
+						{
+							if ((dx == 0 && dz == 0) || !canStep(x, z, dx, dz))
+								continue;
+							if (dx != 0 && dz != 0 && !(canStep(x + dx, z, 0, dz) && canStep(x, z, 0, dz) && canStep(x, z + dz, dx, 0)))
+								continue;
+
+							int cell{ entry.cell + dz * extent + dx };
+							float cost{ entry.cost + (dx != 0 && dz != 0 ? 1.41421356f : 1.0f) };
+							if (cost >= costs[cell])
+								continue;
+							costs[cell] = cost;
+							open.push_back(Open{ cost + octile(goalX - x - dx, goalZ - z - dz), cost, cell });
+							std::push_heap(open.begin(), open.end(), std::greater<>{});
+						}
+					}
+				}
+				benchmark::doNotOptimize(costs[static_cast<std::size_t>(goalZ) * extent + goalX]);
+			}
+		}, gridRequestCount);
+
+	// A block dug out of a chunk border and put back, each edit rebuilding the border and both chunks
+	Chunk& edited{ chunks[static_cast<std::size_t>(side / 2) * side + side / 2] };
+	const int editX{ Chunk::sizeX - 1 };
+	const int editZ{ Chunk::sizeZ / 2 };
+	int top{ Chunk::sizeY - 1 };
+	while (top > 0 && !isSolid(edited.get(editX, top, editZ)))
+		--top;
+	const BlockType original{ edited.get(editX, top, editZ) };
+	int rebuiltBefore{ grid.getRebuiltCount() };
+	long long edits{ 0 };
+	runner.run("path/edit_border_block", [&]()
+		{
+			edited.set(editX, top, editZ, edits % 2 == 0 ? BlockType::air : original);
+			grid.updateColumn(edited, editX, editZ);
+			grid.rebuild();
+			++edits;
+		});
+	runner.addCounter("chunks_rebuilt_per_edit", static_cast<double>(grid.getRebuiltCount() - rebuiltBefore) / static_cast<double>(std::max(1ll, edits)));
+}
+
+// Every file packed into the asset archive, in a stable order
+std::vector<std::string> listAssets()
+{
+	std::vector<std::string> paths{};
+	for (const char* directory : { "source/shader", "resource" })
+	{
+		std::error_code error{};
+		for (std::filesystem::recursive_directory_iterator it{ directory, error }, end{}; !error && it != end; it.increment(error))
+		{
+			if (it->is_regular_file())
+				paths.push_back(it->path().generic_string());
+		}
+	}
+	std::sort(paths.begin(), paths.end());
+	return paths;
+}
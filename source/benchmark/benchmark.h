@@ -0,0 +1,303 @@
+/*
+* File: benchmark.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program times small pieces of engine code for the benchmark
+			   executable. Every case is calibrated until one sample takes long
+			   enough to time reliably, then sampled several times and reported by
+			   its median, so results stay comparable between runs and releases.
+			   Results are printed as a table and can be written as JSON
+*/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "../memory/allocation_tracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace benchmark
+{
+	// Keeps the compiler from removing a computation whose result is otherwise unused
+	template <typename T>
+	inline void doNotOptimize(const T& value)
+	{
+#if defined(_MSC_VER)
+		static const void* volatile s_sink{ nullptr };
+		s_sink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	struct Options
+	{
+		// Samples taken of every case, the median of them is the result
+		int samples{ 11 };
+		// Iterations are doubled until one sample takes at least this long
+		double minSampleMs{ 25.0 };
+		// Only cases whose name starts with this run, empty runs everything
+		std::string filter{};
+		// Print the names of the cases instead of running them
+		bool list{ false };
+	};
+
+	struct Result
+	{
+		std::string name{};
+		std::int64_t iterations{};
+		int samples{};
+		// Nanoseconds per iteration
+		double medianNs{};
+		double minNs{};
+		double meanNs{};
+		double stddevNs{};
+		// Work done by one iteration, for throughput
+		double itemsPerIteration{};
+		double bytesPerIteration{};
+		// Counted through operator new, so C allocations such as stb_image's aren't included
+		double allocationsPerIteration{};
+		// Extra values worth tracking, such as memory use
+		std::vector<std::pair<std::string, double>> counters{};
+	};
+
+	class Runner
+	{
+	public:
+		explicit Runner(Options options)
+			: m_options{ std::move(options) }
+		{
+		}
+
+		/*
+		* Checks a group of cases against the filter, for skipping expensive setup
+		* Parameters:
+		* - group: Name prefix shared by the cases of the group
+		* Returns: True if any case of the group may run
+		*/
+		bool wants(const std::string& group) const
+		{
+			return startsWith(group, m_options.filter) || startsWith(m_options.filter, group);
+		}
+
+		/*
+		* Calibrates, samples and records a case
+		* Parameters:
+		* - name: Unique name, groups separated by '/'
+		* - function: Callable running one iteration
+		* - itemsPerIteration: Items handled by one iteration, 0 if throughput means nothing
+		* - bytesPerIteration: Bytes handled by one iteration, 0 if throughput means nothing
+		* Returns: The recorded result, nullptr if the filter skipped the case
+		*/
+		template <typename Function>
+		Result* run(const std::string& name, Function&& function, double itemsPerIteration = 1.0, double bytesPerIteration = 0.0)
+		{
+			if (!startsWith(name, m_options.filter))
+				return nullptr;
+			if (m_options.list)
+			{
+				std::cout << name << '\n';
+				return nullptr;
+			}
+
+			// Doubles the iterations until a sample is long enough, which also warms the caches
+			const double minSampleNs{ m_options.minSampleMs * 1.0e6 };
+			std::int64_t iterations{ 1 };
+			for (;;)
+			{
+				double elapsed{ time(function, iterations) };
+				if (elapsed >= minSampleNs || iterations >= (std::int64_t{ 1 } << 40))
+					break;
+				double scale{ elapsed > 0.0 ? minSampleNs / elapsed * 1.2 : 10.0 };
+				iterations = std::max(iterations * 2, static_cast<std::int64_t>(static_cast<double>(iterations) * std::min(scale, 10.0)));
+			}
+
+			std::vector<double> perIteration(static_cast<std::size_t>(std::max(1, m_options.samples)));
+			std::uint64_t allocationsBefore{ allocationTracker::getAllocationCount() };
+			for (double& sample : perIteration)
+				sample = time(function, iterations) / static_cast<double>(iterations);
+			std::uint64_t allocations{ allocationTracker::getAllocationCount() - allocationsBefore };
+
+			Result result{};
+			result.name = name;
+			result.iterations = iterations;
+			result.samples = static_cast<int>(perIteration.size());
+			result.itemsPerIteration = itemsPerIteration;
+			result.bytesPerIteration = bytesPerIteration;
+			result.allocationsPerIteration = static_cast<double>(allocations) / static_cast<double>(iterations * result.samples);
+
+			double sum{ 0.0 };
+			for (double sample : perIteration)
+				sum += sample;
+			result.meanNs = sum / result.samples;
+			double squares{ 0.0 };
+			for (double sample : perIteration)
+				squares += (sample - result.meanNs) * (sample - result.meanNs);
+			result.stddevNs = std::sqrt(squares / result.samples);
+
+			std::sort(perIteration.begin(), perIteration.end());
+			result.minNs = perIteration.front();
+			std::size_t middle{ perIteration.size() / 2 };
+			result.medianNs = perIteration.size() % 2 ? perIteration[middle] : (perIteration[middle - 1] + perIteration[middle]) * 0.5;
+
+			m_results.push_back(std::move(result));
+			printRow(m_results.back());
+			return &m_results.back();
+		}
+
+		/*
+		* Attaches a value to the last recorded case
+		* Parameters:
+		* - name: Counter name
+		* - value: Counter value
+		* Returns: void
+		*/
+		void addCounter(const std::string& name, double value)
+		{
+			if (m_results.empty())
+				return;
+			m_results.back().counters.emplace_back(name, value);
+			std::printf("    %-58s %14.3f\n", name.c_str(), value);
+		}
+
+		const std::vector<Result>& getResults() const
+		{
+			return m_results;
+		}
+
+		const Options& getOptions() const
+		{
+			return m_options;
+		}
+
+		void printHeader() const
+		{
+			if (!m_options.list)
+				std::printf("%-62s %12s %12s %8s %14s %10s\n", "case", "median", "min", "spread", "items/s", "allocs/it");
+		}
+
+		/*
+		* Writes every result as one JSON document
+		* Parameters:
+		* - path: Char pointer to the output file
+		* - threads: Hardware threads of the machine, stored with the results
+		* Returns: False if the file could not be written
+		*/
+		bool writeJson(const char* path, int threads) const
+		{
+			std::ofstream out{ path, std::ios::trunc };
+			if (!out)
+			{
+				std::cout << "ERROR::BENCHMARK::FILE_NOT_WRITABLE: " << path << '\n';
+				return false;
+			}
+
+			out.precision(17);
+			out << "{\n\t\"format\": 1,\n";
+			out << "\t\"compiler\": \"" << compiler() << "\",\n";
+#ifdef NDEBUG
+			out << "\t\"build\": \"release\",\n";
+#else
+			out << "\t\"build\": \"debug\",\n";
+#endif
+			out << "\t\"threads\": " << threads << ",\n";
+			out << "\t\"samples\": " << m_options.samples << ",\n";
+			out << "\t\"min_sample_ms\": " << m_options.minSampleMs << ",\n";
+			out << "\t\"results\": [";
+			for (std::size_t i{ 0 }; i < m_results.size(); ++i)
+			{
+				const Result& result{ m_results[i] };
+				out << (i ? ",\n" : "\n") << "\t\t{ \"name\": \"" << result.name << '"'
+					<< ", \"iterations\": " << result.iterations
+					<< ", \"samples\": " << result.samples
+					<< ", \"median_ns\": " << result.medianNs
+					<< ", \"min_ns\": " << result.minNs
+					<< ", \"mean_ns\": " << result.meanNs
+					<< ", \"stddev_ns\": " << result.stddevNs
+					<< ", \"items_per_second\": " << perSecond(result.itemsPerIteration, result.medianNs)
+					<< ", \"bytes_per_second\": " << perSecond(result.bytesPerIteration, result.medianNs)
+					<< ", \"allocations_per_iteration\": " << result.allocationsPerIteration
+					<< ", \"counters\": {";
+				for (std::size_t c{ 0 }; c < result.counters.size(); ++c)
+					out << (c ? ", " : " ") << '"' << result.counters[c].first << "\": " << result.counters[c].second;
+				out << (result.counters.empty() ? "} }" : " } }");
+			}
+			out << "\n\t]\n}\n";
+			return static_cast<bool>(out);
+		}
+
+	private:
+		Options m_options{};
+		std::vector<Result> m_results{};
+
+		template <typename Function>
+		static double time(Function& function, std::int64_t iterations)
+		{
+			auto start{ std::chrono::steady_clock::now() };
+			for (std::int64_t i{ 0 }; i < iterations; ++i)
+				function();
+			auto end{ std::chrono::steady_clock::now() };
+			return std::chrono::duration<double, std::nano>(end - start).count();
+		}
+
+		static bool startsWith(const std::string& text, const std::string& prefix)
+		{
+			return text.compare(0, prefix.size(), prefix) == 0;
+		}
+
+		static double perSecond(double perIteration, double nanoseconds)
+		{
+			return nanoseconds > 0.0 ? perIteration * 1.0e9 / nanoseconds : 0.0;
+		}
+
+		static void printRow(const Result& result)
+		{
+			// Spread is the standard deviation relative to the mean
+			double spread{ result.meanNs > 0.0 ? result.stddevNs / result.meanNs * 100.0 : 0.0 };
+			std::printf("%-62s %12s %12s %7.1f%% %14.4g %10.2f\n", result.name.c_str(), duration(result.medianNs).c_str(),
+				duration(result.minNs).c_str(), spread, perSecond(result.itemsPerIteration, result.medianNs), result.allocationsPerIteration);
+			std::fflush(stdout);
+		}
+
+		static std::string duration(double nanoseconds)
+		{
+			char text[32]{};
+			if (nanoseconds < 1.0e3)
+				std::snprintf(text, sizeof(text), "%.2f ns", nanoseconds);
+			else if (nanoseconds < 1.0e6)
+				std::snprintf(text, sizeof(text), "%.2f us", nanoseconds / 1.0e3);
+			else
+				std::snprintf(text, sizeof(text), "%.2f ms", nanoseconds / 1.0e6);
+			return text;
+		}
+
+		static const char* compiler()
+		{
+#if defined(__clang__)
+			return "clang " __clang_version__;
+#elif defined(__GNUC__)
+			return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+			return "msvc";
+#else
+			return "unknown";
+#endif
+		}
+	};
+}
+
+#endif
@@ -118,6 +118,19 @@ public:
         }
     }
 
+    /*
+    * Sets the height the camera stands at, so it follows the terrain while walking
+    * Parameters:
+    * - height: Eye height above the ground at the camera's position
+    * Returns: void
+    */
+    void setGroundHeight(float height)
+    {
+        m_groundHeight = height;
+        if (!m_isJumping)
+            m_position.y = height;
+    }
+
     /*
     * Updates jump state and position over time
     * Parameters:
@@ -130,8 +143,8 @@ public:
             m_jumpVelocity += m_gravity * deltaTime;
             m_position.y += m_jumpVelocity * deltaTime;
 
-            if (m_position.y <= 2.0f) {
-                m_position.y = 2.0f;
+            if (m_position.y <= m_groundHeight) {
+                m_position.y = m_groundHeight;
                 m_isJumping = false;
                 m_jumpVelocity = 0.0f;
             }
@@ -152,6 +165,7 @@ private:
     float m_sensitivity{ 0.1f };
     float m_fov{ 45.0f };
 
+    float m_groundHeight{ 2.0f };
     bool m_isJumping{ false };
     float m_jumpVelocity{ 0.0f };
     const float m_gravity{ -9.81f };
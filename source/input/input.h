@@ -0,0 +1,391 @@
+/*
+* File: input.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program captures keyboard and mouse input into a timestamped
+			   lock-free event queue that the frame consumes, and can record the
+			   consumed input to file or replay it back for deterministic runs
+*/
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Raw and derived input event types
+enum class InputEventType : std::uint8_t
+{
+	key,
+	cursor,
+	mouseMove,
+};
+
+struct InputEvent
+{
+	double time{};
+	InputEventType type{};
+	int key{};
+	int action{};
+	float x{};
+	float y{};
+};
+
+// Selects where the frame gets its input from
+enum class InputMode
+{
+	live,
+	record,
+	replay,
+};
+
+/*
+* Single producer single consumer ring buffer of input events. The window callbacks
+* push and the frame pops without taking a lock
+*/
+template <std::size_t Capacity>
+class InputQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "InputQueue capacity must be a power of two");
+
+public:
+	/*
+	* Pushes an event onto the queue
+	* Parameters:
+	* - event: The event to store
+	* Returns: False if the queue is full and the event was dropped
+	*/
+	bool push(const InputEvent& event)
+	{
+		std::size_t head{ m_head.load(std::memory_order_relaxed) };
+		if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		m_events[head & (Capacity - 1)] = event;
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*
+	* Pops the oldest event from the queue
+	* Parameters:
+	* - event: Receives the popped event
+	* Returns: False if the queue was empty
+	*/
+	bool pop(InputEvent& event)
+	{
+		std::size_t tail{ m_tail.load(std::memory_order_relaxed) };
+		if (tail == m_head.load(std::memory_order_acquire))
+			return false;
+
+		event = m_events[tail & (Capacity - 1)];
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::array<InputEvent, Capacity> m_events{};
+	alignas(64) std::atomic<std::size_t> m_head{ 0 };
+	alignas(64) std::atomic<std::size_t> m_tail{ 0 };
+};
+
+/*
+* Owns the event queue and the per-frame input state. Recording files start with the
+* magic "FRIN" and a version, followed by one record per frame:
+* float deltaTime, uint16 event count, then per event a uint8 type and its payload
+* (key: uint16 key + uint8 action, cursor: two floats)
+*/
+class InputSystem
+{
+public:
+	static constexpr int maxKeys{ 512 };
+
+	/*
+	* Opens the recording or replay file for the selected mode
+	* Parameters:
+	* - mode: Live, record or replay
+	* - path: Char pointer to the recording file, ignored in live mode
+	* Returns: False if the file could not be opened and input stays live
+	*/
+	bool open(InputMode mode, const char* path)
+	{
+		m_mode = InputMode::live;
+
+		if (mode == InputMode::record)
+		{
+			m_recordFile.open(path, std::ios::binary);
+			if (!m_recordFile)
+			{
+				std::cout << "ERROR::INPUT::RECORDING_NOT_OPENED: " << path << '\n';
+				return false;
+			}
+			m_recordFile.write(s_magic, sizeof(s_magic));
+			writeValue(m_recordFile, s_version);
+		}
+		else if (mode == InputMode::replay)
+		{
+			m_replayFile.open(path, std::ios::binary);
+			char magic[sizeof(s_magic)]{};
+			std::uint16_t version{};
+			m_replayFile.read(magic, sizeof(magic));
+			readValue(m_replayFile, version);
+			if (!m_replayFile || std::memcmp(magic, s_magic, sizeof(s_magic)) != 0 || version != s_version)
+			{
+				std::cout << "ERROR::INPUT::REPLAY_NOT_READABLE: " << path << '\n';
+				return false;
+			}
+		}
+
+		m_mode = mode;
+		return true;
+	}
+
+	InputMode getMode() const
+	{
+		return m_mode;
+	}
+
+	/*
+	* Selects the key whose live events still reach the frame during a replay, so the
+	* replay can be quit
+	* Parameters:
+	* - key: Key code of the quit key, -1 for none
+	* Returns: void
+	*/
+	void setQuitKey(int key)
+	{
+		m_quitKey = key;
+	}
+
+	/*
+	* Queues a key event, called from the window key callback
+	* Parameters:
+	* - time: Timestamp of the event in seconds
+	* - key: Key code of the key
+	* - action: Press, release or repeat
+	* Returns: void
+	*/
+	void onKey(double time, int key, int action)
+	{
+		m_queue.push(InputEvent{ time, InputEventType::key, key, action, 0.0f, 0.0f });
+	}
+
+	/*
+	* Queues a cursor event, called from the window cursor callback
+	* Parameters:
+	* - time: Timestamp of the event in seconds
+	* - xpos: New x-coordinate of the mouse cursor
+	* - ypos: New y-coordinate of the mouse cursor
+	* Returns: void
+	*/
+	void onCursor(double time, double xpos, double ypos)
+	{
+		m_queue.push(InputEvent{ time, InputEventType::cursor, 0, 0, static_cast<float>(xpos), static_cast<float>(ypos) });
+	}
+
+	/*
+	* Gathers the input for the coming frame from the queue or the replay file
+	* and updates the key state and mouse movement events
+	* Parameters:
+	* - measuredDeltaTime: Frame time measured by the caller
+	* Returns: The delta time the frame should simulate with
+	*/
+	float beginFrame(float measuredDeltaTime)
+	{
+		m_rawEvents.clear();
+		m_frameEvents.clear();
+		m_keyPressed.fill(false);
+
+		float deltaTime{ measuredDeltaTime };
+		InputEvent event{};
+
+		if (m_mode == InputMode::replay)
+		{
+			// Live input is dropped so it can't disturb the replay, all but the quit key
+			while (m_queue.pop(event))
+			{
+				if (event.type == InputEventType::key && event.key == m_quitKey)
+					m_rawEvents.push_back(event);
+			}
+
+			if (!readFrame(deltaTime))
+			{
+				std::cout << "Input replay finished\n";
+				m_mode = InputMode::live;
+				deltaTime = measuredDeltaTime;
+			}
+		}
+		else
+		{
+			while (m_queue.pop(event))
+				m_rawEvents.push_back(event);
+
+			if (m_mode == InputMode::record)
+				writeFrame(deltaTime);
+		}
+
+		for (const InputEvent& raw : m_rawEvents)
+			applyEvent(raw);
+
+		return deltaTime;
+	}
+
+	bool isKeyDown(int key) const
+	{
+		return key >= 0 && key < maxKeys && m_keyDown[key];
+	}
+
+	// True only in the frame the key went down, for toggles that must not repeat
+	bool wasKeyPressed(int key) const
+	{
+		return key >= 0 && key < maxKeys && m_keyPressed[key];
+	}
+
+	// Mouse movement events with offsets since the previous cursor position
+	const std::vector<InputEvent>& getFrameEvents() const
+	{
+		return m_frameEvents;
+	}
+
+private:
+	static constexpr char s_magic[4]{ 'F', 'R', 'I', 'N' };
+	static constexpr std::uint16_t s_version{ 1 };
+
+	InputMode m_mode{ InputMode::live };
+	InputQueue<1024> m_queue{};
+
+	std::vector<InputEvent> m_rawEvents{};
+	std::vector<InputEvent> m_frameEvents{};
+	// A replayed frame is read into this first, so a truncated one adds no events
+	std::vector<InputEvent> m_replayEvents{};
+	int m_quitKey{ -1 };
+	std::array<bool, maxKeys> m_keyDown{};
+	std::array<bool, maxKeys> m_keyPressed{};
+
+	float m_lastX{};
+	float m_lastY{};
+	bool m_firstMouse{ true };
+
+	std::ofstream m_recordFile{};
+	std::ifstream m_replayFile{};
+
+	/*
+	* Updates key state and converts cursor positions into movement offsets
+	* Parameters:
+	* - event: Raw key or cursor event
+	* Returns: void
+	*/
+	void applyEvent(const InputEvent& event)
+	{
+		if (event.type == InputEventType::key)
+		{
+			if (event.key >= 0 && event.key < maxKeys)
+			{
+				// Action 1 is a press, key repeats (2) don't count as new presses
+				m_keyPressed[event.key] = m_keyPressed[event.key] || event.action == 1;
+				m_keyDown[event.key] = event.action != 0;
+			}
+			return;
+		}
+
+		if (m_firstMouse)
+		{
+			m_lastX = event.x;
+			m_lastY = event.y;
+			m_firstMouse = false;
+		}
+
+		float xoffset{ event.x - m_lastX };
+		float yoffset{ m_lastY - event.y };
+		m_lastX = event.x;
+		m_lastY = event.y;
+
+		m_frameEvents.push_back(InputEvent{ event.time, InputEventType::mouseMove, 0, 0, xoffset, yoffset });
+	}
+
+	void writeFrame(float deltaTime)
+	{
+		writeValue(m_recordFile, deltaTime);
+		writeValue(m_recordFile, static_cast<std::uint16_t>(m_rawEvents.size()));
+		for (const InputEvent& event : m_rawEvents)
+		{
+			writeValue(m_recordFile, static_cast<std::uint8_t>(event.type));
+			if (event.type == InputEventType::key)
+			{
+				writeValue(m_recordFile, static_cast<std::uint16_t>(event.key));
+				writeValue(m_recordFile, static_cast<std::uint8_t>(event.action));
+			}
+			else
+			{
+				writeValue(m_recordFile, event.x);
+				writeValue(m_recordFile, event.y);
+			}
+		}
+	}
+
+	// Reads the next recorded frame, on failure deltaTime and the frame's events are left as they were
+	bool readFrame(float& deltaTime)
+	{
+		m_replayEvents.clear();
+
+		float frameDeltaTime{};
+		std::uint16_t count{};
+		readValue(m_replayFile, frameDeltaTime);
+		readValue(m_replayFile, count);
+		if (!m_replayFile)
+			return false;
+
+		for (std::uint16_t i{ 0 }; i < count && m_replayFile; ++i)
+		{
+			std::uint8_t type{};
+			readValue(m_replayFile, type);
+
+			InputEvent event{};
+			event.type = static_cast<InputEventType>(type);
+			if (event.type == InputEventType::key)
+			{
+				std::uint16_t key{};
+				std::uint8_t action{};
+				readValue(m_replayFile, key);
+				readValue(m_replayFile, action);
+				event.key = key;
+				event.action = action;
+			}
+			else
+			{
+				readValue(m_replayFile, event.x);
+				readValue(m_replayFile, event.y);
+			}
+			m_replayEvents.push_back(event);
+		}
+
+		if (!m_replayFile)
+		{
+			std::cout << "ERROR::INPUT::REPLAY_TRUNCATED: last frame dropped\n";
+			return false;
+		}
+
+		deltaTime = frameDeltaTime;
+		m_rawEvents.insert(m_rawEvents.end(), m_replayEvents.begin(), m_replayEvents.end());
+		return true;
+	}
+
+	template <typename T>
+	static void writeValue(std::ofstream& file, const T& value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	static void readValue(std::ifstream& file, T& value)
+	{
+		file.read(reinterpret_cast<char*>(&value), sizeof(T));
+	}
+};
+
+#endif
@@ -0,0 +1,299 @@
+/*
+* File: asset_archive.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program reads the packed asset archive written by the asset
+			   packer. The archive is mapped once and assets are handed out as
+			   views straight into the mapping, found through a table of contents
+			   sorted by path hash. Loose files can override archived ones while
+			   developing
+*/
+
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+namespace assetArchive
+{
+	// "FRPK"
+	constexpr std::uint8_t magic[4]{ 'F', 'R', 'P', 'K' };
+	constexpr std::uint32_t version{ 1 };
+
+	// Entry data starts on this boundary so it can be read with aligned loads
+	constexpr std::uint64_t alignment{ 64 };
+
+	// Fixed layout, little endian like every platform the engine runs on
+	struct Header
+	{
+		std::uint8_t magic[4]{};
+		std::uint32_t version{};
+		std::uint32_t entryCount{};
+		std::uint32_t reserved{};
+		std::uint64_t tableOffset{};
+		std::uint64_t pathsOffset{};
+	};
+
+	// Table entries are sorted by hash, the path resolves collisions
+	struct Entry
+	{
+		std::uint64_t hash{};
+		std::uint64_t offset{};
+		std::uint64_t size{};
+		std::uint32_t pathOffset{};
+		std::uint32_t pathLength{};
+	};
+
+	static_assert(sizeof(Header) == 32, "Header is read straight from the file");
+	static_assert(sizeof(Entry) == 32, "Entries are read straight from the file");
+
+	// 64-bit FNV-1a of a path with '/' separators
+	inline std::uint64_t hashPath(std::string_view path)
+	{
+		std::uint64_t hash{ 14695981039346656037ull };
+		for (char c : path)
+		{
+			hash ^= static_cast<std::uint8_t>(c == '\\' ? '/' : c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
+
+/*
+* Read-only view of an asset's bytes. An archived asset points into the archive
+* mapping, a loose file keeps its own mapping alive for as long as the view exists
+*/
+class Asset
+{
+public:
+	Asset() = default;
+
+	Asset(const std::uint8_t* data, std::size_t size)
+		: m_data{ data }
+		, m_size{ size }
+	{
+	}
+
+	explicit Asset(std::unique_ptr<MappedFile> loose)
+		: m_data{ loose->data() }
+		, m_size{ loose->size() }
+		, m_loose{ std::move(loose) }
+	{
+	}
+
+	const std::uint8_t* data() const
+	{
+		return m_data;
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	// The bytes as text, not null terminated
+	std::string_view text() const
+	{
+		return std::string_view{ reinterpret_cast<const char*>(m_data), m_size };
+	}
+
+	// False if the asset was not found, an empty file still counts as found
+	bool isValid() const
+	{
+		return m_found;
+	}
+
+private:
+	const std::uint8_t* m_data{ nullptr };
+	std::size_t m_size{ 0 };
+	std::unique_ptr<MappedFile> m_loose{};
+	bool m_found{ m_data != nullptr || m_loose != nullptr };
+};
+
+class AssetArchive
+{
+public:
+	/*
+	* Maps an archive and checks its table of contents
+	* Parameters:
+	* - path: Char pointer to the archive path
+	* Returns: False if the file is missing or not a valid archive
+	*/
+	bool open(const char* path)
+	{
+		m_entries = nullptr;
+		m_entryCount = 0;
+		if (!m_file.open(path))
+			return false;
+
+		const std::uint8_t* data{ m_file.data() };
+		std::size_t size{ m_file.size() };
+
+		assetArchive::Header header{};
+		if (size < sizeof(header))
+			return fail(path);
+		std::memcpy(&header, data, sizeof(header));
+
+		if (std::memcmp(header.magic, assetArchive::magic, sizeof(header.magic)) != 0 || header.version != assetArchive::version)
+			return fail(path);
+		if (header.tableOffset % alignof(assetArchive::Entry) != 0 || header.tableOffset > size
+			|| header.entryCount > (size - header.tableOffset) / sizeof(assetArchive::Entry) || header.pathsOffset > size)
+			return fail(path);
+
+		m_entries = reinterpret_cast<const assetArchive::Entry*>(data + header.tableOffset);
+		m_entryCount = header.entryCount;
+		m_paths = reinterpret_cast<const char*>(data + header.pathsOffset);
+		m_pathsSize = size - static_cast<std::size_t>(header.pathsOffset);
+
+		for (std::uint32_t i{ 0 }; i < m_entryCount; ++i)
+		{
+			const assetArchive::Entry& entry{ m_entries[i] };
+			if (entry.offset > size || entry.size > size - entry.offset
+				|| entry.pathOffset > m_pathsSize || entry.pathLength > m_pathsSize - entry.pathOffset)
+				return fail(path);
+		}
+		return true;
+	}
+
+	/*
+	* Looks an asset up by the path it was packed under
+	* Parameters:
+	* - path: Path relative to the directory the archive was packed from
+	* Returns: View into the mapping, invalid if the archive has no such asset
+	*/
+	Asset find(std::string_view path) const
+	{
+		std::uint64_t hash{ assetArchive::hashPath(path) };
+		const assetArchive::Entry* end{ m_entries + m_entryCount };
+		const assetArchive::Entry* entry{ std::lower_bound(m_entries, end, hash, [](const assetArchive::Entry& e, std::uint64_t h) { return e.hash < h; }) };
+
+		for (; entry != end && entry->hash == hash; ++entry)
+		{
+			std::string_view stored{ m_paths + entry->pathOffset, entry->pathLength };
+			if (samePath(stored, path))
+				return Asset{ m_file.data() + entry->offset, static_cast<std::size_t>(entry->size) };
+		}
+		return Asset{};
+	}
+
+	bool isOpen() const
+	{
+		return m_entries != nullptr;
+	}
+
+	std::size_t getCount() const
+	{
+		return m_entryCount;
+	}
+
+private:
+	MappedFile m_file{};
+	const assetArchive::Entry* m_entries{ nullptr };
+	std::uint32_t m_entryCount{ 0 };
+	const char* m_paths{ nullptr };
+	std::size_t m_pathsSize{ 0 };
+
+	bool fail(const char* path)
+	{
+		std::cout << "ERROR::ASSET_ARCHIVE::INVALID: " << path << '\n';
+		m_file.close();
+		m_entries = nullptr;
+		m_entryCount = 0;
+		return false;
+	}
+
+	static bool samePath(std::string_view stored, std::string_view path)
+	{
+		if (stored.size() != path.size())
+			return false;
+		for (std::size_t i{ 0 }; i < path.size(); ++i)
+		{
+			char c{ path[i] == '\\' ? '/' : path[i] };
+			if (stored[i] != c)
+				return false;
+		}
+		return true;
+	}
+};
+
+/*
+* Opens assets from the archive, falling back to loose files for anything it lacks.
+* With loose override on, a loose file always wins over its archived copy
+*/
+class AssetLoader
+{
+public:
+	/*
+	* Maps the archive if there is one
+	* Parameters:
+	* - archivePath: Char pointer to the archive path, a missing archive means loose files only
+	* - looseOverride: Prefer loose files over archived ones, for editing assets without repacking
+	* Returns: AssetLoader object
+	*/
+	explicit AssetLoader(const char* archivePath, bool looseOverride = false)
+		: m_looseOverride{ looseOverride }
+	{
+		m_archive.open(archivePath);
+	}
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	/*
+	* Finds an asset
+	* Parameters:
+	* - path: Char pointer to the path relative to the working directory
+	* Returns: View of the asset, invalid if it exists neither loose nor archived
+	*/
+	Asset open(const char* path) const
+	{
+		if (m_looseOverride)
+		{
+			Asset loose{ openLoose(path) };
+			if (loose.isValid())
+				return loose;
+		}
+
+		if (m_archive.isOpen())
+		{
+			Asset archived{ m_archive.find(path) };
+			if (archived.isValid())
+				return archived;
+		}
+
+		return m_looseOverride ? Asset{} : openLoose(path);
+	}
+
+	bool hasArchive() const
+	{
+		return m_archive.isOpen();
+	}
+
+	std::size_t getArchivedCount() const
+	{
+		return m_archive.getCount();
+	}
+
+private:
+	AssetArchive m_archive{};
+	bool m_looseOverride{};
+
+	static Asset openLoose(const char* path)
+	{
+		auto file{ std::make_unique<MappedFile>() };
+		if (!file->open(path))
+			return Asset{};
+		return Asset{ std::move(file) };
+	}
+};
+
+#endif
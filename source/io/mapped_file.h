@@ -0,0 +1,153 @@
+/*
+* File: mapped_file.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program maps a file read-only into memory so it can be read
+			   at random without copying it through a stream first
+*/
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+
+	~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			m_data = other.m_data;
+			m_size = other.m_size;
+			other.m_data = nullptr;
+			other.m_size = 0;
+		}
+		return *this;
+	}
+
+	/*
+	* Maps the whole file, an empty file opens without data
+	* Parameters:
+	* - path: Char pointer to the file path
+	* Returns: False if the file could not be opened or mapped
+	*/
+	bool open(const char* path)
+	{
+		close();
+
+#ifdef _WIN32
+		HANDLE file{ CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		m_size = static_cast<std::size_t>(size.QuadPart);
+		if (m_size > 0)
+		{
+			HANDLE mapping{ CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+			if (mapping != nullptr)
+			{
+				m_data = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+#else
+		int file{ ::open(path, O_RDONLY) };
+		if (file < 0)
+			return false;
+
+		struct stat info{};
+		if (fstat(file, &info) != 0)
+		{
+			::close(file);
+			return false;
+		}
+
+		m_size = static_cast<std::size_t>(info.st_size);
+		if (m_size > 0)
+		{
+			void* data{ mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0) };
+			m_data = data == MAP_FAILED ? nullptr : static_cast<const std::uint8_t*>(data);
+		}
+		::close(file);
+#endif
+
+		if (m_size > 0 && m_data == nullptr)
+		{
+			m_size = 0;
+			return false;
+		}
+		return true;
+	}
+
+	void close()
+	{
+		if (m_data != nullptr)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(m_data);
+#else
+			munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+		}
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	const std::uint8_t* data() const
+	{
+		return m_data;
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+private:
+	const std::uint8_t* m_data{ nullptr };
+	std::size_t m_size{ 0 };
+};
+
+#endif
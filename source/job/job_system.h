@@ -0,0 +1,469 @@
+/*
+* File: job_system.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program defines a job system with a fixed pool of worker threads
+			   that steal work from each other's deques. Jobs are allocated from
+			   per-thread pools and synchronized with counters. Long running
+			   background jobs have deques of their own that the thread owning the
+			   job system never takes from, so its waits only run short work
+*/
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Counts unfinished jobs, a job group is done when it reaches zero
+struct JobCounter
+{
+	std::atomic<int> value{ 0 };
+
+	bool isDone() const
+	{
+		return value.load(std::memory_order_acquire) == 0;
+	}
+};
+
+struct Job
+{
+	static constexpr std::size_t storageSize{ 64 };
+
+	void (*invoke)(Job* job){ nullptr };
+	void (*destroy)(Job* job){ nullptr };
+	JobCounter* counter{ nullptr };
+	const JobCounter* dependency{ nullptr };
+	// Queued on the background deques, never run by worker 0
+	bool background{ false };
+	std::atomic<bool> inUse{ false };
+	alignas(std::max_align_t) unsigned char storage[storageSize]{};
+};
+
+/*
+* Chase-Lev deque. The owning thread pushes and pops at the bottom,
+* other threads steal from the top
+*/
+class JobDeque
+{
+public:
+	static constexpr std::int64_t capacity{ 4096 };
+
+	bool push(Job* job)
+	{
+		std::int64_t bottom{ m_bottom.load(std::memory_order_relaxed) };
+		std::int64_t top{ m_top.load(std::memory_order_acquire) };
+		if (bottom - top >= capacity)
+			return false;
+
+		m_jobs[bottom & (capacity - 1)].store(job, std::memory_order_relaxed);
+		m_bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	Job* pop()
+	{
+		std::int64_t bottom{ m_bottom.load(std::memory_order_relaxed) - 1 };
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t top{ m_top.load(std::memory_order_relaxed) };
+
+		if (top > bottom)
+		{
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job{ m_jobs[bottom & (capacity - 1)].load(std::memory_order_relaxed) };
+		if (top == bottom)
+		{
+			// Last job left, race the thieves for it
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* steal()
+	{
+		std::int64_t top{ m_top.load(std::memory_order_acquire) };
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t bottom{ m_bottom.load(std::memory_order_acquire) };
+		if (top >= bottom)
+			return nullptr;
+
+		Job* job{ m_jobs[top & (capacity - 1)].load(std::memory_order_relaxed) };
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return job;
+	}
+
+private:
+	alignas(64) std::atomic<std::int64_t> m_top{ 0 };
+	alignas(64) std::atomic<std::int64_t> m_bottom{ 0 };
+	std::atomic<Job*> m_jobs[capacity]{};
+};
+
+class JobSystem
+{
+public:
+	static constexpr std::size_t poolSize{ 4096 };
+
+	/*
+	* Starts the worker threads. The thread constructing the job system becomes
+	* worker 0 and runs jobs whenever it waits. With a single thread one more is
+	* started that only runs background jobs, so they progress while worker 0 never
+	* waits on them
+	* Parameters:
+	* - threadCount: Threads running parallel work including the calling one, 0 picks one per core
+	* Returns: JobSystem object
+	*/
+	explicit JobSystem(int threadCount = 0)
+		: m_threadCount{ threadCount > 0 ? threadCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency())) }
+	{
+		int workerCount{ std::max(2, m_threadCount) };
+		m_workers.reserve(workerCount);
+		for (int i{ 0 }; i < workerCount; ++i)
+			m_workers.push_back(std::make_unique<Worker>());
+
+		s_workerIndex = 0;
+		s_owner = this;
+
+		for (int i{ 1 }; i < workerCount; ++i)
+			m_threads.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+
+	~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_sleepMutex };
+			m_running.store(false, std::memory_order_release);
+		}
+		m_wakeUp.notify_all();
+
+		for (std::thread& thread : m_threads)
+			thread.join();
+
+		s_owner = nullptr;
+	}
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Threads running parallel work, a background-only thread is not counted
+	int getThreadCount() const
+	{
+		return m_threadCount;
+	}
+
+	/*
+	* Queues a job on the calling thread's deque
+	* Parameters:
+	* - function: Callable taking no arguments, must fit in Job::storageSize bytes
+	* - counter: Optional counter incremented now and decremented when the job finishes
+	* - dependency: Optional counter that must reach zero before the job starts
+	* Returns: void
+	*/
+	template <typename Function>
+	void run(Function&& function, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr)
+	{
+		queue(std::forward<Function>(function), counter, dependency, false);
+	}
+
+	/*
+	* Queues a long running job, such as generating a chunk, that only the worker
+	* threads run. Waits on worker 0 don't pick it up, so a frame is never held up by it
+	* Parameters:
+	* - function: Callable taking no arguments, must fit in Job::storageSize bytes
+	* - counter: Optional counter incremented now and decremented when the job finishes
+	* - dependency: Optional counter that must reach zero before the job starts
+	* Returns: void
+	*/
+	template <typename Function>
+	void runBackground(Function&& function, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr)
+	{
+		queue(std::forward<Function>(function), counter, dependency, true);
+	}
+
+	/*
+	* Runs jobs until the counter reaches zero instead of blocking
+	* Parameters:
+	* - counter: Counter of the jobs to wait for
+	* Returns: void
+	*/
+	void wait(const JobCounter& counter)
+	{
+		while (!counter.isDone())
+		{
+			if (s_owner != this || !runOneJob(s_workerIndex))
+				std::this_thread::yield();
+		}
+	}
+
+	/*
+	* Splits [begin, end) into chunks and processes them in parallel, returning once all are done
+	* Parameters:
+	* - begin: First index
+	* - end: One past the last index
+	* - chunkSize: Indices per job, 0 picks a size giving a few chunks per thread
+	* - function: Callable taking (int first, int last) for one chunk
+	* Returns: void
+	*/
+	template <typename Function>
+	void parallelFor(int begin, int end, int chunkSize, const Function& function)
+	{
+		if (end <= begin)
+			return;
+
+		if (chunkSize <= 0)
+			chunkSize = std::max(1, (end - begin + m_threadCount * 4 - 1) / (m_threadCount * 4));
+
+		JobCounter counter{};
+		for (int first{ begin }; first < end; first += chunkSize)
+		{
+			int last{ std::min(end, first + chunkSize) };
+			run([&function, first, last]() { function(first, last); }, &counter);
+		}
+		wait(counter);
+	}
+
+private:
+	struct Worker
+	{
+		JobDeque deque{};
+		JobDeque background{};
+		std::unique_ptr<Job[]> pool{ std::make_unique<Job[]>(poolSize) };
+		std::size_t nextJob{ 0 };
+	};
+
+	static inline thread_local int s_workerIndex{ -1 };
+	static inline thread_local JobSystem* s_owner{ nullptr };
+
+	int m_threadCount{};
+	std::vector<std::unique_ptr<Worker>> m_workers{};
+	std::vector<std::thread> m_threads{};
+
+	std::atomic<bool> m_running{ true };
+	std::atomic<int> m_queued{ 0 };
+	std::mutex m_sleepMutex{};
+	std::condition_variable m_wakeUp{};
+
+	/*
+	* Allocates and queues a job, or runs it inline when that isn't possible
+	* Parameters:
+	* - function: Callable taking no arguments, must fit in Job::storageSize bytes
+	* - counter: Optional counter incremented now and decremented when the job finishes
+	* - dependency: Optional counter that must reach zero before the job starts
+	* - background: Whether the job goes on the background deques
+	* Returns: void
+	*/
+	template <typename Function>
+	void queue(Function&& function, JobCounter* counter, const JobCounter* dependency, bool background)
+	{
+		using Callable = std::decay_t<Function>;
+		static_assert(sizeof(Callable) <= Job::storageSize, "Job callable is too large for the job pool");
+		static_assert(alignof(Callable) <= alignof(std::max_align_t), "Job callable is over-aligned");
+
+		if (counter)
+			counter->value.fetch_add(1, std::memory_order_relaxed);
+
+		// Threads outside the pool can't own jobs and a pool with every slot in use has
+		// none left, so they run the job inline
+		Job* job{ s_owner == this ? allocateJob() : nullptr };
+		if (!job)
+		{
+			if (dependency)
+				wait(*dependency);
+			function();
+			if (counter)
+				counter->value.fetch_sub(1, std::memory_order_release);
+			return;
+		}
+
+		new (job->storage) Callable(std::forward<Function>(function));
+		job->invoke = [](Job* self) { (*std::launder(reinterpret_cast<Callable*>(self->storage)))(); };
+		job->destroy = [](Job* self) { std::launder(reinterpret_cast<Callable*>(self->storage))->~Callable(); };
+		job->counter = counter;
+		job->dependency = dependency;
+		job->background = background;
+
+		submit(job);
+	}
+
+	/*
+	* Takes a free job slot from the calling thread's pool. Slots still in use are
+	* skipped, they may belong to jobs further up this thread's stack that can't
+	* finish before the new job does
+	* Parameters: None
+	* Returns: Pointer to a free job, null when every slot is in use
+	*/
+	Job* allocateJob()
+	{
+		Worker& worker{ *m_workers[s_workerIndex] };
+		for (std::size_t i{ 0 }; i < poolSize; ++i)
+		{
+			Job* job{ &worker.pool[worker.nextJob++ & (poolSize - 1)] };
+			// Only the owning thread marks its slots used, so the check can't race
+			if (!job->inUse.load(std::memory_order_acquire))
+			{
+				job->inUse.store(true, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		return nullptr;
+	}
+
+	void submit(Job* job)
+	{
+		Worker& worker{ *m_workers[s_workerIndex] };
+		m_queued.fetch_add(1, std::memory_order_release);
+		if (!(job->background ? worker.background : worker.deque).push(job))
+		{
+			// Deque is full, run it here rather than drop it, but not before its dependency
+			m_queued.fetch_sub(1, std::memory_order_relaxed);
+			while (!isReady(job))
+			{
+				if (!runOneJob(s_workerIndex))
+					std::this_thread::yield();
+			}
+			execute(job);
+			return;
+		}
+
+		m_wakeUp.notify_one();
+	}
+
+	/*
+	* Takes a job for the calling thread. Its own deque comes first, then stealing from
+	* the others, then the background jobs. Worker 0 never takes background jobs and a
+	* background-only thread only steals background jobs
+	* Parameters:
+	* - index: Worker index of the calling thread
+	* - oldest: Take the oldest jobs instead of the newest, in place of a job that isn't
+	*   ready. Background jobs are tried first then, what it waits on is often there
+	* Returns: The job, null if none was found
+	*/
+	Job* takeJob(int index, bool oldest)
+	{
+		Job* job{ oldest ? takeBackgroundJob(index, true) : nullptr };
+		Worker& worker{ *m_workers[index] };
+		if (!job)
+			job = oldest ? worker.deque.steal() : worker.deque.pop();
+		if (!job && index < m_threadCount)
+			job = stealJob(index, false);
+		if (!job && !oldest)
+			job = takeBackgroundJob(index, false);
+		return job;
+	}
+
+	Job* takeBackgroundJob(int index, bool oldest)
+	{
+		if (index == 0)
+			return nullptr;
+
+		Worker& worker{ *m_workers[index] };
+		Job* job{ oldest ? worker.background.steal() : worker.background.pop() };
+		if (!job)
+			job = stealJob(index, true);
+		return job;
+	}
+
+	/*
+	* Pops a job from the own deques or steals one from another thread and runs it
+	* Parameters:
+	* - index: Worker index of the calling thread
+	* Returns: True if a job was run
+	*/
+	bool runOneJob(int index)
+	{
+		Job* job{ takeJob(index, false) };
+		if (!job)
+			return false;
+
+		m_queued.fetch_sub(1, std::memory_order_relaxed);
+
+		if (!isReady(job))
+		{
+			// Run the oldest queued job instead, which is likely what it depends on,
+			// then put the waiting job back
+			Job* deferred{ job };
+			job = takeJob(index, true);
+			if (job)
+				m_queued.fetch_sub(1, std::memory_order_relaxed);
+
+			submit(deferred);
+
+			if (!job)
+				return false;
+			if (!isReady(job))
+			{
+				submit(job);
+				return false;
+			}
+		}
+
+		execute(job);
+		return true;
+	}
+
+	Job* stealJob(int index, bool background)
+	{
+		int workerCount{ static_cast<int>(m_workers.size()) };
+		Job* job{ nullptr };
+		for (int i{ 1 }; !job && i < workerCount; ++i)
+		{
+			Worker& victim{ *m_workers[(index + i) % workerCount] };
+			job = background ? victim.background.steal() : victim.deque.steal();
+		}
+		return job;
+	}
+
+	static bool isReady(const Job* job)
+	{
+		return !job->dependency || job->dependency->isDone();
+	}
+
+	void execute(Job* job)
+	{
+		job->invoke(job);
+		job->destroy(job);
+
+		JobCounter* counter{ job->counter };
+		job->inUse.store(false, std::memory_order_release);
+
+		if (counter)
+			counter->value.fetch_sub(1, std::memory_order_release);
+	}
+
+	void workerLoop(int index)
+	{
+		s_workerIndex = index;
+		s_owner = this;
+
+		while (m_running.load(std::memory_order_acquire))
+		{
+			if (runOneJob(index))
+				continue;
+
+			std::unique_lock<std::mutex> lock{ m_sleepMutex };
+			m_wakeUp.wait_for(lock, std::chrono::milliseconds(1), [this]()
+				{
+					return m_queued.load(std::memory_order_acquire) > 0 || !m_running.load(std::memory_order_acquire);
+				});
+		}
+	}
+};
+
+#endif
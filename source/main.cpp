@@ -6,7 +6,30 @@
 */
 
 #include "camera/camera.h"
+#include "input/input.h"
+#include "io/asset_archive.h"
+#include "job/job_system.h"
+#define ALLOCATION_TRACKER_IMPLEMENTATION
+#include "memory/allocation_tracker.h"
+#include "memory/linear_arena.h"
+#include "render/draw_list.h"
+#include "render/dynamic_resolution.h"
+#include "render/frame_capture.h"
+#include "render/fragment_counter.h"
+#include "render/frustum.h"
+#include "render/gpu_culling.h"
+#include "render/particle_renderer.h"
+#include "render/particle_system.h"
+#include "render/resource_manager.h"
+#include "render/stream_buffer.h"
+#include "render/texture_manager.h"
 #include "shader/shader.h"
+#include "world/block.h"
+#include "world/chunk_manager.h"
+#include "world/particle_emitters.h"
+#include "world/region_file.h"
+#include "world/terrain.h"
+#include "world/terrain_lod.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -16,34 +39,140 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "../external/stbi/stb_image.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 constexpr int SCREEN_WIDTH{ 1600 };
 constexpr int SCREEN_HEIGHT{ 960 };
 
+// Current framebuffer size, kept up to date by framebuffer_size_callback
+int framebufferWidth{ SCREEN_WIDTH };
+int framebufferHeight{ SCREEN_HEIGHT };
+
 float deltaTime{ 0.0f };
 float lastFrame{ 0.0f };
 
 Camera camera{ glm::vec3(0.0f, 2.0f, 0.0f) };
-float lastX{ SCREEN_WIDTH / 2.0f };
-float lastY{ SCREEN_HEIGHT / 2.0f };
-bool firstMouse{ true };
+InputSystem input{};
 
 glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 
+// Point light as laid out by std140 in the PointLightBlock uniform block
+struct PointLightData
+{
+	glm::vec3 position{};
+	float constant{};
+	float linear{};
+	float quadratic{};
+	float padding0[2]{};
+	glm::vec3 ambient{};
+	float padding1{};
+	glm::vec3 diffuse{};
+	float padding2{};
+	glm::vec3 specular{};
+	float padding3{};
+};
+
+// Diffuse and specular texture pair bound for the lit pass
+struct Material
+{
+	TextureResource diffuse{};
+	TextureResource specular{};
+};
+
+// What a pass over the opaque scene writes
+enum class ScenePass
+{
+	// Depth only, for the pre-pass
+	depth,
+	// The lit colour
+	shade,
+	// One heat step per shaded fragment
+	overdraw,
+};
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-unsigned int loadTexture(const char* path);
+void setupInstanceAttributes(unsigned int vao);
+void drawCubeInstances(unsigned int vao, unsigned int instanceBuffer, std::intptr_t instanceOffset, int count);
 
-int main()
+int main(int argc, char* argv[])
 {
+	// --record <file> saves the input of this run, --replay <file> feeds a recording back,
+	// --gpu-budget <ms> sets the GPU time dynamic resolution aims for,
+	// --texture-budget <MB> caps the video memory textures may use,
+	// --gpu-culling culls and submits the chunks on the GPU when GL 4.3 is available,
+	// --assets <file> picks the asset archive, --loose-assets lets loose files override it,
+	// --depth-prepass starts with the depth pre-pass on (F1 toggles it), --overdraw starts
+	// with the overdraw view (F2 toggles it), --capture <directory> records every frame
+	// shown as TGA files, --capture-rle run-length encodes them and
+	// --check-allocations exits with an error if a steady state frame allocates
+	float gpuBudget{ 14.0f };
+	std::size_t textureBudget{ 64 };
+	bool gpuCullingRequested{ false };
+	const char* assetArchivePath{ "assets.pak" };
+	bool looseAssets{ false };
+	bool depthPrepass{ false };
+	bool showOverdraw{ false };
+	const char* capturePath{ nullptr };
+	CaptureEncoding captureEncoding{ CaptureEncoding::raw };
+	bool checkAllocations{ false };
+	// Escape still quits while a recording is replayed
+	input.setQuitKey(GLFW_KEY_ESCAPE);
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		bool hasValue{ i + 1 < argc };
+		if (std::strcmp(argv[i], "--record") == 0 && hasValue)
+			input.open(InputMode::record, argv[++i]);
+		else if (std::strcmp(argv[i], "--replay") == 0 && hasValue)
+			input.open(InputMode::replay, argv[++i]);
+		else if (std::strcmp(argv[i], "--gpu-budget") == 0 && hasValue)
+			gpuBudget = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+		else if (std::strcmp(argv[i], "--texture-budget") == 0 && hasValue)
+			textureBudget = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+		else if (std::strcmp(argv[i], "--gpu-culling") == 0)
+			gpuCullingRequested = true;
+		else if (std::strcmp(argv[i], "--assets") == 0 && hasValue)
+			assetArchivePath = argv[++i];
+		else if (std::strcmp(argv[i], "--loose-assets") == 0)
+			looseAssets = true;
+		else if (std::strcmp(argv[i], "--depth-prepass") == 0)
+			depthPrepass = true;
+		else if (std::strcmp(argv[i], "--overdraw") == 0)
+			showOverdraw = true;
+		else if (std::strcmp(argv[i], "--capture") == 0 && hasValue)
+			capturePath = argv[++i];
+		else if (std::strcmp(argv[i], "--capture-rle") == 0)
+			captureEncoding = CaptureEncoding::rle;
+		else if (std::strcmp(argv[i], "--check-allocations") == 0)
+			checkAllocations = true;
+	}
+
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-	GLFWwindow* window{ glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Freakmon", NULL, NULL) };
+	// GPU culling needs compute shaders, ask for 4.3 first and settle for 3.3 without it
+	GLFWwindow* window{ NULL };
+	if (gpuCullingRequested)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Freakmon", NULL, NULL);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	}
+	if (window == NULL)
+		window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Freakmon", NULL, NULL);
 	if (window == NULL)
 	{
 		std::cout << "Failed to create GLFW window\n";
@@ -52,6 +181,7 @@ int main()
 	}
 	glfwMakeContextCurrent(window);
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetKeyCallback(window, key_callback);
 	glfwSetCursorPosCallback(window, mouse_callback);
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
@@ -63,700 +193,699 @@ int main()
 
 	glEnable(GL_DEPTH_TEST);
 
-	Shader lightingShader{ "source/shader/lighting.vs", "source/shader/lighting.fs" };
-	Shader skyboxShader{ "source/shader/skybox.vs", "source/shader/skybox.fs" };
-	Shader lightCubeShader{ "source/shader/light_cube.vs", "source/shader/light_cube.fs" };
-
-	float vertices[] = {
-		// positions          // normals           // texture coords
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
-		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
-		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
-
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
-		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
-
-		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
-		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
-		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-
-		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
-		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
-
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
-		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
-	};
-
-	glm::vec3 cubePositions[] = {
-		glm::vec3(0.0f,  0.0f, 0.0f),
-		glm::vec3(1.0f,  0.0f, 0.0f),
-		glm::vec3(2.0f,  0.0f, 0.0f),
-		glm::vec3(3.0f,  0.0f, 0.0f),
-		glm::vec3(4.0f,  0.0f, 0.0f),
-		glm::vec3(5.0f,  0.0f, 0.0f),
-		glm::vec3(6.0f,  0.0f, 0.0f),
-		glm::vec3(7.0f,  0.0f, 0.0f),
-		glm::vec3(-1.0f,  0.0f, 0.0f),
-		glm::vec3(-2.0f,  0.0f, 0.0f),
-		glm::vec3(-3.0f,  0.0f, 0.0f),
-		glm::vec3(-4.0f,  0.0f, 0.0f),
-		glm::vec3(-5.0f,  0.0f, 0.0f),
-		glm::vec3(-6.0f,  0.0f, 0.0f),
-		glm::vec3(-7.0f,  0.0f, 0.0f),
-		glm::vec3(-8.0f,  0.0f, 0.0f),
-		glm::vec3(0.0f,  0.0f, 1.0f),
-		glm::vec3(1.0f,  0.0f, 1.0f),
-		glm::vec3(2.0f,  0.0f, 1.0f),
-		glm::vec3(3.0f,  0.0f, 1.0f),
-		glm::vec3(4.0f,  0.0f, 1.0f),
-		glm::vec3(5.0f,  0.0f, 1.0f),
-		glm::vec3(6.0f,  0.0f, 1.0f),
-		glm::vec3(7.0f,  0.0f, 1.0f),
-		glm::vec3(-1.0f,  0.0f, 1.0f),
-		glm::vec3(-2.0f,  0.0f, 1.0f),
-		glm::vec3(-3.0f,  0.0f, 1.0f),
-		glm::vec3(-4.0f,  0.0f, 1.0f),
-		glm::vec3(-5.0f,  0.0f, 1.0f),
-		glm::vec3(-6.0f,  0.0f, 1.0f),
-		glm::vec3(-7.0f,  0.0f, 1.0f),
-		glm::vec3(-8.0f,  0.0f, 1.0f),
-		glm::vec3(0.0f,  0.0f, 2.0f),
-		glm::vec3(1.0f,  0.0f, 2.0f),
-		glm::vec3(2.0f,  0.0f, 2.0f),
-		glm::vec3(3.0f,  0.0f, 2.0f),
-		glm::vec3(4.0f,  0.0f, 2.0f),
-		glm::vec3(5.0f,  0.0f, 2.0f),
-		glm::vec3(6.0f,  0.0f, 2.0f),
-		glm::vec3(7.0f,  0.0f, 2.0f),
-		glm::vec3(-1.0f,  0.0f, 2.0f),
-		glm::vec3(-2.0f,  0.0f, 2.0f),
-		glm::vec3(-3.0f,  0.0f, 2.0f),
-		glm::vec3(-4.0f,  0.0f, 2.0f),
-		glm::vec3(-5.0f,  0.0f, 2.0f),
-		glm::vec3(-6.0f,  0.0f, 2.0f),
-		glm::vec3(-7.0f,  0.0f, 2.0f),
-		glm::vec3(-8.0f,  0.0f, 2.0f),
-		glm::vec3(0.0f,  0.0f, 3.0f),
-		glm::vec3(1.0f,  0.0f, 3.0f),
-		glm::vec3(2.0f,  0.0f, 3.0f),
-		glm::vec3(3.0f,  0.0f, 3.0f),
-		glm::vec3(4.0f,  0.0f, 3.0f),
-		glm::vec3(5.0f,  0.0f, 3.0f),
-		glm::vec3(6.0f,  0.0f, 3.0f),
-		glm::vec3(7.0f,  0.0f, 3.0f),
-		glm::vec3(-1.0f,  0.0f, 3.0f),
-		glm::vec3(-2.0f,  0.0f, 3.0f),
-		glm::vec3(-3.0f,  0.0f, 3.0f),
-		glm::vec3(-4.0f,  0.0f, 3.0f),
-		glm::vec3(-5.0f,  0.0f, 3.0f),
-		glm::vec3(-6.0f,  0.0f, 3.0f),
-		glm::vec3(-7.0f,  0.0f, 3.0f),
-		glm::vec3(-8.0f,  0.0f, 3.0f),
-		glm::vec3(0.0f,  0.0f, 4.0f),
-		glm::vec3(1.0f,  0.0f, 4.0f),
-		glm::vec3(2.0f,  0.0f, 4.0f),
-		glm::vec3(3.0f,  0.0f, 4.0f),
-		glm::vec3(4.0f,  0.0f, 4.0f),
-		glm::vec3(5.0f,  0.0f, 4.0f),
-		glm::vec3(6.0f,  0.0f, 4.0f),
-		glm::vec3(7.0f,  0.0f, 4.0f),
-		glm::vec3(-1.0f,  0.0f, 4.0f),
-		glm::vec3(-2.0f,  0.0f, 4.0f),
-		glm::vec3(-3.0f,  0.0f, 4.0f),
-		glm::vec3(-4.0f,  0.0f, 4.0f),
-		glm::vec3(-5.0f,  0.0f, 4.0f),
-		glm::vec3(-6.0f,  0.0f, 4.0f),
-		glm::vec3(-7.0f,  0.0f, 4.0f),
-		glm::vec3(-8.0f,  0.0f, 4.0f),
-		glm::vec3(0.0f,  0.0f, 5.0f),
-		glm::vec3(1.0f,  0.0f, 5.0f),
-		glm::vec3(2.0f,  0.0f, 5.0f),
-		glm::vec3(3.0f,  0.0f, 5.0f),
-		glm::vec3(4.0f,  0.0f, 5.0f),
-		glm::vec3(5.0f,  0.0f, 5.0f),
-		glm::vec3(6.0f,  0.0f, 5.0f),
-		glm::vec3(7.0f,  0.0f, 5.0f),
-		glm::vec3(-1.0f,  0.0f, 5.0f),
-		glm::vec3(-2.0f,  0.0f, 5.0f),
-		glm::vec3(-3.0f,  0.0f, 5.0f),
-		glm::vec3(-4.0f,  0.0f, 5.0f),
-		glm::vec3(-5.0f,  0.0f, 5.0f),
-		glm::vec3(-6.0f,  0.0f, 5.0f),
-		glm::vec3(-7.0f,  0.0f, 5.0f),
-		glm::vec3(-8.0f,  0.0f, 5.0f),
-		glm::vec3(0.0f,  0.0f, 6.0f),
-		glm::vec3(1.0f,  0.0f, 6.0f),
-		glm::vec3(2.0f,  0.0f, 6.0f),
-		glm::vec3(3.0f,  0.0f, 6.0f),
-		glm::vec3(4.0f,  0.0f, 6.0f),
-		glm::vec3(5.0f,  0.0f, 6.0f),
-		glm::vec3(6.0f,  0.0f, 6.0f),
-		glm::vec3(7.0f,  0.0f, 6.0f),
-		glm::vec3(-1.0f,  0.0f, 6.0f),
-		glm::vec3(-2.0f,  0.0f, 6.0f),
-		glm::vec3(-3.0f,  0.0f, 6.0f),
-		glm::vec3(-4.0f,  0.0f, 6.0f),
-		glm::vec3(-5.0f,  0.0f, 6.0f),
-		glm::vec3(-6.0f,  0.0f, 6.0f),
-		glm::vec3(-7.0f,  0.0f, 6.0f),
-		glm::vec3(-8.0f,  0.0f, 6.0f),
-		glm::vec3(0.0f, 0.0f, 7.0f),
-		glm::vec3(1.0f, 0.0f, 7.0f),
-		glm::vec3(2.0f, 0.0f, 7.0f),
-		glm::vec3(3.0f, 0.0f, 7.0f),
-		glm::vec3(4.0f, 0.0f, 7.0f),
-		glm::vec3(5.0f, 0.0f, 7.0f),
-		glm::vec3(6.0f, 0.0f, 7.0f),
-		glm::vec3(7.0f, 0.0f, 7.0f),
-		glm::vec3(-1.0f, 0.0f, 7.0f),
-		glm::vec3(-2.0f, 0.0f, 7.0f),
-		glm::vec3(-3.0f, 0.0f, 7.0f),
-		glm::vec3(-4.0f, 0.0f, 7.0f),
-		glm::vec3(-5.0f, 0.0f, 7.0f),
-		glm::vec3(-6.0f, 0.0f, 7.0f),
-		glm::vec3(-7.0f, 0.0f, 7.0f),
-		glm::vec3(-8.0f, 0.0f, 7.0f),
-		glm::vec3(0.0f, 0.0f, -1.0f),
-		glm::vec3(1.0f, 0.0f, -1.0f),
-		glm::vec3(2.0f, 0.0f, -1.0f),
-		glm::vec3(3.0f, 0.0f, -1.0f),
-		glm::vec3(4.0f, 0.0f, -1.0f),
-		glm::vec3(5.0f, 0.0f, -1.0f),
-		glm::vec3(6.0f, 0.0f, -1.0f),
-		glm::vec3(7.0f, 0.0f, -1.0f),
-		glm::vec3(-1.0f, 0.0f, -1.0f),
-		glm::vec3(-2.0f, 0.0f, -1.0f),
-		glm::vec3(-3.0f, 0.0f, -1.0f),
-		glm::vec3(-4.0f, 0.0f, -1.0f),
-		glm::vec3(-5.0f, 0.0f, -1.0f),
-		glm::vec3(-6.0f, 0.0f, -1.0f),
-		glm::vec3(-7.0f, 0.0f, -1.0f),
-		glm::vec3(-8.0f, 0.0f, -1.0f),
-		glm::vec3(0.0f, 0.0f, -2.0f),
-		glm::vec3(1.0f, 0.0f, -2.0f),
-		glm::vec3(2.0f, 0.0f, -2.0f),
-		glm::vec3(3.0f, 0.0f, -2.0f),
-		glm::vec3(4.0f, 0.0f, -2.0f),
-		glm::vec3(5.0f, 0.0f, -2.0f),
-		glm::vec3(6.0f, 0.0f, -2.0f),
-		glm::vec3(7.0f, 0.0f, -2.0f),
-		glm::vec3(-1.0f, 0.0f, -2.0f),
-		glm::vec3(-2.0f, 0.0f, -2.0f),
-		glm::vec3(-3.0f, 0.0f, -2.0f),
-		glm::vec3(-4.0f, 0.0f, -2.0f),
-		glm::vec3(-5.0f, 0.0f, -2.0f),
-		glm::vec3(-6.0f, 0.0f, -2.0f),
-		glm::vec3(-7.0f, 0.0f, -2.0f),
-		glm::vec3(-8.0f, 0.0f, -2.0f),
-		glm::vec3(0.0f, 0.0f, -3.0f),
-		glm::vec3(1.0f, 0.0f, -3.0f),
-		glm::vec3(2.0f, 0.0f, -3.0f),
-		glm::vec3(3.0f, 0.0f, -3.0f),
-		glm::vec3(4.0f, 0.0f, -3.0f),
-		glm::vec3(5.0f, 0.0f, -3.0f),
-		glm::vec3(6.0f, 0.0f, -3.0f),
-		glm::vec3(7.0f, 0.0f, -3.0f),
-		glm::vec3(-1.0f, 0.0f, -3.0f),
-		glm::vec3(-2.0f, 0.0f, -3.0f),
-		glm::vec3(-3.0f, 0.0f, -3.0f),
-		glm::vec3(-4.0f, 0.0f, -3.0f),
-		glm::vec3(-5.0f, 0.0f, -3.0f),
-		glm::vec3(-6.0f, 0.0f, -3.0f),
-		glm::vec3(-7.0f, 0.0f, -3.0f),
-		glm::vec3(-8.0f, 0.0f, -3.0f),
-		glm::vec3(0.0f, 0.0f, -4.0f),
-		glm::vec3(1.0f, 0.0f, -4.0f),
-		glm::vec3(2.0f, 0.0f, -4.0f),
-		glm::vec3(3.0f, 0.0f, -4.0f),
-		glm::vec3(4.0f, 0.0f, -4.0f),
-		glm::vec3(5.0f, 0.0f, -4.0f),
-		glm::vec3(6.0f, 0.0f, -4.0f),
-		glm::vec3(7.0f, 0.0f, -4.0f),
-		glm::vec3(-1.0f, 0.0f, -4.0f),
-		glm::vec3(-2.0f, 0.0f, -4.0f),
-		glm::vec3(-3.0f, 0.0f, -4.0f),
-		glm::vec3(-4.0f, 0.0f, -4.0f),
-		glm::vec3(-5.0f, 0.0f, -4.0f),
-		glm::vec3(-6.0f, 0.0f, -4.0f),
-		glm::vec3(-7.0f, 0.0f, -4.0f),
-		glm::vec3(-8.0f, 0.0f, -4.0f),
-		glm::vec3(0.0f, 0.0f, -5.0f),
-		glm::vec3(1.0f, 0.0f, -5.0f),
-		glm::vec3(2.0f, 0.0f, -5.0f),
-		glm::vec3(3.0f, 0.0f, -5.0f),
-		glm::vec3(4.0f, 0.0f, -5.0f),
-		glm::vec3(5.0f, 0.0f, -5.0f),
-		glm::vec3(6.0f, 0.0f, -5.0f),
-		glm::vec3(7.0f, 0.0f, -5.0f),
-		glm::vec3(-1.0f, 0.0f, -5.0f),
-		glm::vec3(-2.0f, 0.0f, -5.0f),
-		glm::vec3(-3.0f, 0.0f, -5.0f),
-		glm::vec3(-4.0f, 0.0f, -5.0f),
-		glm::vec3(-5.0f, 0.0f, -5.0f),
-		glm::vec3(-6.0f, 0.0f, -5.0f),
-		glm::vec3(-7.0f, 0.0f, -5.0f),
-		glm::vec3(-8.0f, 0.0f, -5.0f),
-		glm::vec3(0.0f, 0.0f, -6.0f),
-		glm::vec3(1.0f, 0.0f, -6.0f),
-		glm::vec3(2.0f, 0.0f, -6.0f),
-		glm::vec3(3.0f, 0.0f, -6.0f),
-		glm::vec3(4.0f, 0.0f, -6.0f),
-		glm::vec3(5.0f, 0.0f, -6.0f),
-		glm::vec3(6.0f, 0.0f, -6.0f),
-		glm::vec3(7.0f, 0.0f, -6.0f),
-		glm::vec3(-1.0f, 0.0f, -6.0f),
-		glm::vec3(-2.0f, 0.0f, -6.0f),
-		glm::vec3(-3.0f, 0.0f, -6.0f),
-		glm::vec3(-4.0f, 0.0f, -6.0f),
-		glm::vec3(-5.0f, 0.0f, -6.0f),
-		glm::vec3(-6.0f, 0.0f, -6.0f),
-		glm::vec3(-7.0f, 0.0f, -6.0f),
-		glm::vec3(-8.0f, 0.0f, -6.0f),
-		glm::vec3(0.0f, 0.0f, -7.0f),
-		glm::vec3(1.0f, 0.0f, -7.0f),
-		glm::vec3(2.0f, 0.0f, -7.0f),
-		glm::vec3(3.0f, 0.0f, -7.0f),
-		glm::vec3(4.0f, 0.0f, -7.0f),
-		glm::vec3(5.0f, 0.0f, -7.0f),
-		glm::vec3(6.0f, 0.0f, -7.0f),
-		glm::vec3(7.0f, 0.0f, -7.0f),
-		glm::vec3(-1.0f, 0.0f, -7.0f),
-		glm::vec3(-2.0f, 0.0f, -7.0f),
-		glm::vec3(-3.0f, 0.0f, -7.0f),
-		glm::vec3(-4.0f, 0.0f, -7.0f),
-		glm::vec3(-5.0f, 0.0f, -7.0f),
-		glm::vec3(-6.0f, 0.0f, -7.0f),
-		glm::vec3(-7.0f, 0.0f, -7.0f),
-		glm::vec3(-8.0f, 0.0f, -7.0f),
-		glm::vec3(0.0f, 0.0f, -8.0f),
-		glm::vec3(1.0f, 0.0f, -8.0f),
-		glm::vec3(2.0f, 0.0f, -8.0f),
-		glm::vec3(3.0f, 0.0f, -8.0f),
-		glm::vec3(4.0f, 0.0f, -8.0f),
-		glm::vec3(5.0f, 0.0f, -8.0f),
-		glm::vec3(6.0f, 0.0f, -8.0f),
-		glm::vec3(7.0f, 0.0f, -8.0f),
-		glm::vec3(-1.0f, 0.0f, -8.0f),
-		glm::vec3(-2.0f, 0.0f, -8.0f),
-		glm::vec3(-3.0f, 0.0f, -8.0f),
-		glm::vec3(-4.0f, 0.0f, -8.0f),
-		glm::vec3(-5.0f, 0.0f, -8.0f),
-		glm::vec3(-6.0f, 0.0f, -8.0f),
-		glm::vec3(-7.0f, 0.0f, -8.0f),
-		glm::vec3(-8.0f, 0.0f, -8.0f),
-	};
-
-	glm::vec3 lavaCubePositions[]
-	{
-		glm::vec3(0.0f, 0.0f, -9.0f),
-		glm::vec3(1.0f, 0.0f, -9.0f),
-		glm::vec3(2.0f, 0.0f, -9.0f),
-		glm::vec3(3.0f, 0.0f, -9.0f),
-		glm::vec3(4.0f, 0.0f, -9.0f),
-		glm::vec3(5.0f, 0.0f, -9.0f),
-		glm::vec3(6.0f, 0.0f, -9.0f),
-		glm::vec3(7.0f, 0.0f, -9.0f),
-		glm::vec3(-1.0f, 0.0f, -9.0f),
-		glm::vec3(-2.0f, 0.0f, -9.0f),
-		glm::vec3(-3.0f, 0.0f, -9.0f),
-		glm::vec3(-4.0f, 0.0f, -9.0f),
-		glm::vec3(-5.0f, 0.0f, -9.0f),
-		glm::vec3(-6.0f, 0.0f, -9.0f),
-		glm::vec3(-7.0f, 0.0f, -9.0f),
-		glm::vec3(-8.0f, 0.0f, -9.0f),
-	};
-
-	glm::vec3 snowManPositions[] {
-		glm::vec3(-3.0f, 1.0f, -6.0f),
-		glm::vec3(-3.0f, 2.0f, -6.0f),
-		glm::vec3(-3.0f, 3.0f, -6.0f),
-	};
-
-	glm::vec3 ironGolemPositions[]{
-		glm::vec3(1.0f,  1.0f, 5.0f),
-		glm::vec3(1.0f,  2.0f, 5.0f),
-		glm::vec3(2.0f,  2.0f, 5.0f),
-		glm::vec3(0.0f,  2.0f, 5.0f),
-		glm::vec3(1.0f,  3.0f, 5.0f),
-	};
-
-	glm::vec3 pointLightPositions[] = {
-		glm::vec3(0.7f,  2.2f,  2.0f),
-		glm::vec3(2.3f, 3.3f, -4.0f),
-		glm::vec3(-4.0f,  2.0f, 9.0f),
-		glm::vec3(0.0f,  3.0f, -3.0f)
-	};
-
-	float skyboxVertices[] =
-	{
-		-1.0f, -1.0f,  1.0f,
-		 1.0f, -1.0f,  1.0f,
-		 1.0f, -1.0f, -1.0f,
-		-1.0f, -1.0f, -1.0f,
-		-1.0f,  1.0f,  1.0f,
-		 1.0f,  1.0f,  1.0f,
-		 1.0f,  1.0f, -1.0f,
-		-1.0f,  1.0f, -1.0f
-	};
-
-	unsigned int skyboxIndices[] =
-	{
-		1, 2, 6,
-		6, 5, 1,
-		0, 4, 7,
-		7, 3, 0,
-		4, 5, 6,
-		6, 7, 4,
-		0, 3, 2,
-		2, 1, 0,
-		0, 1, 5,
-		5, 4, 0,
-		3, 7, 6,
-		6, 2, 3
-	};
-
-	std::string facesCubemap[6]
-	{
-		"resource/texture/skybox/right.jpg",
-		"resource/texture/skybox/left.jpg",
-		"resource/texture/skybox/top.jpg",
-		"resource/texture/skybox/bottom.jpg",
-		"resource/texture/skybox/front.jpg",
-		"resource/texture/skybox/back.jpg"
-	};
-
-	// cube
-	unsigned int cubeVAO{};
-	unsigned int cubeVBO{};
-	glGenVertexArrays(1, &cubeVAO);
-	glGenBuffers(1, &cubeVBO);
-
-	glBindVertexArray(cubeVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-	// skybox
-	unsigned int skyboxVAO{}, skyboxVBO{}, skyboxEBO{};
-	glGenVertexArrays(1, &skyboxVAO);
-	glGenBuffers(1, &skyboxVBO);
-	glGenBuffers(1, &skyboxEBO);
-
-	glBindVertexArray(skyboxVAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
+	// Set by the frame loop when a steady state frame allocates, the exit code reports it
+	bool allocationCheckFailed{ false };
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, skyboxEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(skyboxIndices), &skyboxIndices, GL_STATIC_DRAW);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-	unsigned int lightCubeVAO{};
-	glGenVertexArrays(1, &lightCubeVAO);
-
-	glBindVertexArray(lightCubeVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-	
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-	unsigned cubemapTexture{};
-	glGenTextures(1, &cubemapTexture);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-	for (int i{ 0 }; i < 6; ++i)
-	{
-		int width{}, height{}, nrChannels{};
-		unsigned char* data = stbi_load(facesCubemap[i].c_str(), &width, &height, &nrChannels, 0);
-		if (data)
-		{
-			stbi_set_flip_vertically_on_load(false);
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-			stbi_image_free(data);
-		}
-		else
-		{
-			std::cout << "Failed to load texture: " << facesCubemap[i] << '\n';
-			stbi_image_free(data);
-		}
-	}
-
-	unsigned int diffuseMap{ loadTexture("resource/texture/grass.jpg") };
-	unsigned int specularMap{ loadTexture("resource/texture/grass_specular.jpg") };
-	unsigned int lavaDiffuseMap{ loadTexture("resource/texture/lava.jpg") };
-	unsigned int lavaSpecularMap{ loadTexture("resource/texture/lava_specular.jpg") };
-	unsigned int snowDiffuseMap{ loadTexture("resource/texture/snow.jpg") };
-	unsigned int snowSpecularMap{ loadTexture("resource/texture/snow_specular.jpg") };
-	unsigned int pumpkinDiffuseMap{ loadTexture("resource/texture/pumpkin.jpg") };
-	unsigned int pumpkinSpecularMap{ loadTexture("resource/texture/pumpkin_specular.jpg") };
-	unsigned int ironDiffuseMap{ loadTexture("resource/texture/iron.jpg") };
-	unsigned int ironSpecularMap{ loadTexture("resource/texture/iron_specular.jpg") };
-
-	/*unsigned int grassDiffuse = loadTexture("resource/texture/grass.jpg");
-	unsigned int grassSpecular = loadTexture("resource/texture/grass_specular.jpg");
-
-	unsigned int blockDiffuse = loadTexture("resource/texture/grass_block.jpg");
-	unsigned int blockSpecular = loadTexture("resource/texture/grass_block_specular.jpg");
-
-	unsigned int dirtDiffuse = loadTexture("resource/texture/dirt.jpg");
-	unsigned int dirtSpecular = loadTexture("resource/texture/dirt_specular.jpg");*/
-
-	lightingShader.use();
-	lightingShader.setInt("material.diffuse", 0);
-	lightingShader.setInt("material.specular", 1);
-	skyboxShader.use();
-	skyboxShader.setInt("skybox", 0);
-
-	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-	while (!glfwWindowShouldClose(window))
+	// Everything owning GL objects lives in this scope, so it is destroyed while the context still exists
 	{
-		float currentFrame{ static_cast<float>(glfwGetTime()) };
-		deltaTime = currentFrame - lastFrame;
-		lastFrame = currentFrame;
-
-		processInput(window);
-
-		camera.updateJump(deltaTime);
-
-		glClearColor(0.2f, 0.2f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		lightingShader.use();
-		lightingShader.setVec3("viewPos", camera.getPosition());
-		lightingShader.setFloat("material.shininess", 32.0f);
-
-		// directional light
-		lightingShader.setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
-		lightingShader.setVec3("dirLight.ambient", 0.05f, 0.05f, 0.05f);
-		lightingShader.setVec3("dirLight.diffuse", 0.4f, 0.4f, 0.4f);
-		lightingShader.setVec3("dirLight.specular", 0.5f, 0.5f, 0.5f);
-		// point light 1
-		lightingShader.setVec3("pointLights[0].position", pointLightPositions[0]);
-		lightingShader.setVec3("pointLights[0].ambient", 0.05f, 0.05f, 0.05f);
-		lightingShader.setVec3("pointLights[0].diffuse", 0.8f, 0.8f, 0.8f);
-		lightingShader.setVec3("pointLights[0].specular", 1.0f, 1.0f, 1.0f);
-		lightingShader.setFloat("pointLights[0].constant", 1.0f);
-		lightingShader.setFloat("pointLights[0].linear", 0.09f);
-		lightingShader.setFloat("pointLights[0].quadratic", 0.032f);
-		// point light 2
-		lightingShader.setVec3("pointLights[1].position", pointLightPositions[1]);
-		lightingShader.setVec3("pointLights[1].ambient", 0.05f, 0.05f, 0.05f);
-		lightingShader.setVec3("pointLights[1].diffuse", 0.8f, 0.8f, 0.8f);
-		lightingShader.setVec3("pointLights[1].specular", 1.0f, 1.0f, 1.0f);
-		lightingShader.setFloat("pointLights[1].constant", 1.0f);
-		lightingShader.setFloat("pointLights[1].linear", 0.09f);
-		lightingShader.setFloat("pointLights[1].quadratic", 0.032f);
-		// point light 3
-		lightingShader.setVec3("pointLights[2].position", pointLightPositions[2]);
-		lightingShader.setVec3("pointLights[2].ambient", 0.05f, 0.05f, 0.05f);
-		lightingShader.setVec3("pointLights[2].diffuse", 0.8f, 0.8f, 0.8f);
-		lightingShader.setVec3("pointLights[2].specular", 1.0f, 1.0f, 1.0f);
-		lightingShader.setFloat("pointLights[2].constant", 1.0f);
-		lightingShader.setFloat("pointLights[2].linear", 0.09f);
-		lightingShader.setFloat("pointLights[2].quadratic", 0.032f);
-		// point light 4
-		lightingShader.setVec3("pointLights[3].position", pointLightPositions[3]);
-		lightingShader.setVec3("pointLights[3].ambient", 0.05f, 0.05f, 0.05f);
-		lightingShader.setVec3("pointLights[3].diffuse", 0.8f, 0.8f, 0.8f);
-		lightingShader.setVec3("pointLights[3].specular", 1.0f, 1.0f, 1.0f);
-		lightingShader.setFloat("pointLights[3].constant", 1.0f);
-		lightingShader.setFloat("pointLights[3].linear", 0.09f);
-		lightingShader.setFloat("pointLights[3].quadratic", 0.032f);
-		// spotLight
-		/*lightingShader.setVec3("spotLight.position", camera.getPosition());
-		lightingShader.setVec3("spotLight.direction", camera.getFront());
-		lightingShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-		lightingShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-		lightingShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
-		lightingShader.setFloat("spotLight.constant", 1.0f);
-		lightingShader.setFloat("spotLight.linear", 0.09f);
-		lightingShader.setFloat("spotLight.quadratic", 0.032f);
-		lightingShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-		lightingShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));*/
-
-		glm::mat4 projection{ glm::perspective(glm::radians(45.0f), static_cast<float>(SCREEN_WIDTH) / static_cast<float>(SCREEN_HEIGHT), 0.1f, 100.0f) };
-		lightingShader.setMat4("projection", projection);
-
-		glm::mat4 view{ camera.getViewMatrix() };
-		lightingShader.setMat4("view", view);
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, diffuseMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, specularMap);
-
-		glBindVertexArray(cubeVAO);
-		for (unsigned int i = 0; i < 256; i++)
+		// Shaders and textures come from one mapped archive, without it from the loose files
+		AssetLoader assets{ assetArchivePath, looseAssets };
+
+		// The scene renders offscreen at a resolution that keeps it within the GPU budget
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		DynamicResolution dynamicResolution{ gpuBudget };
+		FragmentCounter fragmentCounter{};
+		// Frames are read back a few frames late and saved on a thread of their own
+		std::unique_ptr<FrameCapture> frameCapture{};
+		if (capturePath)
+			frameCapture = std::make_unique<FrameCapture>(capturePath, captureEncoding);
+		double statsTime{ glfwGetTime() };
+		int statsFrames{ 0 };
+
+		StreamBuffer::loadExtensions((GLADloadproc)glfwGetProcAddress);
+		// Room for the instance matrices, lights and particle billboards of one frame
+		StreamBuffer streamBuffer{ 4 * 1024 * 1024 };
+
+		GpuCulling::loadExtensions((GLADloadproc)glfwGetProcAddress);
+		std::unique_ptr<GpuCulling> gpuCulling{};
+		if (gpuCullingRequested && GpuCulling::isSupported())
+			gpuCulling = std::make_unique<GpuCulling>(assets);
+		else if (gpuCullingRequested)
+			std::cout << "ERROR::GPU_CULLING::NOT_SUPPORTED: GL 4.3 is required, culling on the CPU\n";
+		int uboAlignment{};
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+
+		// Images decode on the workers, so the job system comes before the textures
+		JobSystem jobSystem{};
+		// Textures start with only their smallest mips resident and stream in as they come into view
+		TextureManager textures{ jobSystem, assets, textureBudget * 1024 * 1024 };
+		// Shaders, textures and meshes are shared by path, loaded on first use and freed once unused
+		ResourceManager resources{ assets, textures };
+
+		// Every shader draws in the first frame, so they are resolved right away
+		ShaderResource lightingShaderResource{ resources.shader("source/shader/lighting.vs", "source/shader/lighting.fs") };
+		ShaderResource skyboxShaderResource{ resources.shader("source/shader/skybox.vs", "source/shader/skybox.fs") };
+		ShaderResource chunkShaderResource{ resources.shader("source/shader/chunk.vs", "source/shader/chunk.fs") };
+		ShaderResource lightCubeShaderResource{ resources.shader("source/shader/light_cube.vs", "source/shader/light_cube.fs") };
+		Shader& lightingShader{ resources.get(lightingShaderResource) };
+		Shader& skyboxShader{ resources.get(skyboxShaderResource) };
+		Shader& chunkShader{ resources.get(chunkShaderResource) };
+		Shader& lightCubeShader{ resources.get(lightCubeShaderResource) };
+
+		// The same vertex shaders without their lighting, for the depth pre-pass and the overdraw view
+		ShaderResource chunkDepthShaderResource{ resources.shader("source/shader/chunk.vs", "source/shader/depth_only.fs") };
+		ShaderResource lightingDepthShaderResource{ resources.shader("source/shader/lighting.vs", "source/shader/depth_only.fs") };
+		ShaderResource lightCubeDepthShaderResource{ resources.shader("source/shader/light_cube.vs", "source/shader/depth_only.fs") };
+		ShaderResource chunkOverdrawShaderResource{ resources.shader("source/shader/chunk.vs", "source/shader/overdraw.fs") };
+		ShaderResource lightingOverdrawShaderResource{ resources.shader("source/shader/lighting.vs", "source/shader/overdraw.fs") };
+		ShaderResource lightCubeOverdrawShaderResource{ resources.shader("source/shader/light_cube.vs", "source/shader/overdraw.fs") };
+		Shader& chunkDepthShader{ resources.get(chunkDepthShaderResource) };
+		Shader& lightingDepthShader{ resources.get(lightingDepthShaderResource) };
+		Shader& lightCubeDepthShader{ resources.get(lightCubeDepthShaderResource) };
+		Shader& chunkOverdrawShader{ resources.get(chunkOverdrawShaderResource) };
+		Shader& lightingOverdrawShader{ resources.get(lightingOverdrawShaderResource) };
+		Shader& lightCubeOverdrawShader{ resources.get(lightCubeOverdrawShaderResource) };
+
+		float vertices[] = {
+			// positions          // normals           // texture coords
+			-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+			 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+			 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+			 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+			-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+			-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+			-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+			 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+			 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+			 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+			-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+			-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+			-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+			-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+			-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+			-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+			-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+			-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+			 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+			 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+			 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+			 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+			 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+			 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+			-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+			 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+			 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+			 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+			-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+			-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+			-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+			 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+			 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+			 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+			-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+			-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+		};
+
+		glm::vec3 snowManPositions[] {
+			glm::vec3(-3.0f, 1.0f, -6.0f),
+			glm::vec3(-3.0f, 2.0f, -6.0f),
+			glm::vec3(-3.0f, 3.0f, -6.0f),
+		};
+
+		glm::vec3 ironGolemPositions[]{
+			glm::vec3(1.0f,  1.0f, 5.0f),
+			glm::vec3(1.0f,  2.0f, 5.0f),
+			glm::vec3(2.0f,  2.0f, 5.0f),
+			glm::vec3(0.0f,  2.0f, 5.0f),
+			glm::vec3(1.0f,  3.0f, 5.0f),
+		};
+
+		glm::vec3 pointLightPositions[] = {
+			glm::vec3(0.7f,  2.2f,  2.0f),
+			glm::vec3(2.3f, 3.3f, -4.0f),
+			glm::vec3(-4.0f,  2.0f, 9.0f),
+			glm::vec3(0.0f,  3.0f, -3.0f)
+		};
+
+		float skyboxVertices[] =
 		{
-			glm::mat4 model{ glm::mat4(1.0f) };
-			model = glm::translate(model, cubePositions[i]);
-			lightingShader.setMat4("model", model);
-
-			glDrawArrays(GL_TRIANGLES, 0, 36);
-		}
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, lavaDiffuseMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, lavaSpecularMap);
-
-		for (unsigned int i = 0; i < 16; ++i)
+			-1.0f, -1.0f,  1.0f,
+			 1.0f, -1.0f,  1.0f,
+			 1.0f, -1.0f, -1.0f,
+			-1.0f, -1.0f, -1.0f,
+			-1.0f,  1.0f,  1.0f,
+			 1.0f,  1.0f,  1.0f,
+			 1.0f,  1.0f, -1.0f,
+			-1.0f,  1.0f, -1.0f
+		};
+
+		unsigned int skyboxIndices[] =
 		{
-			glm::mat4 model{ glm::mat4(1.0f) };
-			model = glm::translate(model, lavaCubePositions[i]);
-			lightingShader.setMat4("model", model);
-
-			glDrawArrays(GL_TRIANGLES, 0, 36);
-		}
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, snowDiffuseMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, snowSpecularMap);
-
-		for (unsigned int i = 0; i < 2; ++i)
+			1, 2, 6,
+			6, 5, 1,
+			0, 4, 7,
+			7, 3, 0,
+			4, 5, 6,
+			6, 7, 4,
+			0, 3, 2,
+			2, 1, 0,
+			0, 1, 5,
+			5, 4, 0,
+			3, 7, 6,
+			6, 2, 3
+		};
+
+		std::string facesCubemap[6]
 		{
-			glm::mat4 model{ glm::mat4(1.0f) };
-			model = glm::translate(model, snowManPositions[i]);
-			lightingShader.setMat4("model", model);
-
-			glDrawArrays(GL_TRIANGLES, 0, 36);
-		}
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, pumpkinDiffuseMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, pumpkinSpecularMap);
-
-		for (unsigned int i = 2; i < 3; ++i)
-		{
-			glm::mat4 model{ glm::mat4(1.0f) };
-			model = glm::translate(model, snowManPositions[i]);
-			lightingShader.setMat4("model", model);
-
-			glDrawArrays(GL_TRIANGLES, 0, 36);
-		}
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, ironDiffuseMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, ironSpecularMap);
+			"resource/texture/skybox/right.jpg",
+			"resource/texture/skybox/left.jpg",
+			"resource/texture/skybox/top.jpg",
+			"resource/texture/skybox/bottom.jpg",
+			"resource/texture/skybox/front.jpg",
+			"resource/texture/skybox/back.jpg"
+		};
+
+		// Meshes are built the first time something draws them
+		resources.defineMesh("cube", [&vertices]()
+			{
+				Mesh mesh{};
+				mesh.count = 36;
+				glGenVertexArrays(1, &mesh.vertexArray);
+				glGenBuffers(1, &mesh.vertexBuffer);
+
+				glBindVertexArray(mesh.vertexArray);
+				glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+				glEnableVertexAttribArray(0);
+
+				glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+				glEnableVertexAttribArray(1);
+
+				glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+				glEnableVertexAttribArray(2);
+
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				glBindVertexArray(0);
+				setupInstanceAttributes(mesh.vertexArray);
+				return mesh;
+			});
+
+		// The light cubes only read positions from the same vertices
+		resources.defineMesh("light_cube", [&vertices]()
+			{
+				Mesh mesh{};
+				mesh.count = 36;
+				glGenVertexArrays(1, &mesh.vertexArray);
+				glGenBuffers(1, &mesh.vertexBuffer);
+
+				glBindVertexArray(mesh.vertexArray);
+				glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+				glEnableVertexAttribArray(0);
+
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				glBindVertexArray(0);
+				setupInstanceAttributes(mesh.vertexArray);
+				return mesh;
+			});
+
+		resources.defineMesh("skybox", [&skyboxVertices, &skyboxIndices]()
+			{
+				Mesh mesh{};
+				mesh.count = 36;
+				glGenVertexArrays(1, &mesh.vertexArray);
+				glGenBuffers(1, &mesh.vertexBuffer);
+				glGenBuffers(1, &mesh.elementBuffer);
+
+				glBindVertexArray(mesh.vertexArray);
+
+				glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
+
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.elementBuffer);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(skyboxIndices), &skyboxIndices, GL_STATIC_DRAW);
+
+				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+				glEnableVertexAttribArray(0);
+
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				glBindVertexArray(0);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+				return mesh;
+			});
+		MeshResource cubeMesh{ resources.mesh("cube") };
+		MeshResource lightCubeMesh{ resources.mesh("light_cube") };
+		MeshResource skyboxMesh{ resources.mesh("skybox") };
+
+		unsigned cubemapTexture{};
+		glGenTextures(1, &cubemapTexture);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-		for (unsigned int i = 0; i < 4; ++i)
+		for (int i{ 0 }; i < 6; ++i)
 		{
-			glm::mat4 model{ glm::mat4(1.0f) };
-			model = glm::translate(model, ironGolemPositions[i]);
-			lightingShader.setMat4("model", model);
-
-			glDrawArrays(GL_TRIANGLES, 0, 36);
+			int width{}, height{}, nrChannels{};
+			Asset face{ assets.open(facesCubemap[i].c_str()) };
+			unsigned char* data = face.isValid() ? stbi_load_from_memory(face.data(), static_cast<int>(face.size()), &width, &height, &nrChannels, 0) : nullptr;
+			if (data)
+			{
+				stbi_set_flip_vertically_on_load(false);
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+				stbi_image_free(data);
+			}
+			else
+			{
+				std::cout << "Failed to load texture: " << facesCubemap[i] << '\n';
+				stbi_image_free(data);
+			}
 		}
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, pumpkinDiffuseMap);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, pumpkinSpecularMap);
+		// Decoded the first time a block of the type is drawn, textures of blocks never seen are never read
+		TextureResource diffuseMap{ resources.texture("resource/texture/grass.jpg") };
+		TextureResource specularMap{ resources.texture("resource/texture/grass_specular.jpg") };
+		TextureResource lavaDiffuseMap{ resources.texture("resource/texture/lava.jpg") };
+		TextureResource lavaSpecularMap{ resources.texture("resource/texture/lava_specular.jpg") };
+		TextureResource snowDiffuseMap{ resources.texture("resource/texture/snow.jpg") };
+		TextureResource snowSpecularMap{ resources.texture("resource/texture/snow_specular.jpg") };
+		TextureResource pumpkinDiffuseMap{ resources.texture("resource/texture/pumpkin.jpg") };
+		TextureResource pumpkinSpecularMap{ resources.texture("resource/texture/pumpkin_specular.jpg") };
+		TextureResource ironDiffuseMap{ resources.texture("resource/texture/iron.jpg") };
+		TextureResource ironSpecularMap{ resources.texture("resource/texture/iron_specular.jpg") };
+		TextureResource dirtDiffuseMap{ resources.texture("resource/texture/dirt.jpg") };
+		// There is no specular map for dirt, so it gets a black one
+		TextureResource dirtSpecularMap{ resources.solidTexture(0, 0, 0) };
+
+		// Indexed by BlockType, air has no material
+		Material materials[blockTypeCount]{};
+		materials[static_cast<int>(BlockType::grass)] = { diffuseMap, specularMap };
+		materials[static_cast<int>(BlockType::dirt)] = { dirtDiffuseMap, dirtSpecularMap };
+		materials[static_cast<int>(BlockType::snow)] = { snowDiffuseMap, snowSpecularMap };
+		materials[static_cast<int>(BlockType::lava)] = { lavaDiffuseMap, lavaSpecularMap };
+		materials[static_cast<int>(BlockType::pumpkin)] = { pumpkinDiffuseMap, pumpkinSpecularMap };
+		materials[static_cast<int>(BlockType::iron)] = { ironDiffuseMap, ironSpecularMap };
+
+		const std::vector<DrawBatch> drawBatches{
+			{ DrawPass::lit, static_cast<int>(BlockType::snow), snowManPositions, 2, 1.0f },
+			{ DrawPass::lit, static_cast<int>(BlockType::pumpkin), snowManPositions + 2, 1, 1.0f },
+			{ DrawPass::lit, static_cast<int>(BlockType::iron), ironGolemPositions, 4, 1.0f },
+			{ DrawPass::lit, static_cast<int>(BlockType::pumpkin), ironGolemPositions + 4, 1, 1.0f },
+			{ DrawPass::unlit, 0, pointLightPositions, 4, 0.2f },
+		};
+		DrawListBuilder drawListBuilder{ jobSystem };
+
+		// Edited chunks are saved here, everything else is regenerated from the seed
+		TerrainGenerator terrain{};
+		RegionStore regionStore{ "saves/world" };
+		ChunkManager chunkManager{ jobSystem, terrain, &regionStore };
+		// Past the full detail chunks the terrain continues in rings of 2, 4 and 8 block cells
+		TerrainLod terrainLod{ jobSystem, terrain, chunkManager.getViewRadius() };
+
+		// Ambient particles, embers rising from lava and snow falling over snowy ground
+		ParticleSystem particles{ 65536 };
+		ParticleEffect embers{};
+		embers.velocityMin = glm::vec3(-0.3f, 0.6f, -0.3f);
+		embers.velocityMax = glm::vec3(0.3f, 1.4f, 0.3f);
+		embers.spread = 0.45f;
+		embers.lifetimeMin = 1.5f;
+		embers.lifetimeMax = 3.0f;
+		embers.gravity = 0.8f;
+		embers.drag = 0.6f;
+		embers.size = 0.05f;
+		embers.fadeTime = 1.0f;
+		std::uint8_t emberColor[4]{ 255, 150, 50, 255 };
+		std::copy(std::begin(emberColor), std::end(emberColor), embers.color);
+
+		ParticleEffect snowfall{};
+		snowfall.velocityMin = glm::vec3(-0.2f, -0.9f, -0.2f);
+		snowfall.velocityMax = glm::vec3(0.2f, -0.6f, 0.2f);
+		snowfall.spread = 0.5f;
+		snowfall.lifetimeMin = 11.0f;
+		snowfall.lifetimeMax = 14.0f;
+		// Settles at gravity / drag = 0.8 blocks per second, reaching the ground as it dies
+		snowfall.gravity = -1.2f;
+		snowfall.drag = 1.5f;
+		snowfall.size = 0.05f;
+		snowfall.fadeTime = 1.0f;
+		std::uint8_t snowColor[4]{ 245, 248, 255, 230 };
+		std::copy(std::begin(snowColor), std::end(snowColor), snowfall.color);
+
+		ParticleEmitters emitters{};
+		emitters.add(BlockEmitter{ BlockType::lava, particles.addEffect(embers), 0.5f, 0.0f });
+		emitters.add(BlockEmitter{ BlockType::snow, particles.addEffect(snowfall), 0.3f, 10.0f });
+		ParticleRenderer particleRenderer{ assets };
+		auto surfaceBlock{ [&chunkManager](int x, int z, int& height)
+			{
+				height = chunkManager.getSurfaceHeight(static_cast<float>(x), static_cast<float>(z));
+				return chunkManager.getBlock(x, height, z);
+			} };
+		// Simulated seconds, which unlike the clock follow a replayed recording
+		float worldTime{ 0.0f };
+
+		/*unsigned int grassDiffuse = loadTexture("resource/texture/grass.jpg");
+		unsigned int grassSpecular = loadTexture("resource/texture/grass_specular.jpg");
+
+		unsigned int blockDiffuse = loadTexture("resource/texture/grass_block.jpg");
+		unsigned int blockSpecular = loadTexture("resource/texture/grass_block_specular.jpg");
+
+		unsigned int dirtDiffuse = loadTexture("resource/texture/dirt.jpg");
+		unsigned int dirtSpecular = loadTexture("resource/texture/dirt_specular.jpg");*/
 
-		for (unsigned int i = 4; i < 5; ++i)
+		lightingShader.use();
+		lightingShader.setInt("material.diffuse", 0);
+		lightingShader.setInt("material.specular", 1);
+		glUniformBlockBinding(lightingShader.shaderProgram, glGetUniformBlockIndex(lightingShader.shaderProgram, "PointLightBlock"), 0);
+		skyboxShader.use();
+		skyboxShader.setInt("skybox", 0);
+		// Chunks carry their light in the mesh, these only colour it
+		chunkShader.use();
+		chunkShader.setInt("diffuse", 0);
+		chunkShader.setVec3("skyColor", 0.9f, 0.9f, 0.85f);
+		chunkShader.setVec3("blockColor", 1.0f, 0.6f, 0.3f);
+		chunkShader.setVec3("ambient", 0.04f, 0.04f, 0.05f);
+		// Eight layers saturate red, more turn the heat towards yellow
+		for (Shader* overdrawShader : { &chunkOverdrawShader, &lightingOverdrawShader, &lightCubeOverdrawShader })
 		{
-			glm::mat4 model{ glm::mat4(1.0f) };
-			model = glm::translate(model, ironGolemPositions[i]);
-			lightingShader.setMat4("model", model);
-
-			glDrawArrays(GL_TRIANGLES, 0, 36);
+			overdrawShader->use();
+			overdrawShader->setVec3("layerColor", 0.125f, 0.03125f, 0.015625f);
 		}
 
-		glDepthFunc(GL_LEQUAL);
+		//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-		skyboxShader.use();
-		skyboxShader.setMat4("projection", projection);
-		view = glm::mat4(glm::mat3(camera.getViewMatrix()));
-		skyboxShader.setMat4("view", view);
-
-		glBindVertexArray(skyboxVAO);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+		// Transient data of one frame, everything in it is released at the start of the next
+		LinearArena frameArena{ 256 * 1024 };
 
-		// Restore openGl state
-		glDepthFunc(GL_LESS);
+		// Frames before this are warm up, containers are still growing to their working size
+		constexpr int allocationWarmupFrames{ 120 };
+		int frameIndex{ 0 };
+		std::uint64_t frameAllocations{ 0 };
 
-		lightCubeShader.use();
-		lightCubeShader.setMat4("projection", projection);
-		view = camera.getViewMatrix();
-		lightCubeShader.setMat4("view", view);
-
-		glBindVertexArray(lightCubeVAO);
-		for (int i{ 0 }; i < 4; ++i)
+		while (!glfwWindowShouldClose(window))
 		{
-			glm::mat4 model = glm::mat4(1.0f);
-			model = glm::translate(model, pointLightPositions[i]);
-			model = glm::scale(model, glm::vec3(0.2f));
-			lightCubeShader.setMat4("model", model);
-			glDrawArrays(GL_TRIANGLES, 0, 36);
+			AllocationScope allocationScope{};
+			bool streamingAtStart{ chunkManager.isStreaming() || terrainLod.isStreaming() || textures.isDecoding() };
+			std::uint64_t loadsAtStart{ resources.getLoadCount() };
+			frameArena.reset();
+
+			float currentFrame{ static_cast<float>(glfwGetTime()) };
+			deltaTime = input.beginFrame(currentFrame - lastFrame);
+			lastFrame = currentFrame;
+
+			processInput(window);
+			if (input.wasKeyPressed(GLFW_KEY_F1))
+				depthPrepass = !depthPrepass;
+			if (input.wasKeyPressed(GLFW_KEY_F2))
+				showOverdraw = !showOverdraw;
+
+			// Keep the chunks around the camera streaming in and stand on the terrain
+			chunkManager.update(camera.getPosition());
+			terrainLod.update(camera.getPosition());
+			chunkManager.setDrawCenter(terrainLod.getCenter());
+			glm::vec3 cameraPosition{ camera.getPosition() };
+			camera.setGroundHeight(static_cast<float>(chunkManager.getSurfaceHeight(cameraPosition.x, cameraPosition.z)) + 2.0f);
+
+			camera.updateJump(deltaTime);
+
+			// Transient per-frame data is written straight into the mapped stream buffer
+			streamBuffer.beginFrame();
+
+			StreamAllocation lightAllocation{ streamBuffer.allocate(sizeof(PointLightData) * 4, static_cast<std::size_t>(uboAlignment)) };
+			if (lightAllocation.data)
+			{
+				PointLightData* pointLights{ static_cast<PointLightData*>(lightAllocation.data) };
+				for (int i{ 0 }; i < 4; ++i)
+				{
+					PointLightData light{};
+					light.position = pointLightPositions[i];
+					light.constant = 1.0f;
+					light.linear = 0.09f;
+					light.quadratic = 0.032f;
+					light.ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+					light.diffuse = glm::vec3(0.8f, 0.8f, 0.8f);
+					light.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+					pointLights[i] = light;
+				}
+			}
+
+			// A minimized window reports a zero sized framebuffer
+			float aspect{ framebufferHeight > 0 ? static_cast<float>(framebufferWidth) / static_cast<float>(framebufferHeight) : 1.0f };
+			glm::mat4 projection{ glm::perspective(glm::radians(45.0f), aspect, 0.1f, terrainLod.getViewDistance() + Chunk::sizeY) };
+			glm::mat4 view{ camera.getViewMatrix() };
+
+			Frustum frustum{ Frustum::fromMatrix(projection * view) };
+
+			// Culling and command generation run on worker threads, this thread only submits.
+			// Without a pre-pass only a front to back order keeps hidden cubes from being lit
+			DrawOrder drawOrder{ depthPrepass ? DrawOrder::material : DrawOrder::frontToBack };
+			const DrawList& drawList{ drawListBuilder.build(drawBatches, frustum, cameraPosition, drawOrder, streamBuffer, frameArena) };
+
+			// Particles drift on a slowly turning wind and are written out as billboards on the workers
+			worldTime += deltaTime;
+			glm::vec3 wind{ 0.6f * std::sin(worldTime * 0.05f), 0.0f, 0.6f * std::cos(worldTime * 0.05f) };
+			emitters.emit(particles, cameraPosition, deltaTime, surfaceBlock);
+			particles.update(deltaTime, wind, jobSystem);
+			StreamAllocation particleAllocation{ streamBuffer.allocate(sizeof(ParticleInstance) * particles.getCount()) };
+			if (particleAllocation.data)
+				particles.writeInstances(static_cast<ParticleInstance*>(particleAllocation.data), jobSystem);
+
+			streamBuffer.flush();
+
+			dynamicResolution.resize(framebufferWidth, framebufferHeight);
+			dynamicResolution.beginFrame();
+
+			// The overdraw view adds up on black
+			if (showOverdraw)
+				glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			else
+				glClearColor(0.2f, 0.2f, 0.3f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			// Tested against the depth of the previous frame, so it runs before anything is drawn
+			if (gpuCulling)
+				chunkManager.cull(*gpuCulling, projection * view);
+
+			lightingShader.use();
+			lightingShader.setVec3("viewPos", camera.getPosition());
+			lightingShader.setFloat("material.shininess", 32.0f);
+
+			// directional light
+			lightingShader.setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
+			lightingShader.setVec3("dirLight.ambient", 0.05f, 0.05f, 0.05f);
+			lightingShader.setVec3("dirLight.diffuse", 0.4f, 0.4f, 0.4f);
+			lightingShader.setVec3("dirLight.specular", 0.5f, 0.5f, 0.5f);
+			// point lights
+			if (lightAllocation.data)
+				glBindBufferRange(GL_UNIFORM_BUFFER, 0, streamBuffer.buffer, lightAllocation.offset, lightAllocation.size);
+			// spotLight
+			/*lightingShader.setVec3("spotLight.position", camera.getPosition());
+			lightingShader.setVec3("spotLight.direction", camera.getFront());
+			lightingShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
+			lightingShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
+			lightingShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
+			lightingShader.setFloat("spotLight.constant", 1.0f);
+			lightingShader.setFloat("spotLight.linear", 0.09f);
+			lightingShader.setFloat("spotLight.quadratic", 0.032f);
+			lightingShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
+			lightingShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));*/
+
+			// The chunk shader has no specular term, only the diffuse map is bound
+			auto bindChunkMaterial{ [&](BlockType block)
+				{
+					textures.bind(resources.get(materials[static_cast<int>(block)].diffuse), 0);
+				} };
+			auto bindNoMaterial{ [](BlockType) {} };
+
+			// Draws chunks, distant terrain and cubes with the shaders of one scene pass
+			auto drawOpaque{ [&](ScenePass pass)
+				{
+					Shader& passChunkShader{ pass == ScenePass::depth ? chunkDepthShader : pass == ScenePass::overdraw ? chunkOverdrawShader : chunkShader };
+					Shader& passLightingShader{ pass == ScenePass::depth ? lightingDepthShader : pass == ScenePass::overdraw ? lightingOverdrawShader : lightingShader };
+					Shader& passLightCubeShader{ pass == ScenePass::depth ? lightCubeDepthShader : pass == ScenePass::overdraw ? lightCubeOverdrawShader : lightCubeShader };
+					for (Shader* passShader : { &passLightingShader, &passLightCubeShader, &passChunkShader })
+					{
+						passShader->use();
+						passShader->setMat4("projection", projection);
+						passShader->setMat4("view", view);
+					}
+
+					// Depth needs no materials, so every chunk goes in one call nearest first
+					if (gpuCulling && pass == ScenePass::shade)
+						chunkManager.drawCulled(*gpuCulling, bindChunkMaterial);
+					else if (gpuCulling)
+						chunkManager.drawCulled(*gpuCulling, bindNoMaterial);
+					else if (pass == ScenePass::depth)
+						chunkManager.drawDepth(frustum, cameraPosition);
+					else if (pass == ScenePass::shade)
+						chunkManager.draw(frustum, cameraPosition, bindChunkMaterial);
+					else
+						chunkManager.draw(frustum, cameraPosition, bindNoMaterial);
+
+					if (pass == ScenePass::depth)
+						terrainLod.drawDepth(frustum, cameraPosition);
+					else if (pass == ScenePass::shade)
+						terrainLod.draw(frustum, cameraPosition, bindChunkMaterial);
+					else
+						terrainLod.draw(frustum, cameraPosition, bindNoMaterial);
+
+					int boundMaterial{ -1 };
+					for (std::size_t i{ 0 }; i < drawList.commands.size(); ++i)
+					{
+						const DrawCommand& command{ drawList.commands[i] };
+						bool passChanged{ i == 0 || command.pass != drawList.commands[i - 1].pass };
+
+						if (command.pass == DrawPass::lit)
+						{
+							if (passChanged)
+								passLightingShader.use();
+
+							if (pass == ScenePass::shade && command.material != boundMaterial)
+							{
+								textures.bind(resources.get(materials[command.material].diffuse), 0);
+								textures.bind(resources.get(materials[command.material].specular), 1);
+								boundMaterial = command.material;
+							}
+
+							drawCubeInstances(resources.get(cubeMesh).vertexArray, streamBuffer.buffer, command.instanceOffset, command.instanceCount);
+						}
+						else
+						{
+							if (passChanged)
+								passLightCubeShader.use();
+
+							drawCubeInstances(resources.get(lightCubeMesh).vertexArray, streamBuffer.buffer, command.instanceOffset, command.instanceCount);
+						}
+					}
+				} };
+
+			// With the pre-pass every pixel's nearest depth is known before shading, so the
+			// shaded pass only runs the lighting for the fragment that ends up visible
+			if (depthPrepass)
+			{
+				glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+				drawOpaque(ScenePass::depth);
+				glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+				glDepthFunc(GL_EQUAL);
+				glDepthMask(GL_FALSE);
+			}
+
+			// Only the shaded pass is counted, that's where overdraw costs
+			fragmentCounter.begin(dynamicResolution.getRenderWidth() * dynamicResolution.getRenderHeight());
+			if (showOverdraw)
+			{
+				glEnable(GL_BLEND);
+				glBlendFunc(GL_ONE, GL_ONE);
+				drawOpaque(ScenePass::overdraw);
+				glDisable(GL_BLEND);
+			}
+			else
+			{
+				drawOpaque(ScenePass::shade);
+			}
+			fragmentCounter.end();
+
+			glDepthMask(GL_TRUE);
+
+			// The sky and particles would cover the heat of the overdraw view
+			if (!showOverdraw)
+			{
+				// The skybox goes last so it is only shaded where nothing else was drawn
+				glDepthFunc(GL_LEQUAL);
+
+				skyboxShader.use();
+				skyboxShader.setMat4("projection", projection);
+				skyboxShader.setMat4("view", glm::mat4(glm::mat3(view)));
+
+				const Mesh& skybox{ resources.get(skyboxMesh) };
+				glBindVertexArray(skybox.vertexArray);
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+				glDrawElements(GL_TRIANGLES, skybox.count, GL_UNSIGNED_INT, 0);
+				glBindVertexArray(0);
+			}
+
+			// Restore openGl state
+			glDepthFunc(GL_LESS);
+
+			// Blended over everything opaque and the sky, so they go last
+			if (!showOverdraw)
+				particleRenderer.draw(streamBuffer, particleAllocation, particles.getCount(), projection, view);
+
+			if (gpuCulling)
+				gpuCulling->buildDepthPyramid(dynamicResolution.getDepthTexture(), dynamicResolution.getRenderWidth(), dynamicResolution.getRenderHeight());
+
+			dynamicResolution.present();
+			if (frameCapture)
+				frameCapture->capture(framebufferWidth, framebufferHeight);
+			streamBuffer.endFrame();
+
+			// A unit block face at distance d covers about height / (2 d tan(fov / 2)) pixels.
+			// Chunks only sample the diffuse map, the lit batches both
+			float nearest[blockTypeCount]{};
+			float nearestLit[blockTypeCount]{};
+			chunkManager.getNearestDistances(frustum, cameraPosition, nearest);
+			std::fill(std::begin(nearestLit), std::end(nearestLit), 1.0e9f);
+			for (const DrawBatch& batch : drawBatches)
+			{
+				if (batch.pass != DrawPass::lit)
+					continue;
+				for (int i{ 0 }; i < batch.count; ++i)
+					nearestLit[batch.material] = std::min(nearestLit[batch.material], glm::length(batch.positions[i] - cameraPosition));
+			}
+
+			float pixelsAtUnitDistance{ static_cast<float>(dynamicResolution.getRenderHeight()) / (2.0f * std::tan(glm::radians(45.0f) * 0.5f)) };
+			for (int type{ 1 }; type < blockTypeCount; ++type)
+			{
+				float nearestDiffuse{ std::min(nearest[type], nearestLit[type]) };
+				if (nearestDiffuse <= 1.0e8f)
+					textures.request(resources.get(materials[type].diffuse), pixelsAtUnitDistance / std::max(nearestDiffuse, 1.0f));
+				if (nearestLit[type] <= 1.0e8f)
+					textures.request(resources.get(materials[type].specular), pixelsAtUnitDistance / std::max(nearestLit[type], 1.0f));
+			}
+			textures.update();
+			resources.collect();
+
+			// Frame stats in the title, refreshed twice a second
+			++statsFrames;
+			if (currentFrame - statsTime >= 0.5)
+			{
+				char title[224]{};
+				std::snprintf(title, sizeof(title), "Freakmon | %.0f fps | GPU %.2f ms | scale %.0f%% (%dx%d) | %.2f shaded/px%s | textures %.1f/%.0f MB | %d particles | %dk lod tris | %llu allocs",
+					statsFrames / (currentFrame - statsTime), dynamicResolution.getGpuTime(), dynamicResolution.getScale() * 100.0f,
+					dynamicResolution.getRenderWidth(), dynamicResolution.getRenderHeight(),
+					fragmentCounter.getFragmentsPerPixel(), depthPrepass ? " (pre-pass)" : "",
+					textures.getResidentBytes() / (1024.0 * 1024.0), textures.getBudget() / (1024.0 * 1024.0), particles.getCount(),
+					terrainLod.getTriangleCount() / 1000, static_cast<unsigned long long>(frameAllocations));
+				glfwSetWindowTitle(window, title);
+				statsTime = currentFrame;
+				statsFrames = 0;
+			}
+
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+
+			// Chunk streaming, image decoding and first loads allocate by design, every other frame must not once warmed up
+			frameAllocations = allocationScope.getCount();
+			bool steadyState{ ++frameIndex > allocationWarmupFrames && !streamingAtStart && !chunkManager.isStreaming() && !terrainLod.isStreaming()
+				&& !textures.isDecoding() && resources.getLoadCount() == loadsAtStart };
+			if (checkAllocations && steadyState && frameAllocations > 0)
+			{
+				std::cout << "ERROR::MEMORY::FRAME_ALLOCATED: frame " << frameIndex << " made " << frameAllocations
+					<< " allocations (" << allocationScope.getBytes() << " bytes)\n";
+				allocationCheckFailed = true;
+				glfwSetWindowShouldClose(window, true);
+			}
 		}
-
-		glfwSwapBuffers(window);
-		glfwPollEvents();
 	}
 
 	glfwTerminate();
-	return 0;
+	return allocationCheckFailed ? 1 : 0;
 }
 
 /*
-* Callback to resize the viewport when the window is resized
+* Callback to store the framebuffer size when the window is resized, the render
+* target and viewport follow it at the start of the next frame
 * Parameters:
 * - window: Pointer to the GLFW window
 * - width: New width of the window in pixels
@@ -765,34 +894,53 @@ int main()
 */
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-	glViewport(0, 0, width, height);
+	framebufferWidth = width;
+	framebufferHeight = height;
 }
 
 /*
-* Handles keyboard input to control camera movement and exit
+* Applies the input gathered for this frame to control camera movement and exit
 * Parameters:
 * - window: Pointer to the GLFW window
 * Returns: void
 */
 void processInput(GLFWwindow* window)
 {
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	if (input.isKeyDown(GLFW_KEY_ESCAPE))
 		glfwSetWindowShouldClose(window, true);
 
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+	for (const InputEvent& event : input.getFrameEvents())
+		camera.processMouseMovement(event.x, event.y);
+
+	if (input.isKeyDown(GLFW_KEY_W))
 		camera.processKeyboard(forward, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+	if (input.isKeyDown(GLFW_KEY_S))
 		camera.processKeyboard(backward, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+	if (input.isKeyDown(GLFW_KEY_D))
 		camera.processKeyboard(right, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+	if (input.isKeyDown(GLFW_KEY_A))
 		camera.processKeyboard(left, deltaTime);
-	if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+	if (input.isKeyDown(GLFW_KEY_SPACE))
 		camera.jump();
 }
 
 /*
-* Callback to process mouse movement and update camera orientation
+* Callback to queue key presses and releases for the next frame
+* Parameters:
+* - window: Pointer to the GLFW window
+* - key: Key code of the key
+* - scancode: Platform specific scancode of the key
+* - action: Press, release or repeat
+* - mods: Modifier key bits
+* Returns: void
+*/
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	input.onKey(glfwGetTime(), key, action);
+}
+
+/*
+* Callback to queue mouse movement for the next frame
 * Parameters:
 * - window: Pointer to the GLFW window
 * - xpos: New x-coordinate of the mouse cursor
@@ -801,63 +949,45 @@ void processInput(GLFWwindow* window)
 */
 void mouse_callback(GLFWwindow* window, double xPosIn, double yPosIn)
 {
-	float xpos = static_cast<float>(xPosIn);
-	float ypos = static_cast<float>(yPosIn);
+	input.onCursor(glfwGetTime(), xPosIn, yPosIn);
+}
 
-	if (firstMouse)
+/*
+* Enables the per-instance model matrix attributes of a vertex array
+* Parameters:
+* - vao: Vertex array whose shader reads the model matrix at locations 3-6
+* Returns: void
+*/
+void setupInstanceAttributes(unsigned int vao)
+{
+	glBindVertexArray(vao);
+	for (unsigned int i{ 0 }; i < 4; ++i)
 	{
-		lastX = xpos;
-		lastY = ypos;
-		firstMouse = false;
+		glEnableVertexAttribArray(3 + i);
+		glVertexAttribDivisor(3 + i, 1);
 	}
-
-	float xoffset = xpos - lastX;
-	float yoffset = lastY - ypos;
-	lastX = xpos;
-	lastY = ypos;
-
-	camera.processMouseMovement(xoffset, yoffset);
+	glBindVertexArray(0);
 }
 
 /*
-* Loads a 2D texture from a file using stb_image
+* Draws instanced cubes with model matrices read from a stream buffer allocation
 * Parameters:
-* - path: Char pointer to the path of the image file
-* Returns: OpenGL texture ID (unsigned int)
+* - vao: Vertex array set up with setupInstanceAttributes
+* - instanceBuffer: Buffer holding the allocation
+* - instanceOffset: Byte offset of the first model matrix in the buffer
+* - count: Number of instances
+* Returns: void
 */
-unsigned int loadTexture(const char* path)
+void drawCubeInstances(unsigned int vao, unsigned int instanceBuffer, std::intptr_t instanceOffset, int count)
 {
-	unsigned int texture{};
-	glGenTextures(1, &texture);
-
-	int width{}, height{}, nrChannels{};
-	unsigned char* data{ stbi_load(path, &width, &height, &nrChannels, 0) };
-	if (data)
-	{
-		stbi_set_flip_vertically_on_load(true);
-
-		GLenum format{};
-		if (nrChannels == 1)
-			format = GL_RED;
-		else if (nrChannels == 3)
-			format = GL_RGB;
-		else if (nrChannels == 4)
-			format = GL_RGBA;
-
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	}
-	else
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	for (unsigned int i{ 0 }; i < 4; ++i)
 	{
-		std::cout << "Texture failed to load at path: " << path << '\n';
+		const std::size_t columnOffset{ static_cast<std::size_t>(instanceOffset) + i * sizeof(glm::vec4) };
+		glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)columnOffset);
 	}
-	stbi_image_free(data);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	return texture;
-}
\ No newline at end of file
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 36, count);
+}
@@ -0,0 +1,194 @@
+/*
+* File: allocation_tracker.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program counts heap allocations made through operator new so
+			   the frame loop can verify that it doesn't allocate once warmed up.
+			   Define ALLOCATION_TRACKER_IMPLEMENTATION in exactly one source file
+			   to replace the global allocation operators
+*/
+
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace allocationTracker
+{
+	inline std::atomic<std::uint64_t> s_allocations{ 0 };
+	inline std::atomic<std::uint64_t> s_bytes{ 0 };
+
+	inline void record(std::size_t size)
+	{
+		s_allocations.fetch_add(1, std::memory_order_relaxed);
+		s_bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	// Allocations made by any thread since the program started
+	inline std::uint64_t getAllocationCount()
+	{
+		return s_allocations.load(std::memory_order_relaxed);
+	}
+
+	inline std::uint64_t getAllocatedBytes()
+	{
+		return s_bytes.load(std::memory_order_relaxed);
+	}
+}
+
+/*
+* Counts the allocations made between two points, typically one frame
+*/
+class AllocationScope
+{
+public:
+	AllocationScope()
+		: m_start{ allocationTracker::getAllocationCount() }
+		, m_startBytes{ allocationTracker::getAllocatedBytes() }
+	{
+	}
+
+	std::uint64_t getCount() const
+	{
+		return allocationTracker::getAllocationCount() - m_start;
+	}
+
+	std::uint64_t getBytes() const
+	{
+		return allocationTracker::getAllocatedBytes() - m_startBytes;
+	}
+
+private:
+	std::uint64_t m_start{};
+	std::uint64_t m_startBytes{};
+};
+
+#endif
+
+#ifdef ALLOCATION_TRACKER_IMPLEMENTATION
+#ifndef ALLOCATION_TRACKER_IMPLEMENTED
+#define ALLOCATION_TRACKER_IMPLEMENTED
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Kept out of line so the optimizer never pairs an inlined free() with a call to operator new
+#ifdef _MSC_VER
+#define ALLOCATION_TRACKER_NOINLINE __declspec(noinline)
+#else
+#define ALLOCATION_TRACKER_NOINLINE __attribute__((noinline))
+#endif
+
+namespace allocationTracker
+{
+	// Every tracked operator new ends here, so all of them pair with release()
+	ALLOCATION_TRACKER_NOINLINE void* allocate(std::size_t size, std::size_t alignment) noexcept
+	{
+		record(size);
+		if (size == 0)
+			size = 1;
+#ifdef _WIN32
+		return _aligned_malloc(size, alignment);
+#else
+		if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			return std::malloc(size);
+		void* memory{ nullptr };
+		if (posix_memalign(&memory, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) != 0)
+			return nullptr;
+		return memory;
+#endif
+	}
+
+	// Every tracked operator delete ends here
+	ALLOCATION_TRACKER_NOINLINE void release(void* memory) noexcept
+	{
+#ifdef _WIN32
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	if (void* memory{ allocationTracker::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__) })
+		return memory;
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return allocationTracker::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept
+{
+	allocationTracker::release(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	if (void* memory{ allocationTracker::allocate(size, static_cast<std::size_t>(alignment)) })
+		return memory;
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept
+{
+	operator delete(memory);
+}
+
+#endif
+#endif
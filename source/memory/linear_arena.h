@@ -0,0 +1,215 @@
+/*
+* File: linear_arena.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program defines a linear arena allocator for transient data. The
+			   frame owns one that is reset every frame and every thread has a
+			   scratch arena for temporaries inside a single function
+*/
+
+#ifndef LINEAR_ARENA_H
+#define LINEAR_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+class LinearArena
+{
+public:
+	/*
+	* Reserves the arena's memory up front, nothing is allocated after this
+	* Parameters:
+	* - capacity: Size of the arena in bytes
+	* Returns: LinearArena object
+	*/
+	explicit LinearArena(std::size_t capacity)
+		: m_memory{ std::make_unique<unsigned char[]>(capacity) }
+		, m_capacity{ capacity }
+	{
+	}
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	/*
+	* Carves an aligned block out of the arena
+	* Parameters:
+	* - size: Size of the block in bytes
+	* - alignment: Power of two alignment of the block
+	* Returns: Pointer to the block or nullptr if the arena is exhausted
+	*/
+	void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+	{
+		std::uintptr_t base{ reinterpret_cast<std::uintptr_t>(m_memory.get()) };
+		std::uintptr_t aligned{ (base + m_used + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1) };
+		std::size_t end{ static_cast<std::size_t>(aligned - base) + size };
+
+		if (end > m_capacity)
+		{
+			if (!m_reportedFull)
+				std::cout << "ERROR::ARENA::OUT_OF_MEMORY: " << size << " bytes requested, " << m_capacity - m_used << " left\n";
+			m_reportedFull = true;
+			return nullptr;
+		}
+
+		m_used = end;
+		if (m_used > m_highWater)
+			m_highWater = m_used;
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	// Default constructs an array of trivially destructible objects, they are never destroyed
+	template <typename T>
+	T* allocateArray(std::size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+
+		void* memory{ allocate(sizeof(T) * count, alignof(T)) };
+		if (!memory)
+			return nullptr;
+
+		T* objects{ static_cast<T*>(memory) };
+		for (std::size_t i{ 0 }; i < count; ++i)
+			new (objects + i) T{};
+		return objects;
+	}
+
+	// Releases everything allocated since the arena was created or last reset
+	void reset()
+	{
+		m_used = 0;
+		m_reportedFull = false;
+	}
+
+	std::size_t getUsed() const
+	{
+		return m_used;
+	}
+
+	// Largest amount ever in use, for sizing the capacity
+	std::size_t getHighWater() const
+	{
+		return m_highWater;
+	}
+
+	std::size_t getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	// Position to rewind to, everything allocated after it is released together
+	std::size_t getMarker() const
+	{
+		return m_used;
+	}
+
+	void rewind(std::size_t marker)
+	{
+		m_used = marker;
+	}
+
+private:
+	std::unique_ptr<unsigned char[]> m_memory{};
+	std::size_t m_capacity{};
+	std::size_t m_used{ 0 };
+	std::size_t m_highWater{ 0 };
+	bool m_reportedFull{ false };
+};
+
+/*
+* Rewinds an arena to where it was when the scope was entered
+*/
+class ArenaScope
+{
+public:
+	explicit ArenaScope(LinearArena& arena)
+		: m_arena{ arena }
+		, m_marker{ arena.getMarker() }
+	{
+	}
+
+	~ArenaScope()
+	{
+		m_arena.rewind(m_marker);
+	}
+
+	ArenaScope(const ArenaScope&) = delete;
+	ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+	LinearArena& m_arena;
+	std::size_t m_marker{};
+};
+
+/*
+* Allocator that lets standard containers use an arena. Deallocation is a no-op,
+* the memory comes back when the arena is reset or rewound
+*/
+template <typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(LinearArena& arena)
+		: m_arena{ &arena }
+	{
+	}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other)
+		: m_arena{ other.getArena() }
+	{
+	}
+
+	T* allocate(std::size_t count)
+	{
+		void* memory{ m_arena->allocate(sizeof(T) * count, alignof(T)) };
+		if (!memory)
+			throw std::bad_alloc{};
+		return static_cast<T*>(memory);
+	}
+
+	void deallocate(T*, std::size_t)
+	{
+	}
+
+	LinearArena* getArena() const
+	{
+		return m_arena;
+	}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const
+	{
+		return m_arena == other.getArena();
+	}
+
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const
+	{
+		return m_arena != other.getArena();
+	}
+
+private:
+	LinearArena* m_arena{};
+};
+
+/*
+* Scratch arena of the calling thread, created on its first use. Wrap uses in an
+* ArenaScope so temporaries are released when the function returns
+* Parameters: None
+* Returns: The thread's scratch arena
+*/
+inline LinearArena& scratchArena()
+{
+	static constexpr std::size_t scratchSize{ 256 * 1024 };
+	thread_local LinearArena arena{ scratchSize };
+	return arena;
+}
+
+#endif
@@ -0,0 +1,469 @@
+/*
+* File: broad_phase.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program finds the pairs of moving bodies whose bounding boxes
+			   overlap, the candidates a narrow phase then tests exactly. Bodies are
+			   binned in a uniform grid hashed by cell and only move between cells
+			   when their bounds cross a cell border. Cells are scanned for pairs in
+			   parallel on the job system
+*/
+
+#ifndef BROAD_PHASE_H
+#define BROAD_PHASE_H
+
+#include "../job/job_system.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Two bodies whose boxes overlap, a is always the lower id
+struct BodyPair
+{
+	int a{};
+	int b{};
+};
+
+class BroadPhase
+{
+public:
+	/*
+	* Creates an empty broad phase
+	* Parameters:
+	* - cellSize: Side of a grid cell, about twice the size of a typical body works best
+	* Returns: BroadPhase object
+	*/
+	explicit BroadPhase(float cellSize)
+		: m_inverseCellSize{ 1.0f / cellSize }
+	{
+		m_table.assign(initialTableSize, emptySlot);
+	}
+
+	BroadPhase(const BroadPhase&) = delete;
+	BroadPhase& operator=(const BroadPhase&) = delete;
+
+	/*
+	* Adds a body and bins it right away
+	* Parameters:
+	* - min: Minimum corner of its box
+	* - max: Maximum corner of its box
+	* Returns: Id of the body, reused once the body is removed
+	*/
+	int add(const glm::vec3& min, const glm::vec3& max)
+	{
+		int body{};
+		if (m_freeBodies.empty())
+		{
+			body = static_cast<int>(m_alive.size());
+			m_bounds.emplace_back();
+			m_cells.emplace_back();
+			m_alive.push_back(false);
+		}
+		else
+		{
+			body = m_freeBodies.back();
+			m_freeBodies.pop_back();
+		}
+
+		m_alive[body] = true;
+		++m_bodyCount;
+		setBounds(body, min, max);
+		m_cells[body] = cellRange(body);
+		insert(body, m_cells[body]);
+		return body;
+	}
+
+	/*
+	* Removes a body from the grid, its id may be handed out again by add
+	* Parameters:
+	* - body: Id of a live body
+	* Returns: void
+	*/
+	void remove(int body)
+	{
+		erase(body, m_cells[body]);
+		m_alive[body] = false;
+		m_freeBodies.push_back(body);
+		--m_bodyCount;
+	}
+
+	/*
+	* Moves a body. Only its bounds are written, the grid catches up in the next update,
+	* so this is safe to call for different bodies from several threads at once
+	* Parameters:
+	* - body: Id of a live body
+	* - min: Minimum corner of its box
+	* - max: Maximum corner of its box
+	* Returns: void
+	*/
+	void setBounds(int body, const glm::vec3& min, const glm::vec3& max)
+	{
+		m_bounds[body] = Bounds{ min, max };
+	}
+
+	/*
+	* Re-bins the bodies whose bounds crossed a cell border since the last update and
+	* finds every overlapping pair. Both passes are split over the job system
+	* Parameters:
+	* - jobs: Job system the passes run on
+	* Returns: The overlapping pairs, valid until the next update
+	*/
+	const std::vector<BodyPair>& update(JobSystem& jobs)
+	{
+		rebin(jobs);
+		findPairs(jobs);
+		return m_pairs;
+	}
+
+	const std::vector<BodyPair>& getPairs() const
+	{
+		return m_pairs;
+	}
+
+	int getBodyCount() const
+	{
+		return m_bodyCount;
+	}
+
+	// Cells holding at least one body
+	int getCellCount() const
+	{
+		return m_usedCells;
+	}
+
+	// Bodies that changed cells in the last update, the rest cost the grid nothing
+	int getRebinnedCount() const
+	{
+		return m_rebinned;
+	}
+
+private:
+	struct Bounds
+	{
+		glm::vec3 min{};
+		glm::vec3 max{};
+	};
+
+	// Inclusive range of cells a body's box touches
+	struct CellRange
+	{
+		glm::ivec3 min{};
+		glm::ivec3 max{};
+
+		bool operator==(const CellRange& other) const
+		{
+			return min == other.min && max == other.max;
+		}
+
+		bool operator!=(const CellRange& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	// The first few bodies live in the cell itself, so scanning the cells reads them in order
+	static constexpr int inlineBodies{ 6 };
+
+	struct alignas(64) Cell
+	{
+		glm::ivec3 coord{};
+		int count{ 0 };
+		int bodies[inlineBodies]{};
+		std::vector<int> overflow{};
+
+		int at(int index) const
+		{
+			return index < inlineBodies ? bodies[index] : overflow[index - inlineBodies];
+		}
+
+		void push(int body)
+		{
+			if (count < inlineBodies)
+				bodies[count] = body;
+			else
+				overflow.push_back(body);
+			++count;
+		}
+
+		// Moves the last body into the removed one's place
+		void erase(int body)
+		{
+			int index{ 0 };
+			while (at(index) != body)
+				++index;
+
+			int last{ at(count - 1) };
+			if (index < inlineBodies)
+				bodies[index] = last;
+			else
+				overflow[index - inlineBodies] = last;
+
+			if (count > inlineBodies)
+				overflow.pop_back();
+			--count;
+		}
+	};
+
+	// Per job output, kept between updates so neither pass allocates once warmed up
+	struct Partial
+	{
+		std::vector<int> moved{};
+		std::vector<BodyPair> pairs{};
+	};
+
+	static constexpr std::size_t initialTableSize{ 1024 };
+	static constexpr int emptySlot{ -1 };
+	// Bodies per job in the re-bin pass and cells per job in the pair pass
+	static constexpr int bodiesPerJob{ 4096 };
+	static constexpr int cellsPerJob{ 512 };
+
+	float m_inverseCellSize{};
+
+	// A cell's bodies are scattered through the array, so a body's whole box is one read
+	std::vector<Bounds> m_bounds{};
+	std::vector<CellRange> m_cells{};
+	std::vector<bool> m_alive{};
+	std::vector<int> m_freeBodies{};
+	int m_bodyCount{ 0 };
+
+	// Cells are stored densely and found through an open addressing table of their indices
+	std::vector<Cell> m_gridCells{};
+	std::vector<int> m_freeCells{};
+	std::vector<int> m_table{};
+	int m_usedCells{ 0 };
+
+	std::vector<Partial> m_partials{};
+	std::vector<BodyPair> m_pairs{};
+	int m_rebinned{ 0 };
+
+	int cellOf(float value) const
+	{
+		return static_cast<int>(std::floor(value * m_inverseCellSize));
+	}
+
+	CellRange cellRange(int body) const
+	{
+		const Bounds& bounds{ m_bounds[body] };
+		return CellRange{ glm::ivec3(cellOf(bounds.min.x), cellOf(bounds.min.y), cellOf(bounds.min.z)),
+			glm::ivec3(cellOf(bounds.max.x), cellOf(bounds.max.y), cellOf(bounds.max.z)) };
+	}
+
+	static std::size_t hashCell(const glm::ivec3& coord)
+	{
+		std::uint64_t key{ static_cast<std::uint64_t>(static_cast<std::uint32_t>(coord.x)) * 0x9E3779B97F4A7C15ull
+			^ static_cast<std::uint64_t>(static_cast<std::uint32_t>(coord.y)) * 0xC2B2AE3D27D4EB4Full
+			^ static_cast<std::uint64_t>(static_cast<std::uint32_t>(coord.z)) * 0x165667B19E3779F9ull };
+		return static_cast<std::size_t>(key ^ (key >> 29));
+	}
+
+	// Slot holding the cell, or the empty slot it would go in
+	std::size_t findSlot(const glm::ivec3& coord) const
+	{
+		std::size_t mask{ m_table.size() - 1 };
+		std::size_t slot{ hashCell(coord) & mask };
+		while (m_table[slot] != emptySlot && m_gridCells[m_table[slot]].coord != coord)
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	Cell& acquireCell(const glm::ivec3& coord)
+	{
+		std::size_t slot{ findSlot(coord) };
+		if (m_table[slot] != emptySlot)
+			return m_gridCells[m_table[slot]];
+
+		// Kept at most half full so probe runs stay short
+		if (static_cast<std::size_t>(m_usedCells + 1) * 2 > m_table.size())
+		{
+			growTable();
+			slot = findSlot(coord);
+		}
+
+		int index{};
+		if (m_freeCells.empty())
+		{
+			index = static_cast<int>(m_gridCells.size());
+			m_gridCells.emplace_back();
+		}
+		else
+		{
+			index = m_freeCells.back();
+			m_freeCells.pop_back();
+		}
+
+		m_gridCells[index].coord = coord;
+		m_table[slot] = index;
+		++m_usedCells;
+		return m_gridCells[index];
+	}
+
+	// Empties the slot and shifts later entries of the probe run back so lookups never stop early
+	void releaseCell(const glm::ivec3& coord)
+	{
+		std::size_t mask{ m_table.size() - 1 };
+		std::size_t slot{ findSlot(coord) };
+		m_freeCells.push_back(m_table[slot]);
+		m_table[slot] = emptySlot;
+		--m_usedCells;
+
+		std::size_t next{ (slot + 1) & mask };
+		while (m_table[next] != emptySlot)
+		{
+			std::size_t home{ hashCell(m_gridCells[m_table[next]].coord) & mask };
+			// Move the entry into the hole unless its home lies cyclically in (slot, next]
+			bool stays{ slot <= next ? (home > slot && home <= next) : (home > slot || home <= next) };
+			if (!stays)
+			{
+				m_table[slot] = m_table[next];
+				m_table[next] = emptySlot;
+				slot = next;
+			}
+			next = (next + 1) & mask;
+		}
+	}
+
+	void growTable()
+	{
+		m_table.assign(m_table.size() * 2, emptySlot);
+		std::size_t mask{ m_table.size() - 1 };
+		for (int index{ 0 }; index < static_cast<int>(m_gridCells.size()); ++index)
+		{
+			if (m_gridCells[index].count == 0)
+				continue;
+
+			std::size_t slot{ hashCell(m_gridCells[index].coord) & mask };
+			while (m_table[slot] != emptySlot)
+				slot = (slot + 1) & mask;
+			m_table[slot] = index;
+		}
+	}
+
+	void insert(int body, const CellRange& range)
+	{
+		for (int y{ range.min.y }; y <= range.max.y; ++y)
+			for (int z{ range.min.z }; z <= range.max.z; ++z)
+				for (int x{ range.min.x }; x <= range.max.x; ++x)
+					acquireCell(glm::ivec3(x, y, z)).push(body);
+	}
+
+	void erase(int body, const CellRange& range)
+	{
+		for (int y{ range.min.y }; y <= range.max.y; ++y)
+		{
+			for (int z{ range.min.z }; z <= range.max.z; ++z)
+			{
+				for (int x{ range.min.x }; x <= range.max.x; ++x)
+				{
+					glm::ivec3 coord{ x, y, z };
+					Cell& cell{ m_gridCells[m_table[findSlot(coord)]] };
+					cell.erase(body);
+					if (cell.count == 0)
+						releaseCell(coord);
+				}
+			}
+		}
+	}
+
+	void ensurePartials(int jobCount)
+	{
+		if (static_cast<int>(m_partials.size()) < jobCount)
+			m_partials.resize(jobCount);
+	}
+
+	// Finds the bodies that crossed a cell border in parallel, then moves them between cells
+	void rebin(JobSystem& jobs)
+	{
+		int bodyCapacity{ static_cast<int>(m_alive.size()) };
+		int jobCount{ (bodyCapacity + bodiesPerJob - 1) / bodiesPerJob };
+		ensurePartials(jobCount);
+
+		jobs.parallelFor(0, jobCount, 1, [&](int first, int last)
+			{
+				for (int job{ first }; job < last; ++job)
+				{
+					std::vector<int>& moved{ m_partials[job].moved };
+					moved.clear();
+					int end{ std::min(bodyCapacity, (job + 1) * bodiesPerJob) };
+					for (int body{ job * bodiesPerJob }; body < end; ++body)
+					{
+						if (m_alive[body] && cellRange(body) != m_cells[body])
+							moved.push_back(body);
+					}
+				}
+			});
+
+		// The cells are shared, so the moves themselves are applied on one thread
+		m_rebinned = 0;
+		for (int job{ 0 }; job < jobCount; ++job)
+		{
+			for (int body : m_partials[job].moved)
+			{
+				CellRange range{ cellRange(body) };
+				erase(body, m_cells[body]);
+				insert(body, range);
+				m_cells[body] = range;
+			}
+			m_rebinned += static_cast<int>(m_partials[job].moved.size());
+		}
+	}
+
+	// Tests every pair sharing a cell, each pair is reported only by the cell holding the
+	// minimum corner of the two boxes' overlap so bodies spanning several cells count once
+	void findPairs(JobSystem& jobs)
+	{
+		int cellCount{ static_cast<int>(m_gridCells.size()) };
+		int jobCount{ (cellCount + cellsPerJob - 1) / cellsPerJob };
+		ensurePartials(jobCount);
+
+		jobs.parallelFor(0, jobCount, 1, [&](int first, int last)
+			{
+				for (int job{ first }; job < last; ++job)
+				{
+					std::vector<BodyPair>& pairs{ m_partials[job].pairs };
+					pairs.clear();
+					int end{ std::min(cellCount, (job + 1) * cellsPerJob) };
+					for (int index{ job * cellsPerJob }; index < end; ++index)
+						findPairsInCell(m_gridCells[index], pairs);
+				}
+			});
+
+		// Merging in job order keeps the pairs identical no matter which thread ran what
+		m_pairs.clear();
+		for (int job{ 0 }; job < jobCount; ++job)
+			m_pairs.insert(m_pairs.end(), m_partials[job].pairs.begin(), m_partials[job].pairs.end());
+	}
+
+	void findPairsInCell(const Cell& cell, std::vector<BodyPair>& pairs) const
+	{
+		int count{ cell.count };
+		glm::vec3 low{ cell.coord };
+		for (int i{ 0 }; i < count; ++i)
+		{
+			int a{ cell.at(i) };
+			const Bounds boundsA{ m_bounds[a] };
+			for (int j{ i + 1 }; j < count; ++j)
+			{
+				int b{ cell.at(j) };
+				const Bounds& boundsB{ m_bounds[b] };
+				if (boundsB.min.x > boundsA.max.x || boundsB.max.x < boundsA.min.x || boundsB.min.y > boundsA.max.y
+					|| boundsB.max.y < boundsA.min.y || boundsB.min.z > boundsA.max.z || boundsB.max.z < boundsA.min.z)
+					continue;
+
+				// Both boxes reach into this cell, so the overlap's corner can only lie in it or below it
+				if (std::max(boundsA.min.x, boundsB.min.x) * m_inverseCellSize < low.x
+					|| std::max(boundsA.min.y, boundsB.min.y) * m_inverseCellSize < low.y
+					|| std::max(boundsA.min.z, boundsB.min.z) * m_inverseCellSize < low.z)
+					continue;
+
+				pairs.push_back(a < b ? BodyPair{ a, b } : BodyPair{ b, a });
+			}
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,266 @@
+/*
+* File: draw_list.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program defines an API-agnostic list of draw commands and a builder
+			   that culls and generates the commands for the scene on worker threads,
+			   leaving only the submission of the merged list to the GL thread
+*/
+
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include "frustum.h"
+#include "stream_buffer.h"
+#include "../job/job_system.h"
+#include "../memory/linear_arena.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Passes are submitted in this order, each with its own shader and mesh
+enum class DrawPass : std::uint8_t
+{
+	lit,
+	unlit,
+};
+
+// How commands within a pass are ordered
+enum class DrawOrder : std::uint8_t
+{
+	// Fewest texture binds, best when a depth pre-pass already removed the overdraw
+	material,
+	// Nearest first so the depth test rejects hidden fragments before they are shaded
+	frontToBack,
+};
+
+struct DrawCommand
+{
+	// Pass and the order's key in the high 32 bits, the position in the unsorted list below
+	std::uint64_t sortKey{};
+	DrawPass pass{};
+	int material{};
+	// Byte offset of the first model matrix in the frame's stream buffer region
+	std::intptr_t instanceOffset{};
+	int instanceCount{};
+	// Distance from the camera to the nearest instance, the instances follow nearest first
+	float distance{};
+};
+
+// A group of cubes sharing pass and material, the input to draw list generation
+struct DrawBatch
+{
+	DrawPass pass{};
+	int material{};
+	const glm::vec3* positions{ nullptr };
+	int count{};
+	float scale{ 1.0f };
+};
+
+class DrawList
+{
+public:
+	std::vector<DrawCommand> commands{};
+
+	void clear()
+	{
+		commands.clear();
+	}
+
+	void add(DrawPass pass, int material, std::intptr_t instanceOffset, int instanceCount, float distance)
+	{
+		commands.push_back(DrawCommand{ 0, pass, material, instanceOffset, instanceCount, distance });
+	}
+
+	void append(const DrawList& other)
+	{
+		commands.insert(commands.end(), other.commands.begin(), other.commands.end());
+	}
+
+	/*
+	* Orders commands by pass, then by material to minimize state changes or by distance
+	* to minimize overdraw. Ties keep their list order, which is folded into the key so
+	* the in-place sort gives the stable order without the temporary buffer
+	* std::stable_sort allocates
+	* Parameters:
+	* - order: What orders the commands within a pass
+	* Returns: void
+	*/
+	void sort(DrawOrder order)
+	{
+		for (std::size_t i{ 0 }; i < commands.size(); ++i)
+		{
+			DrawCommand& command{ commands[i] };
+			std::uint64_t key{ static_cast<std::uint64_t>(command.material & 0xFFFFFF) };
+			if (order == DrawOrder::frontToBack)
+			{
+				// Non-negative floats order like their bits, the top 24 bits are precise enough
+				std::uint32_t bits{};
+				std::memcpy(&bits, &command.distance, sizeof(bits));
+				key = bits >> 8;
+			}
+			command.sortKey = (static_cast<std::uint64_t>(command.pass) << 56) | (key << 32) | static_cast<std::uint32_t>(i);
+		}
+
+		std::sort(commands.begin(), commands.end(), [](const DrawCommand& a, const DrawCommand& b)
+			{
+				return a.sortKey < b.sortKey;
+			});
+	}
+};
+
+class DrawListBuilder
+{
+public:
+	// Instances handled per work item, each item becomes at most one command
+	static constexpr int rangeSize{ 64 };
+
+	// Work ranges per job, each job fills its own partial list
+	static constexpr int rangesPerJob{ 4 };
+
+	/*
+	* Creates the builder
+	* Parameters:
+	* - jobs: Job system the generation is split over
+	* Returns: DrawListBuilder object
+	*/
+	explicit DrawListBuilder(JobSystem& jobs)
+		: m_jobs{ jobs }
+	{
+	}
+
+	/*
+	* Culls every batch against the frustum and writes the model matrices of the
+	* visible cubes into the stream buffer nearest first, splitting the work over the
+	* job system
+	* Parameters:
+	* - batches: Cube groups to draw this frame
+	* - frustum: View frustum of the camera
+	* - cameraPosition: World position of the camera
+	* - order: What orders the commands within a pass
+	* - stream: Stream buffer between beginFrame and flush
+	* - frameArena: Arena reset once per frame, holds the work ranges while the jobs run
+	* Returns: The merged and sorted draw list, valid until the next build
+	*/
+	const DrawList& build(const std::vector<DrawBatch>& batches, const Frustum& frustum, const glm::vec3& cameraPosition, DrawOrder order,
+		StreamBuffer& stream, LinearArena& frameArena)
+	{
+		int rangeCount{ 0 };
+		for (const DrawBatch& batch : batches)
+			rangeCount += (batch.count + rangeSize - 1) / rangeSize;
+
+		m_ranges = frameArena.allocateArray<WorkRange>(static_cast<std::size_t>(rangeCount));
+		m_merged.clear();
+		if (!m_ranges)
+			return m_merged;
+
+		int next{ 0 };
+		for (int b{ 0 }; b < static_cast<int>(batches.size()); ++b)
+		{
+			for (int first{ 0 }; first < batches[b].count; first += rangeSize)
+				m_ranges[next++] = WorkRange{ b, first, std::min(first + rangeSize, batches[b].count) };
+		}
+
+		int jobCount{ (rangeCount + rangesPerJob - 1) / rangesPerJob };
+		if (static_cast<int>(m_partials.size()) < jobCount)
+			m_partials.resize(jobCount);
+
+		m_jobs.parallelFor(0, jobCount, 1, [&](int first, int last)
+			{
+				for (int job{ first }; job < last; ++job)
+					generate(batches, frustum, cameraPosition, stream, job * rangesPerJob, std::min(rangeCount, (job + 1) * rangesPerJob), m_partials[job]);
+			});
+
+		// Merging in job order keeps the list identical no matter which thread ran what
+		for (int job{ 0 }; job < jobCount; ++job)
+			m_merged.append(m_partials[job]);
+		m_merged.sort(order);
+
+		return m_merged;
+	}
+
+private:
+	struct WorkRange
+	{
+		int batch{};
+		int first{};
+		int last{};
+	};
+
+	struct VisibleInstance
+	{
+		float distance{};
+		int index{};
+	};
+
+	JobSystem& m_jobs;
+	std::vector<DrawList> m_partials{};
+	// Lives in the frame arena, only valid during build
+	WorkRange* m_ranges{ nullptr };
+	DrawList m_merged{};
+
+	/*
+	* Generates the partial draw list for a contiguous share of the work ranges
+	* Parameters:
+	* - batches: Cube groups to draw this frame
+	* - frustum: View frustum of the camera
+	* - cameraPosition: World position of the camera
+	* - stream: Stream buffer receiving the model matrices
+	* - begin: First work range of this share
+	* - end: One past the last work range of this share
+	* - list: Partial list receiving the commands
+	* Returns: void
+	*/
+	void generate(const std::vector<DrawBatch>& batches, const Frustum& frustum, const glm::vec3& cameraPosition, StreamBuffer& stream,
+		int begin, int end, DrawList& list)
+	{
+		list.clear();
+
+		for (int r{ begin }; r < end; ++r)
+		{
+			const WorkRange& range{ m_ranges[r] };
+			const DrawBatch& batch{ batches[range.batch] };
+
+			StreamAllocation allocation{ stream.allocate(sizeof(glm::mat4) * (range.last - range.first)) };
+			if (!allocation.data)
+				continue;
+
+			// Bounding sphere of a unit cube scaled by the batch scale
+			const float radius{ 0.8660254f * batch.scale };
+
+			// Sorted on the stack, the stream buffer is write-combined and never read back
+			VisibleInstance instances[rangeSize];
+			int visible{ 0 };
+			for (int i{ range.first }; i < range.last; ++i)
+			{
+				if (frustum.intersectsSphere(batch.positions[i], radius))
+					instances[visible++] = VisibleInstance{ glm::length(batch.positions[i] - cameraPosition), i };
+			}
+			if (visible == 0)
+				continue;
+
+			std::sort(instances, instances + visible, [](const VisibleInstance& a, const VisibleInstance& b)
+				{
+					return a.distance < b.distance;
+				});
+
+			glm::mat4* models{ static_cast<glm::mat4*>(allocation.data) };
+			for (int i{ 0 }; i < visible; ++i)
+			{
+				glm::mat4 model{ glm::mat4(1.0f) };
+				model = glm::translate(model, batch.positions[instances[i].index]);
+				model = glm::scale(model, glm::vec3(batch.scale));
+				models[i] = model;
+			}
+
+			list.add(batch.pass, batch.material, allocation.offset, visible, instances[0].distance);
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,265 @@
+/*
+* File: dynamic_resolution.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program renders the scene into an offscreen target whose
+			   resolution follows the measured GPU time, shrinking when a frame
+			   goes over budget and growing back when there is headroom, and
+			   upscales the result to the window
+*/
+
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+class DynamicResolution
+{
+public:
+	// Queries in flight, results are read a few frames late so the CPU never waits
+	static constexpr int queryCount{ 4 };
+
+	/*
+	* Creates the controller, the render target is allocated on the first resize
+	* Parameters:
+	* - budgetMs: GPU time in milliseconds the scene should fit in
+	* - minScale: Smallest fraction of the window size rendered per axis
+	* - maxScale: Largest fraction of the window size rendered per axis
+	* Returns: DynamicResolution object
+	*/
+	explicit DynamicResolution(float budgetMs = 14.0f, float minScale = 0.5f, float maxScale = 1.0f)
+		: m_budgetMs{ budgetMs }
+		, m_minScale{ minScale }
+		, m_maxScale{ maxScale }
+		, m_scale{ maxScale }
+	{
+		glGenQueries(queryCount, m_queries);
+	}
+
+	~DynamicResolution()
+	{
+		glDeleteQueries(queryCount, m_queries);
+		releaseTarget();
+	}
+
+	DynamicResolution(const DynamicResolution&) = delete;
+	DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+	/*
+	* Reallocates the render target for a new window size. The target always has the
+	* full window size and lower scales render into its lower left corner, so
+	* changing the scale never reallocates
+	* Parameters:
+	* - width: Framebuffer width of the window in pixels
+	* - height: Framebuffer height of the window in pixels
+	* Returns: void
+	*/
+	void resize(int width, int height)
+	{
+		if (width == m_windowWidth && height == m_windowHeight)
+			return;
+
+		releaseTarget();
+		m_windowWidth = width;
+		m_windowHeight = height;
+		if (width <= 0 || height <= 0)
+			return;
+
+		int targetWidth{ static_cast<int>(std::ceil(width * m_maxScale)) };
+		int targetHeight{ static_cast<int>(std::ceil(height * m_maxScale)) };
+
+		glGenFramebuffers(1, &m_framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+		glGenTextures(1, &m_colorTexture);
+		glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, targetWidth, targetHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+
+		// Depth is a texture so later passes can read it, e.g. to build an occlusion pyramid
+		glGenTextures(1, &m_depthTexture);
+		glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, targetWidth, targetHeight, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "ERROR::DYNAMIC_RESOLUTION::FRAMEBUFFER_INCOMPLETE\n";
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			releaseTarget();
+			return;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	/*
+	* Updates the scale from the newest finished GPU timing, binds the render target
+	* with its viewport and starts timing this frame. Without a target the window is
+	* rendered to directly
+	* Parameters: None
+	* Returns: void
+	*/
+	void beginFrame()
+	{
+		readFinishedQueries();
+
+		if (m_framebuffer == 0)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, m_windowWidth, m_windowHeight);
+		}
+		else
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+			glViewport(0, 0, getRenderWidth(), getRenderHeight());
+		}
+
+		// A query is only reused once its result has been read
+		if (m_issued - m_read < queryCount)
+		{
+			glBeginQuery(GL_TIME_ELAPSED, m_queries[m_issued % queryCount]);
+			m_queryScales[m_issued % queryCount] = m_scale;
+			m_timing = true;
+		}
+	}
+
+	/*
+	* Stops timing and upscales the rendered area to the window
+	* Parameters: None
+	* Returns: void
+	*/
+	void present()
+	{
+		if (m_timing)
+		{
+			glEndQuery(GL_TIME_ELAPSED);
+			++m_issued;
+			m_timing = false;
+		}
+
+		if (m_framebuffer == 0)
+			return;
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, getRenderWidth(), getRenderHeight(), 0, 0, m_windowWidth, m_windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, m_windowWidth, m_windowHeight);
+	}
+
+	void setBudget(float budgetMs)
+	{
+		m_budgetMs = budgetMs;
+	}
+
+	// Fraction of the window size rendered per axis
+	float getScale() const
+	{
+		return m_scale;
+	}
+
+	// Latest measured GPU time of the scene in milliseconds
+	float getGpuTime() const
+	{
+		return m_gpuTimeMs;
+	}
+
+	int getRenderWidth() const
+	{
+		return std::max(1, static_cast<int>(m_windowWidth * m_scale));
+	}
+
+	int getRenderHeight() const
+	{
+		return std::max(1, static_cast<int>(m_windowHeight * m_scale));
+	}
+
+	// Depth of the last rendered frame in the lower left render area, 0 without a target
+	unsigned int getDepthTexture() const
+	{
+		return m_depthTexture;
+	}
+
+private:
+	// Scale changes smaller than this are ignored so the image doesn't shimmer
+	static constexpr float scaleStep{ 0.05f };
+
+	float m_budgetMs{};
+	float m_minScale{};
+	float m_maxScale{};
+	float m_scale{};
+	float m_gpuTimeMs{ 0.0f };
+
+	int m_windowWidth{ 0 };
+	int m_windowHeight{ 0 };
+	unsigned int m_framebuffer{ 0 };
+	unsigned int m_colorTexture{ 0 };
+	unsigned int m_depthTexture{ 0 };
+
+	unsigned int m_queries[queryCount]{};
+	float m_queryScales[queryCount]{};
+	std::uint64_t m_issued{ 0 };
+	std::uint64_t m_read{ 0 };
+	bool m_timing{ false };
+
+	void readFinishedQueries()
+	{
+		while (m_read < m_issued)
+		{
+			unsigned int query{ m_queries[m_read % queryCount] };
+			float queryScale{ m_queryScales[m_read % queryCount] };
+
+			GLint available{ 0 };
+			glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				break;
+
+			GLuint64 elapsed{ 0 };
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+			++m_read;
+
+			m_gpuTimeMs = static_cast<float>(elapsed) / 1000000.0f;
+
+			// Frames still in flight from before the last change would push the scale twice
+			if (queryScale == m_scale)
+				adjustScale();
+		}
+	}
+
+	void adjustScale()
+	{
+		if (m_gpuTimeMs <= 0.0f)
+			return;
+
+		// Fragment cost goes with the pixel count, the square of the axis scale.
+		// Only half the correction is applied per sample to damp oscillation
+		float ideal{ m_scale * std::sqrt(m_budgetMs / m_gpuTimeMs) };
+		float target{ std::clamp(m_scale + (ideal - m_scale) * 0.5f, m_minScale, m_maxScale) };
+
+		if (std::abs(target - m_scale) >= scaleStep || target == m_minScale || target == m_maxScale)
+			m_scale = target;
+	}
+
+	void releaseTarget()
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteTextures(1, &m_colorTexture);
+		glDeleteTextures(1, &m_depthTexture);
+		m_framebuffer = 0;
+		m_colorTexture = 0;
+		m_depthTexture = 0;
+	}
+};
+
+#endif
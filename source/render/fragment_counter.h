@@ -0,0 +1,106 @@
+/*
+* File: fragment_counter.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program counts the fragments that pass the depth test in the
+			   shaded passes with occlusion queries and reports them per rendered
+			   pixel, which measures how much overdraw the expensive shaders pay for
+*/
+
+#ifndef FRAGMENT_COUNTER_H
+#define FRAGMENT_COUNTER_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+class FragmentCounter
+{
+public:
+	// Queries in flight, results are read a few frames late so the CPU never waits
+	static constexpr int queryCount{ 4 };
+
+	FragmentCounter()
+	{
+		glGenQueries(queryCount, m_queries);
+	}
+
+	~FragmentCounter()
+	{
+		glDeleteQueries(queryCount, m_queries);
+	}
+
+	FragmentCounter(const FragmentCounter&) = delete;
+	FragmentCounter& operator=(const FragmentCounter&) = delete;
+
+	/*
+	* Reads the finished queries and starts counting, nothing is counted while all
+	* queries are still in flight
+	* Parameters:
+	* - pixelCount: Pixels rendered this frame, the count is divided by it
+	* Returns: void
+	*/
+	void begin(int pixelCount)
+	{
+		readFinishedQueries();
+
+		if (m_issued - m_read < queryCount)
+		{
+			glBeginQuery(GL_SAMPLES_PASSED, m_queries[m_issued % queryCount]);
+			m_queryPixels[m_issued % queryCount] = pixelCount;
+			m_counting = true;
+		}
+	}
+
+	/*
+	* Stops counting, the draws in between are the ones measured
+	* Parameters: None
+	* Returns: void
+	*/
+	void end()
+	{
+		if (!m_counting)
+			return;
+
+		glEndQuery(GL_SAMPLES_PASSED);
+		++m_issued;
+		m_counting = false;
+	}
+
+	// Latest fragments shaded per rendered pixel, 1 means no overdraw where geometry covers all
+	float getFragmentsPerPixel() const
+	{
+		return m_fragmentsPerPixel;
+	}
+
+private:
+	unsigned int m_queries[queryCount]{};
+	int m_queryPixels[queryCount]{};
+	std::uint64_t m_issued{ 0 };
+	std::uint64_t m_read{ 0 };
+	bool m_counting{ false };
+	float m_fragmentsPerPixel{ 0.0f };
+
+	void readFinishedQueries()
+	{
+		while (m_read < m_issued)
+		{
+			unsigned int query{ m_queries[m_read % queryCount] };
+			int pixels{ m_queryPixels[m_read % queryCount] };
+
+			GLint available{ 0 };
+			glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				break;
+
+			GLuint64 samples{ 0 };
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &samples);
+			++m_read;
+
+			if (pixels > 0)
+				m_fragmentsPerPixel = static_cast<float>(samples) / static_cast<float>(pixels);
+		}
+	}
+};
+
+#endif
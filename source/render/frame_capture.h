@@ -0,0 +1,387 @@
+/*
+* File: frame_capture.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program records the frames shown in the window without stalling
+			   the render thread. Each frame is read into one of a ring of pixel
+			   pack buffers, which is mapped a few frames later once its fence has
+			   signalled, and a writer thread saves the mapped pixels straight from
+			   the buffer as a numbered TGA file
+*/
+
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// How the writer thread stores a frame
+enum class CaptureEncoding
+{
+	// Uncompressed 24 bit TGA, the cheapest to write
+	raw,
+	// Run-length encoded 24 bit TGA, flat areas such as the sky shrink a lot
+	rle,
+};
+
+/*
+* Frames are written as frame_000000.tga upwards without gaps, so a video can be made
+* with for example: ffmpeg -framerate 60 -i frame_%06d.tga capture.mp4
+*/
+class FrameCapture
+{
+public:
+	/*
+	* Creates the buffers and starts the writer thread
+	* Parameters:
+	* - directory: Directory the frames are written to, created if missing
+	* - encoding: Raw or run-length encoded frames
+	* - bufferCount: Frames that may be in flight between readback and disk
+	* Returns: FrameCapture object
+	*/
+	FrameCapture(const std::string& directory, CaptureEncoding encoding, int bufferCount = 6)
+		: m_directory{ directory }
+		, m_encoding{ encoding }
+		, m_slots(static_cast<std::size_t>(bufferCount))
+	{
+		std::error_code error{};
+		std::filesystem::create_directories(m_directory, error);
+		if (error)
+			std::cout << "ERROR::FRAME_CAPTURE::DIRECTORY_NOT_CREATED: " << m_directory << "\n";
+
+		for (Slot& slot : m_slots)
+			glGenBuffers(1, &slot.buffer);
+
+		m_writer = std::thread{ [this]() { writeFrames(); } };
+	}
+
+	/*
+	* Waits for the frames still in flight so the recording ends with the last frame,
+	* then stops the writer. Must run while the GL context still exists
+	*/
+	~FrameCapture()
+	{
+		while (m_mapped < m_issued)
+		{
+			Slot& slot{ m_slots[m_mapped % m_slots.size()] };
+			glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			mapSlot(slot);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_stopping = true;
+		}
+		m_wakeUp.notify_one();
+		m_writer.join();
+		std::cout << "Frame capture wrote " << getWrittenCount() << " frames to " << m_directory << ", " << m_dropped << " dropped\n";
+
+		while (m_unmapped < m_mapped)
+			unmapSlot(m_slots[m_unmapped++ % m_slots.size()]);
+
+		for (Slot& slot : m_slots)
+			glDeleteBuffers(1, &slot.buffer);
+	}
+
+	FrameCapture(const FrameCapture&) = delete;
+	FrameCapture& operator=(const FrameCapture&) = delete;
+
+	/*
+	* Hands finished readbacks to the writer and starts reading the window's back buffer.
+	* Call after the frame has been drawn and before the buffers are swapped. Never
+	* waits, when every buffer is still in flight the frame is dropped
+	* Parameters:
+	* - width: Framebuffer width of the window in pixels
+	* - height: Framebuffer height of the window in pixels
+	* Returns: void
+	*/
+	void capture(int width, int height)
+	{
+		collect();
+
+		if (width <= 0 || height <= 0)
+			return;
+
+		if (m_issued - m_unmapped == m_slots.size())
+		{
+			++m_dropped;
+			return;
+		}
+
+		Slot& slot{ m_slots[m_issued % m_slots.size()] };
+		std::size_t bytes{ static_cast<std::size_t>(width) * height * 4 };
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		// Storage is only respecified when the window size changes
+		if (bytes != slot.bytes)
+		{
+			glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+			slot.bytes = bytes;
+		}
+
+		// BGRA is the layout drivers read back without converting, and TGA stores it
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+		glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		slot.width = width;
+		slot.height = height;
+		slot.sequence = m_issued;
+		++m_issued;
+	}
+
+	// Frames saved to disk so far
+	std::uint64_t getWrittenCount() const
+	{
+		return m_written.load(std::memory_order_relaxed);
+	}
+
+	// Frames skipped because the readbacks or the writer fell behind
+	std::uint64_t getDroppedCount() const
+	{
+		return m_dropped;
+	}
+
+private:
+	enum class SlotState
+	{
+		// Free or being read back, owned by the render thread
+		idle,
+		// Mapped and waiting for or being saved by the writer
+		mapped,
+		// Saved, waiting for the render thread to unmap it
+		written,
+	};
+
+	struct Slot
+	{
+		unsigned int buffer{};
+		std::size_t bytes{ 0 };
+		// Placed after the readback, the pixels can be mapped without waiting once it signals
+		GLsync fence{ nullptr };
+		int width{};
+		int height{};
+		std::uint64_t sequence{};
+		const unsigned char* pixels{ nullptr };
+		SlotState state{ SlotState::idle };
+	};
+
+	std::string m_directory{};
+	CaptureEncoding m_encoding{};
+	std::vector<Slot> m_slots{};
+
+	// Frames pass through the slots in order, each counter trails the one before it
+	std::uint64_t m_issued{ 0 };
+	std::uint64_t m_mapped{ 0 };
+	std::uint64_t m_unmapped{ 0 };
+	std::uint64_t m_dropped{ 0 };
+
+	std::thread m_writer{};
+	std::mutex m_mutex{};
+	std::condition_variable m_wakeUp{};
+	bool m_stopping{ false };
+	std::atomic<std::uint64_t> m_written{ 0 };
+
+	// Owned by the writer thread, grown only when a larger frame arrives
+	std::vector<unsigned char> m_encoded{};
+	char m_path[512]{};
+	bool m_writeFailed{ false };
+
+	// Unmaps the frames the writer is done with, then maps the readbacks that have finished
+	void collect()
+	{
+		while (m_unmapped < m_mapped)
+		{
+			Slot& slot{ m_slots[m_unmapped % m_slots.size()] };
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				if (slot.state != SlotState::written)
+					break;
+			}
+			unmapSlot(slot);
+			++m_unmapped;
+		}
+
+		while (m_mapped < m_issued)
+		{
+			Slot& slot{ m_slots[m_mapped % m_slots.size()] };
+			if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+				break;
+			mapSlot(slot);
+		}
+	}
+
+	// Maps a slot whose readback has finished and hands it to the writer
+	void mapSlot(Slot& slot)
+	{
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		const unsigned char* pixels{ static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+			static_cast<GLsizeiptr>(static_cast<std::size_t>(slot.width) * slot.height * 4), GL_MAP_READ_BIT)) };
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			slot.pixels = pixels;
+			slot.state = SlotState::mapped;
+		}
+		m_wakeUp.notify_one();
+		++m_mapped;
+	}
+
+	void unmapSlot(Slot& slot)
+	{
+		if (slot.pixels)
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+		slot.pixels = nullptr;
+		slot.state = SlotState::idle;
+	}
+
+	// Writer thread, saves the mapped slots in the order they were read back
+	void writeFrames()
+	{
+		std::size_t next{ 0 };
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		while (true)
+		{
+			m_wakeUp.wait(lock, [&]() { return m_stopping || m_slots[next].state == SlotState::mapped; });
+			// Everything mapped before stopping is saved first
+			if (m_slots[next].state != SlotState::mapped)
+				return;
+
+			Slot& slot{ m_slots[next] };
+			lock.unlock();
+			if (slot.pixels)
+				writeFrame(slot);
+			lock.lock();
+
+			slot.state = SlotState::written;
+			next = (next + 1) % m_slots.size();
+		}
+	}
+
+	/*
+	* Encodes a frame as a bottom-up 24 bit TGA and writes it in one call. Frames are
+	* written through C stdio so the writer doesn't allocate once its buffer has grown
+	* Parameters:
+	* - slot: Mapped slot holding BGRA pixels, bottom row first
+	* Returns: void
+	*/
+	void writeFrame(const Slot& slot)
+	{
+		const std::size_t width{ static_cast<std::size_t>(slot.width) };
+		const std::size_t height{ static_cast<std::size_t>(slot.height) };
+		// Raw needs 3 bytes a pixel, RLE at worst one more per 128 pixels of a row
+		std::size_t capacity{ 18 + height * (width * 3 + (width + 127) / 128) };
+		if (m_encoded.size() < capacity)
+			m_encoded.resize(capacity);
+
+		unsigned char* out{ m_encoded.data() };
+		const unsigned char header[18]{ 0, 0, static_cast<unsigned char>(m_encoding == CaptureEncoding::rle ? 10 : 2), 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			static_cast<unsigned char>(width & 0xFF), static_cast<unsigned char>(width >> 8),
+			static_cast<unsigned char>(height & 0xFF), static_cast<unsigned char>(height >> 8), 24, 0 };
+		for (unsigned char byte : header)
+			*out++ = byte;
+
+		for (std::size_t y{ 0 }; y < height; ++y)
+		{
+			const unsigned char* row{ slot.pixels + y * width * 4 };
+			if (m_encoding == CaptureEncoding::rle)
+				out = encodeRow(row, static_cast<int>(width), out);
+			else
+			{
+				for (std::size_t x{ 0 }; x < width; ++x)
+					out = copyPixel(row + x * 4, out);
+			}
+		}
+
+		std::snprintf(m_path, sizeof(m_path), "%s/frame_%06llu.tga", m_directory.c_str(), static_cast<unsigned long long>(slot.sequence));
+		std::FILE* file{ std::fopen(m_path, "wb") };
+		std::size_t size{ static_cast<std::size_t>(out - m_encoded.data()) };
+		bool written{ file && std::fwrite(m_encoded.data(), 1, size, file) == size };
+		if (file)
+			written = std::fclose(file) == 0 && written;
+
+		if (written)
+			m_written.fetch_add(1, std::memory_order_relaxed);
+		else if (!m_writeFailed)
+		{
+			std::cout << "ERROR::FRAME_CAPTURE::WRITE_FAILED: " << m_path << "\n";
+			m_writeFailed = true;
+		}
+	}
+
+	// Drops the alpha of a BGRA pixel
+	static unsigned char* copyPixel(const unsigned char* pixel, unsigned char* out)
+	{
+		out[0] = pixel[0];
+		out[1] = pixel[1];
+		out[2] = pixel[2];
+		return out + 3;
+	}
+
+	static bool samePixel(const unsigned char* a, const unsigned char* b)
+	{
+		return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+	}
+
+	/*
+	* Run-length encodes one row into TGA packets of up to 128 pixels. A packet either
+	* repeats one pixel or lists pixels literally until the next repeat starts
+	* Parameters:
+	* - row: BGRA pixels of the row
+	* - width: Pixels in the row
+	* - out: Receives the packets
+	* Returns: One past the last byte written
+	*/
+	static unsigned char* encodeRow(const unsigned char* row, int width, unsigned char* out)
+	{
+		int x{ 0 };
+		while (x < width)
+		{
+			int run{ 1 };
+			while (x + run < width && run < 128 && samePixel(row + x * 4, row + (x + run) * 4))
+				++run;
+
+			if (run > 1)
+			{
+				*out++ = static_cast<unsigned char>(0x80 | (run - 1));
+				out = copyPixel(row + x * 4, out);
+				x += run;
+				continue;
+			}
+
+			int literal{ 1 };
+			while (x + literal < width && literal < 128
+				&& !(x + literal + 1 < width && samePixel(row + (x + literal) * 4, row + (x + literal + 1) * 4)))
+				++literal;
+
+			*out++ = static_cast<unsigned char>(literal - 1);
+			for (int i{ 0 }; i < literal; ++i)
+				out = copyPixel(row + (x + i) * 4, out);
+			x += literal;
+		}
+		return out;
+	}
+};
+
+#endif
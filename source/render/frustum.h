@@ -0,0 +1,82 @@
+/*
+* File: frustum.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program extracts the six view frustum planes from a
+			   projection * view matrix and tests bounding volumes against them
+*/
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+struct Frustum
+{
+	// Left, right, bottom, top, near, far. xyz is the inward normal, w the distance
+	glm::vec4 planes[6]{};
+
+	/*
+	* Builds the frustum from a combined projection and view matrix
+	* Parameters:
+	* - viewProjection: Projection matrix multiplied by view matrix
+	* Returns: Frustum with normalized planes in world space
+	*/
+	static Frustum fromMatrix(const glm::mat4& viewProjection)
+	{
+		glm::vec4 rows[4]{};
+		for (int i{ 0 }; i < 4; ++i)
+			rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+		Frustum frustum{};
+		frustum.planes[0] = rows[3] + rows[0];
+		frustum.planes[1] = rows[3] - rows[0];
+		frustum.planes[2] = rows[3] + rows[1];
+		frustum.planes[3] = rows[3] - rows[1];
+		frustum.planes[4] = rows[3] + rows[2];
+		frustum.planes[5] = rows[3] - rows[2];
+
+		for (glm::vec4& plane : frustum.planes)
+			plane /= glm::length(glm::vec3(plane));
+
+		return frustum;
+	}
+
+	/*
+	* Tests whether a sphere is at least partly inside the frustum
+	* Parameters:
+	* - center: World space center of the sphere
+	* - radius: Radius of the sphere
+	* Returns: False only if the sphere is completely outside
+	*/
+	bool intersectsSphere(const glm::vec3& center, float radius) const
+	{
+		for (const glm::vec4& plane : planes)
+		{
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	/*
+	* Tests whether an axis aligned box is at least partly inside the frustum
+	* Parameters:
+	* - min: Minimum corner of the box
+	* - max: Maximum corner of the box
+	* Returns: False only if the box is completely outside
+	*/
+	bool intersectsBox(const glm::vec3& min, const glm::vec3& max) const
+	{
+		for (const glm::vec4& plane : planes)
+		{
+			// Corner furthest along the plane normal
+			glm::vec3 corner{ plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z };
+			if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+};
+
+#endif
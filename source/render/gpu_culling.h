@@ -0,0 +1,324 @@
+/*
+* File: gpu_culling.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program culls object bounds on the GPU with a compute shader,
+			   testing them against the view frustum and a depth pyramid built from
+			   the previous frame, and writes the surviving draws as compacted
+			   indirect commands so a whole material is submitted with one
+			   glMultiDrawArraysIndirect call. Needs GL 4.3, which Mesa's software
+			   renderer provides
+*/
+
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include "frustum.h"
+#include "../shader/shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#endif
+
+// Bounds of one object and its vertex range per material, laid out as std430 for the cull shader
+struct CullObject
+{
+	static constexpr int maxMaterials{ 8 };
+
+	glm::vec4 boundsMin{};
+	glm::vec4 boundsMax{};
+	GLint first[maxMaterials]{};
+	GLint count[maxMaterials]{};
+};
+
+class GpuCulling
+{
+public:
+	/*
+	* Resolves the GL 4.3 entry points, which the GL 3.3 loader does not provide
+	* Parameters:
+	* - load: Function used to look up GL entry points
+	* Returns: void
+	*/
+	static void loadExtensions(GLADloadproc load)
+	{
+		int major{}, minor{};
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		if (major < 4 || (major == 4 && minor < 3))
+			return;
+
+		s_dispatchCompute = reinterpret_cast<DispatchComputeProc>(load("glDispatchCompute"));
+		s_memoryBarrier = reinterpret_cast<MemoryBarrierProc>(load("glMemoryBarrier"));
+		s_bindImageTexture = reinterpret_cast<BindImageTextureProc>(load("glBindImageTexture"));
+		s_texStorage2D = reinterpret_cast<TexStorage2DProc>(load("glTexStorage2D"));
+		s_clearBufferData = reinterpret_cast<ClearBufferDataProc>(load("glClearBufferData"));
+		s_multiDrawArraysIndirect = reinterpret_cast<MultiDrawArraysIndirectProc>(load("glMultiDrawArraysIndirect"));
+	}
+
+	// True once loadExtensions found every entry point the GPU path needs
+	static bool isSupported()
+	{
+		return s_dispatchCompute && s_memoryBarrier && s_bindImageTexture && s_texStorage2D && s_clearBufferData && s_multiDrawArraysIndirect;
+	}
+
+	/*
+	* Compiles the cull and depth pyramid shaders, the buffers grow with the object count
+	* Parameters:
+	* - assets: Asset loader the shaders are read through
+	* Returns: GpuCulling object
+	*/
+	explicit GpuCulling(const AssetLoader& assets)
+		: m_cullShader{ assets, "source/shader/gpu_cull.comp" }
+		, m_pyramidShader{ assets, "source/shader/depth_pyramid.comp" }
+	{
+		glGenBuffers(1, &m_objectBuffer);
+		glGenBuffers(1, &m_commandBuffer);
+		glGenBuffers(1, &m_counterBuffer);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_counterBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * CullObject::maxMaterials, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		reserve(initialCapacity);
+	}
+
+	~GpuCulling()
+	{
+		glDeleteBuffers(1, &m_objectBuffer);
+		glDeleteBuffers(1, &m_commandBuffer);
+		glDeleteBuffers(1, &m_counterBuffer);
+		glDeleteTextures(1, &m_pyramid);
+		glDeleteProgram(m_cullShader.shaderProgram);
+		glDeleteProgram(m_pyramidShader.shaderProgram);
+	}
+
+	GpuCulling(const GpuCulling&) = delete;
+	GpuCulling& operator=(const GpuCulling&) = delete;
+
+	/*
+	* Culls the objects and writes the indirect commands of the survivors, grouped by
+	* material. The object array is only uploaded when its version changes
+	* Parameters:
+	* - objects: Objects to cull, empty slots have all counts zero
+	* - count: Number of objects
+	* - version: Changes whenever anything in objects changed
+	* - viewProjection: Projection matrix multiplied by view matrix of this frame
+	* Returns: void
+	*/
+	void cull(const CullObject* objects, int count, std::uint64_t version, const glm::mat4& viewProjection)
+	{
+		if (count > m_capacity)
+			reserve(count);
+
+		if (version != m_version || count != m_objectCount)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(CullObject)) * count, objects);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			m_version = version;
+			m_objectCount = count;
+		}
+
+		// Commands past each material's count stay zeroed and draw nothing
+		const GLuint zero{ 0 };
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+		s_clearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_counterBuffer);
+		s_clearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		if (count == 0)
+			return;
+
+		Frustum frustum{ Frustum::fromMatrix(viewProjection) };
+
+		m_cullShader.use();
+		m_cullShader.setInt("objectCount", count);
+		m_cullShader.setInt("commandStride", m_capacity);
+		glUniform4fv(glGetUniformLocation(m_cullShader.shaderProgram, "planes"), 6, &frustum.planes[0][0]);
+		m_cullShader.setBool("pyramidEnabled", m_pyramidValid);
+		m_cullShader.setMat4("pyramidViewProjection", m_pyramidViewProjection);
+		m_cullShader.setInt("pyramidLevels", m_pyramidLevels);
+		m_cullShader.setInt("pyramid", 0);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, m_pyramid);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_objectBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_commandBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_counterBuffer);
+
+		s_dispatchCompute(static_cast<GLuint>((count + groupSize - 1) / groupSize), 1, 1);
+
+		// The draws read the commands as indirect arguments
+		s_memoryBarrier(GL_COMMAND_BARRIER_BIT);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		m_cullViewProjection = viewProjection;
+	}
+
+	/*
+	* Draws the surviving objects of one material with a single call. The vertex array
+	* the object ranges refer to must be bound
+	* Parameters:
+	* - material: Material index below CullObject::maxMaterials
+	* Returns: void
+	*/
+	void draw(int material) const
+	{
+		if (m_objectCount == 0)
+			return;
+
+		const std::size_t offset{ sizeof(DrawArraysIndirectCommand) * static_cast<std::size_t>(material) * static_cast<std::size_t>(m_capacity) };
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+		s_multiDrawArraysIndirect(GL_TRIANGLES, reinterpret_cast<const void*>(offset), m_objectCount, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+	/*
+	* Reduces the depth buffer of the frame that was just culled and drawn into a max
+	* depth pyramid, which the next frame's cull tests its bounds against
+	* Parameters:
+	* - depthTexture: Depth texture the scene was rendered to, 0 disables the occlusion test
+	* - width: Width of the rendered area in pixels, starting at the lower left corner
+	* - height: Height of the rendered area in pixels
+	* Returns: void
+	*/
+	void buildDepthPyramid(unsigned int depthTexture, int width, int height)
+	{
+		m_pyramidValid = false;
+		if (depthTexture == 0 || width <= 0 || height <= 0)
+			return;
+
+		int levelWidth{ std::max(1, width / 2) };
+		int levelHeight{ std::max(1, height / 2) };
+		if (levelWidth != m_pyramidWidth || levelHeight != m_pyramidHeight)
+			createPyramid(levelWidth, levelHeight);
+
+		m_pyramidShader.use();
+		m_pyramidShader.setInt("source", 0);
+		glActiveTexture(GL_TEXTURE0);
+
+		// The first level reads the depth buffer, every later one the level before it
+		unsigned int source{ depthTexture };
+		int sourceLevel{ 0 };
+		int sourceWidth{ width };
+		int sourceHeight{ height };
+		for (int level{ 0 }; level < m_pyramidLevels; ++level)
+		{
+			glBindTexture(GL_TEXTURE_2D, source);
+			m_pyramidShader.setInt("sourceLevel", sourceLevel);
+			m_pyramidShader.setVec2("sourceSize", static_cast<float>(sourceWidth), static_cast<float>(sourceHeight));
+			s_bindImageTexture(0, m_pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+			s_dispatchCompute(static_cast<GLuint>((levelWidth + 7) / 8), static_cast<GLuint>((levelHeight + 7) / 8), 1);
+			s_memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+			source = m_pyramid;
+			sourceLevel = level;
+			sourceWidth = levelWidth;
+			sourceHeight = levelHeight;
+			levelWidth = std::max(1, levelWidth / 2);
+			levelHeight = std::max(1, levelHeight / 2);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		m_pyramidViewProjection = m_cullViewProjection;
+		m_pyramidValid = true;
+	}
+
+private:
+	static constexpr int groupSize{ 64 };
+	static constexpr int initialCapacity{ 256 };
+
+	struct DrawArraysIndirectCommand
+	{
+		GLuint count{};
+		GLuint instanceCount{};
+		GLuint first{};
+		GLuint baseInstance{};
+	};
+
+	typedef void (APIENTRYP DispatchComputeProc)(GLuint groupsX, GLuint groupsY, GLuint groupsZ);
+	typedef void (APIENTRYP MemoryBarrierProc)(GLbitfield barriers);
+	typedef void (APIENTRYP BindImageTextureProc)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+	typedef void (APIENTRYP TexStorage2DProc)(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height);
+	typedef void (APIENTRYP ClearBufferDataProc)(GLenum target, GLenum internalFormat, GLenum format, GLenum type, const void* data);
+	typedef void (APIENTRYP MultiDrawArraysIndirectProc)(GLenum mode, const void* indirect, GLsizei drawCount, GLsizei stride);
+	static inline DispatchComputeProc s_dispatchCompute{ nullptr };
+	static inline MemoryBarrierProc s_memoryBarrier{ nullptr };
+	static inline BindImageTextureProc s_bindImageTexture{ nullptr };
+	static inline TexStorage2DProc s_texStorage2D{ nullptr };
+	static inline ClearBufferDataProc s_clearBufferData{ nullptr };
+	static inline MultiDrawArraysIndirectProc s_multiDrawArraysIndirect{ nullptr };
+
+	Shader m_cullShader;
+	Shader m_pyramidShader;
+
+	unsigned int m_objectBuffer{};
+	unsigned int m_commandBuffer{};
+	unsigned int m_counterBuffer{};
+	int m_capacity{ 0 };
+	int m_objectCount{ 0 };
+	std::uint64_t m_version{ ~std::uint64_t{ 0 } };
+
+	unsigned int m_pyramid{ 0 };
+	int m_pyramidWidth{ 0 };
+	int m_pyramidHeight{ 0 };
+	int m_pyramidLevels{ 0 };
+	bool m_pyramidValid{ false };
+	glm::mat4 m_cullViewProjection{ 1.0f };
+	glm::mat4 m_pyramidViewProjection{ 1.0f };
+
+	// Every material gets room for a command per object, so the commands are regrown with the objects
+	void reserve(int count)
+	{
+		m_capacity = std::max(count, m_capacity * 2);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(sizeof(CullObject)) * m_capacity, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(sizeof(DrawArraysIndirectCommand)) * CullObject::maxMaterials * m_capacity, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		// The new object buffer is empty, force an upload
+		m_objectCount = -1;
+	}
+
+	void createPyramid(int width, int height)
+	{
+		glDeleteTextures(1, &m_pyramid);
+
+		m_pyramidWidth = width;
+		m_pyramidHeight = height;
+		m_pyramidLevels = 1;
+		while ((std::max(width, height) >> m_pyramidLevels) > 0)
+			++m_pyramidLevels;
+
+		glGenTextures(1, &m_pyramid);
+		glBindTexture(GL_TEXTURE_2D, m_pyramid);
+		s_texStorage2D(GL_TEXTURE_2D, m_pyramidLevels, GL_R32F, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+* File: particle_renderer.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program draws the particle system's instances as camera-facing
+			   billboards straight from the stream buffer, one instanced draw for
+			   all particles, blended over the scene without writing depth
+*/
+
+#ifndef PARTICLE_RENDERER_H
+#define PARTICLE_RENDERER_H
+
+#include "particle_system.h"
+#include "stream_buffer.h"
+#include "../io/asset_archive.h"
+#include "../shader/shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+class ParticleRenderer
+{
+public:
+	/*
+	* Compiles the billboard shader and creates the vertex array for the instances
+	* Parameters:
+	* - assets: Loader the shader sources are read from
+	* Returns: ParticleRenderer object
+	*/
+	explicit ParticleRenderer(const AssetLoader& assets)
+		: m_shader{ assets, "source/shader/particle.vs", "source/shader/particle.fs" }
+	{
+		// The quad has no vertex data, its corners come from gl_VertexID
+		glGenVertexArrays(1, &m_vao);
+		glBindVertexArray(m_vao);
+		glEnableVertexAttribArray(0);
+		glVertexAttribDivisor(0, 1);
+		glEnableVertexAttribArray(1);
+		glVertexAttribDivisor(1, 1);
+		glBindVertexArray(0);
+	}
+
+	~ParticleRenderer()
+	{
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteProgram(m_shader.shaderProgram);
+	}
+
+	ParticleRenderer(const ParticleRenderer&) = delete;
+	ParticleRenderer& operator=(const ParticleRenderer&) = delete;
+
+	/*
+	* Draws the instances written into a stream buffer allocation
+	* Parameters:
+	* - stream: Stream buffer holding the allocation
+	* - allocation: Allocation filled by ParticleSystem::writeInstances
+	* - count: Number of instances in the allocation
+	* - projection: Projection matrix of the camera
+	* - view: View matrix of the camera
+	* Returns: void
+	*/
+	void draw(const StreamBuffer& stream, const StreamAllocation& allocation, int count, const glm::mat4& projection, const glm::mat4& view)
+	{
+		if (!allocation.data || count <= 0)
+			return;
+
+		m_shader.use();
+		m_shader.setMat4("projection", projection);
+		m_shader.setMat4("view", view);
+
+		glBindVertexArray(m_vao);
+		glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+		const std::size_t offset{ static_cast<std::size_t>(allocation.offset) };
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)(offset + offsetof(ParticleInstance, position)));
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ParticleInstance), (void*)(offset + offsetof(ParticleInstance, color)));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		// Colours are premultiplied by alpha, and particles don't hide each other
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		glDepthMask(GL_FALSE);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+		glDepthMask(GL_TRUE);
+		glDisable(GL_BLEND);
+		glBindVertexArray(0);
+	}
+
+private:
+	Shader m_shader;
+	unsigned int m_vao{};
+};
+
+#endif
@@ -0,0 +1,418 @@
+/*
+* File: particle_system.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program simulates particles stored as a structure of arrays, one
+			   array per component, so they can be integrated several at a time with
+			   AVX or SSE and a scalar fallback. Particles live in fixed size pages
+			   that each belong to one effect, the pages are updated in parallel on
+			   the job system and written out as billboard instances for rendering
+*/
+
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include "../job/job_system.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PARTICLE_SYSTEM_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_SYSTEM_SSE
+#endif
+
+// How an effect's particles are spawned, move and look
+struct ParticleEffect
+{
+	glm::vec3 velocityMin{};
+	glm::vec3 velocityMax{};
+	// Random horizontal offset from the spawn position
+	float spread{ 0.5f };
+	float lifetimeMin{ 1.0f };
+	float lifetimeMax{ 2.0f };
+	// Vertical acceleration, negative falls and positive rises
+	float gravity{ 0.0f };
+	// Rate at which the velocity settles to the wind
+	float drag{ 0.0f };
+	float size{ 0.1f };
+	// Particles fade out over this many seconds before they die
+	float fadeTime{ 0.5f };
+	std::uint8_t color[4]{ 255, 255, 255, 255 };
+};
+
+// One camera-facing quad as read by the particle shader
+struct ParticleInstance
+{
+	float position[3]{};
+	float size{};
+	std::uint8_t color[4]{};
+};
+
+static_assert(sizeof(ParticleInstance) == 20, "Particle instances are read straight from the stream buffer");
+
+class ParticleSystem
+{
+public:
+	// Particles integrated per instruction
+#if defined(PARTICLE_SYSTEM_AVX)
+	static constexpr int simdWidth{ 8 };
+#elif defined(PARTICLE_SYSTEM_SSE)
+	static constexpr int simdWidth{ 4 };
+#else
+	static constexpr int simdWidth{ 1 };
+#endif
+
+	// Particles per page, the unit of work of one job
+	static constexpr int pageSize{ 16384 };
+	static_assert(pageSize % 8 == 0 && pageSize <= 65536, "Pages hold whole registers and 16-bit indices");
+
+	/*
+	* Allocates every array up front, nothing is allocated while simulating
+	* Parameters:
+	* - capacity: Most particles alive at once, rounded up to whole pages
+	* - seed: Seed of the spawn randomness, the same seed and time steps give the same particles
+	* Returns: ParticleSystem object
+	*/
+	explicit ParticleSystem(int capacity, std::uint32_t seed = 1337)
+		: m_pages(static_cast<std::size_t>(std::max(1, (capacity + pageSize - 1) / pageSize)))
+		, m_offsets(m_pages.size())
+		, m_random{ seed != 0 ? seed : 1u }
+	{
+		std::size_t floats{ m_pages.size() * pageSize };
+		m_memory = std::make_unique<float[]>(floats * streamCount + alignment / sizeof(float));
+		std::uintptr_t base{ reinterpret_cast<std::uintptr_t>(m_memory.get()) };
+		float* aligned{ reinterpret_cast<float*>((base + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1)) };
+		for (int stream{ 0 }; stream < streamCount; ++stream)
+			m_streams[stream] = aligned + stream * floats;
+	}
+
+	ParticleSystem(const ParticleSystem&) = delete;
+	ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+	/*
+	* Registers an effect particles can be spawned with
+	* Parameters:
+	* - effect: Spawn, motion and look of the particles
+	* Returns: Index to spawn the effect by
+	*/
+	int addEffect(const ParticleEffect& effect)
+	{
+		m_effects.push_back(effect);
+		return static_cast<int>(m_effects.size()) - 1;
+	}
+
+	/*
+	* Spawns particles of an effect around a position
+	* Parameters:
+	* - effect: Index returned by addEffect
+	* - position: World position the particles start from
+	* - count: Number of particles
+	* Returns: Number of particles spawned, fewer than count when the system is full
+	*/
+	int spawn(int effect, const glm::vec3& position, int count)
+	{
+		const ParticleEffect& settings{ m_effects[effect] };
+		int spawned{ 0 };
+		while (spawned < count)
+		{
+			int pageIndex{ findPage(effect) };
+			if (pageIndex < 0)
+				break;
+
+			Page& page{ m_pages[pageIndex] };
+			int batch{ std::min(count - spawned, pageSize - page.count) };
+			for (int i{ 0 }; i < batch; ++i)
+			{
+				std::size_t index{ static_cast<std::size_t>(pageIndex) * pageSize + page.count++ };
+				m_streams[positionX][index] = position.x + random(-settings.spread, settings.spread);
+				m_streams[positionY][index] = position.y;
+				m_streams[positionZ][index] = position.z + random(-settings.spread, settings.spread);
+				m_streams[velocityX][index] = random(settings.velocityMin.x, settings.velocityMax.x);
+				m_streams[velocityY][index] = random(settings.velocityMin.y, settings.velocityMax.y);
+				m_streams[velocityZ][index] = random(settings.velocityMin.z, settings.velocityMax.z);
+				m_streams[life][index] = random(settings.lifetimeMin, settings.lifetimeMax);
+			}
+			spawned += batch;
+			m_count += batch;
+		}
+		return spawned;
+	}
+
+	/*
+	* Moves every particle one time step and removes the ones that died, a page per job
+	* Parameters:
+	* - deltaTime: Seconds since the last update
+	* - wind: Velocity the particles drift towards, at the rate of their effect's drag
+	* - jobs: Job system the pages are updated on
+	* Returns: void
+	*/
+	void update(float deltaTime, const glm::vec3& wind, JobSystem& jobs)
+	{
+		jobs.parallelFor(0, static_cast<int>(m_pages.size()), 1, [this, deltaTime, &wind](int first, int last)
+			{
+				for (int page{ first }; page < last; ++page)
+					updatePage(page, deltaTime, wind);
+			});
+
+		m_count = 0;
+		for (Page& page : m_pages)
+		{
+			if (page.count == 0)
+				page.effect = -1;
+			m_count += page.count;
+		}
+	}
+
+	/*
+	* Writes every particle as a billboard instance, a page per job
+	* Parameters:
+	* - instances: Room for getCount() instances, usually mapped stream buffer memory
+	* - jobs: Job system the pages are written on
+	* Returns: void
+	*/
+	void writeInstances(ParticleInstance* instances, JobSystem& jobs)
+	{
+		int offset{ 0 };
+		for (std::size_t page{ 0 }; page < m_pages.size(); ++page)
+		{
+			m_offsets[page] = offset;
+			offset += m_pages[page].count;
+		}
+
+		jobs.parallelFor(0, static_cast<int>(m_pages.size()), 1, [this, instances](int first, int last)
+			{
+				for (int page{ first }; page < last; ++page)
+					writePage(page, instances + m_offsets[page]);
+			});
+	}
+
+	int getCount() const
+	{
+		return m_count;
+	}
+
+	int getCapacity() const
+	{
+		return static_cast<int>(m_pages.size()) * pageSize;
+	}
+
+private:
+	enum Stream
+	{
+		positionX,
+		positionY,
+		positionZ,
+		velocityX,
+		velocityY,
+		velocityZ,
+		// Seconds left to live
+		life,
+		streamCount,
+	};
+
+	// Stream alignment, enough for aligned AVX loads
+	static constexpr std::size_t alignment{ 32 };
+
+	struct Page
+	{
+		int effect{ -1 };
+		int count{ 0 };
+	};
+
+	std::unique_ptr<float[]> m_memory{};
+	float* m_streams[streamCount]{};
+	std::vector<Page> m_pages{};
+	std::vector<int> m_offsets{};
+	std::vector<ParticleEffect> m_effects{};
+	int m_count{ 0 };
+	std::uint32_t m_random{};
+
+	// A page of the effect with room left, or an unused page that is given to it
+	int findPage(int effect)
+	{
+		int unused{ -1 };
+		for (std::size_t page{ 0 }; page < m_pages.size(); ++page)
+		{
+			if (m_pages[page].effect == effect && m_pages[page].count < pageSize)
+				return static_cast<int>(page);
+			if (unused < 0 && m_pages[page].effect < 0)
+				unused = static_cast<int>(page);
+		}
+
+		if (unused >= 0)
+			m_pages[unused].effect = effect;
+		return unused;
+	}
+
+	// Uniform float in [min, max] from a xorshift generator
+	float random(float min, float max)
+	{
+		m_random ^= m_random << 13;
+		m_random ^= m_random >> 17;
+		m_random ^= m_random << 5;
+		return min + (max - min) * static_cast<float>(m_random >> 8) * (1.0f / 16777216.0f);
+	}
+
+	void updatePage(int pageIndex, float deltaTime, const glm::vec3& wind)
+	{
+		Page& page{ m_pages[pageIndex] };
+		if (page.count == 0)
+			return;
+
+		const ParticleEffect& effect{ m_effects[page.effect] };
+		std::size_t base{ static_cast<std::size_t>(pageIndex) * pageSize };
+		float* px{ m_streams[positionX] + base };
+		float* py{ m_streams[positionY] + base };
+		float* pz{ m_streams[positionZ] + base };
+		float* vx{ m_streams[velocityX] + base };
+		float* vy{ m_streams[velocityY] + base };
+		float* vz{ m_streams[velocityZ] + base };
+		float* left{ m_streams[life] + base };
+
+		// v += (wind - v) * drag * dt + gravity * dt, then p += v * dt
+		const float settle{ std::min(1.0f, effect.drag * deltaTime) };
+		const float fall{ effect.gravity * deltaTime };
+		const int count{ page.count };
+
+		// Indices of the particles that died, in ascending order
+		std::uint16_t dead[pageSize];
+		int deadCount{ 0 };
+		int i{ 0 };
+
+#if defined(PARTICLE_SYSTEM_AVX)
+		const __m256 dt8{ _mm256_set1_ps(deltaTime) };
+		const __m256 settle8{ _mm256_set1_ps(settle) };
+		const __m256 fall8{ _mm256_set1_ps(fall) };
+		const __m256 windX8{ _mm256_set1_ps(wind.x) };
+		const __m256 windY8{ _mm256_set1_ps(wind.y) };
+		const __m256 windZ8{ _mm256_set1_ps(wind.z) };
+		const __m256 zero8{ _mm256_setzero_ps() };
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 velocityX8{ _mm256_load_ps(vx + i) };
+			__m256 velocityY8{ _mm256_load_ps(vy + i) };
+			__m256 velocityZ8{ _mm256_load_ps(vz + i) };
+			velocityX8 = _mm256_add_ps(velocityX8, _mm256_mul_ps(_mm256_sub_ps(windX8, velocityX8), settle8));
+			velocityY8 = _mm256_add_ps(_mm256_add_ps(velocityY8, _mm256_mul_ps(_mm256_sub_ps(windY8, velocityY8), settle8)), fall8);
+			velocityZ8 = _mm256_add_ps(velocityZ8, _mm256_mul_ps(_mm256_sub_ps(windZ8, velocityZ8), settle8));
+			_mm256_store_ps(vx + i, velocityX8);
+			_mm256_store_ps(vy + i, velocityY8);
+			_mm256_store_ps(vz + i, velocityZ8);
+			_mm256_store_ps(px + i, _mm256_add_ps(_mm256_load_ps(px + i), _mm256_mul_ps(velocityX8, dt8)));
+			_mm256_store_ps(py + i, _mm256_add_ps(_mm256_load_ps(py + i), _mm256_mul_ps(velocityY8, dt8)));
+			_mm256_store_ps(pz + i, _mm256_add_ps(_mm256_load_ps(pz + i), _mm256_mul_ps(velocityZ8, dt8)));
+
+			__m256 life8{ _mm256_sub_ps(_mm256_load_ps(left + i), dt8) };
+			_mm256_store_ps(left + i, life8);
+			int mask{ _mm256_movemask_ps(_mm256_cmp_ps(life8, zero8, _CMP_LE_OQ)) };
+			for (int lane{ 0 }; mask != 0; ++lane, mask >>= 1)
+			{
+				if (mask & 1)
+					dead[deadCount++] = static_cast<std::uint16_t>(i + lane);
+			}
+		}
+#elif defined(PARTICLE_SYSTEM_SSE)
+		const __m128 dt4{ _mm_set1_ps(deltaTime) };
+		const __m128 settle4{ _mm_set1_ps(settle) };
+		const __m128 fall4{ _mm_set1_ps(fall) };
+		const __m128 windX4{ _mm_set1_ps(wind.x) };
+		const __m128 windY4{ _mm_set1_ps(wind.y) };
+		const __m128 windZ4{ _mm_set1_ps(wind.z) };
+		const __m128 zero4{ _mm_setzero_ps() };
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 velocityX4{ _mm_load_ps(vx + i) };
+			__m128 velocityY4{ _mm_load_ps(vy + i) };
+			__m128 velocityZ4{ _mm_load_ps(vz + i) };
+			velocityX4 = _mm_add_ps(velocityX4, _mm_mul_ps(_mm_sub_ps(windX4, velocityX4), settle4));
+			velocityY4 = _mm_add_ps(_mm_add_ps(velocityY4, _mm_mul_ps(_mm_sub_ps(windY4, velocityY4), settle4)), fall4);
+			velocityZ4 = _mm_add_ps(velocityZ4, _mm_mul_ps(_mm_sub_ps(windZ4, velocityZ4), settle4));
+			_mm_store_ps(vx + i, velocityX4);
+			_mm_store_ps(vy + i, velocityY4);
+			_mm_store_ps(vz + i, velocityZ4);
+			_mm_store_ps(px + i, _mm_add_ps(_mm_load_ps(px + i), _mm_mul_ps(velocityX4, dt4)));
+			_mm_store_ps(py + i, _mm_add_ps(_mm_load_ps(py + i), _mm_mul_ps(velocityY4, dt4)));
+			_mm_store_ps(pz + i, _mm_add_ps(_mm_load_ps(pz + i), _mm_mul_ps(velocityZ4, dt4)));
+
+			__m128 life4{ _mm_sub_ps(_mm_load_ps(left + i), dt4) };
+			_mm_store_ps(left + i, life4);
+			int mask{ _mm_movemask_ps(_mm_cmple_ps(life4, zero4)) };
+			for (int lane{ 0 }; mask != 0; ++lane, mask >>= 1)
+			{
+				if (mask & 1)
+					dead[deadCount++] = static_cast<std::uint16_t>(i + lane);
+			}
+		}
+#endif
+
+		// The scalar fallback, and the remainder that doesn't fill a whole register
+		for (; i < count; ++i)
+		{
+			vx[i] += (wind.x - vx[i]) * settle;
+			vy[i] += (wind.y - vy[i]) * settle + fall;
+			vz[i] += (wind.z - vz[i]) * settle;
+			px[i] += vx[i] * deltaTime;
+			py[i] += vy[i] * deltaTime;
+			pz[i] += vz[i] * deltaTime;
+			left[i] -= deltaTime;
+			if (left[i] <= 0.0f)
+				dead[deadCount++] = static_cast<std::uint16_t>(i);
+		}
+
+		// Highest first, so the last particle moved into a hole is always alive
+		int alive{ count };
+		for (int d{ deadCount - 1 }; d >= 0; --d)
+		{
+			int hole{ dead[d] };
+			--alive;
+			if (hole == alive)
+				continue;
+			for (float* stream : { px, py, pz, vx, vy, vz, left })
+				stream[hole] = stream[alive];
+		}
+		page.count = alive;
+	}
+
+	void writePage(int pageIndex, ParticleInstance* out) const
+	{
+		const Page& page{ m_pages[pageIndex] };
+		if (page.count == 0)
+			return;
+
+		const ParticleEffect& effect{ m_effects[page.effect] };
+		std::size_t base{ static_cast<std::size_t>(pageIndex) * pageSize };
+		const float* px{ m_streams[positionX] + base };
+		const float* py{ m_streams[positionY] + base };
+		const float* pz{ m_streams[positionZ] + base };
+		const float* left{ m_streams[life] + base };
+		// Constants are copied out of the effect, the output could alias it as far as the compiler knows
+		const float fade{ effect.fadeTime > 0.0f ? 1.0f / effect.fadeTime : 1.0e9f };
+		const float size{ effect.size };
+		const float alpha{ static_cast<float>(effect.color[3]) };
+		std::uint8_t color[4]{ effect.color[0], effect.color[1], effect.color[2], 0 };
+		const int count{ page.count };
+
+		for (int i{ 0 }; i < count; ++i)
+		{
+			ParticleInstance& instance{ out[i] };
+			instance.position[0] = px[i];
+			instance.position[1] = py[i];
+			instance.position[2] = pz[i];
+			instance.size = size;
+			color[3] = static_cast<std::uint8_t>(alpha * std::min(1.0f, left[i] * fade));
+			std::memcpy(instance.color, color, sizeof(color));
+		}
+	}
+};
+
+#endif
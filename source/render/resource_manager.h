@@ -0,0 +1,458 @@
+/*
+* File: resource_manager.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program hands out reference counted handles to textures, shaders
+			   and meshes. Each resource is keyed by its canonical path, so asking for
+			   the same file twice shares one GPU object. Nothing is loaded until a
+			   handle is first resolved, and a resource nobody holds is destroyed a
+			   while later unless it is asked for again in the meantime
+*/
+
+#ifndef RESOURCE_MANAGER_H
+#define RESOURCE_MANAGER_H
+
+#include "texture_manager.h"
+#include "../io/asset_archive.h"
+#include "../shader/shader.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A vertex array with the buffers it owns, indexed when the element buffer is set
+struct Mesh
+{
+	unsigned int vertexArray{};
+	unsigned int vertexBuffer{};
+	unsigned int elementBuffer{};
+	int count{};
+};
+
+template <typename Resource>
+class ResourcePool;
+
+/*
+* Shared ownership of one resource in a pool. Copies add a reference and the last
+* one to go hands the resource to the pool for deferred destruction
+*/
+template <typename Resource>
+class ResourceHandle
+{
+public:
+	ResourceHandle() = default;
+
+	ResourceHandle(const ResourceHandle& other)
+		: m_pool{ other.m_pool }
+		, m_slot{ other.m_slot }
+	{
+		if (m_pool)
+			m_pool->retain(m_slot);
+	}
+
+	ResourceHandle(ResourceHandle&& other) noexcept
+		: m_pool{ std::exchange(other.m_pool, nullptr) }
+		, m_slot{ std::exchange(other.m_slot, -1) }
+	{
+	}
+
+	ResourceHandle& operator=(ResourceHandle other) noexcept
+	{
+		std::swap(m_pool, other.m_pool);
+		std::swap(m_slot, other.m_slot);
+		return *this;
+	}
+
+	~ResourceHandle()
+	{
+		if (m_pool)
+			m_pool->release(m_slot);
+	}
+
+	bool isValid() const
+	{
+		return m_pool != nullptr;
+	}
+
+private:
+	friend class ResourcePool<Resource>;
+
+	ResourcePool<Resource>* m_pool{ nullptr };
+	int m_slot{ -1 };
+
+	ResourceHandle(ResourcePool<Resource>* pool, int slot)
+		: m_pool{ pool }
+		, m_slot{ slot }
+	{
+	}
+};
+
+/*
+* Resources of one type by key. Slots are reused once a resource is destroyed, handles
+* keep the pool's address so the pool must outlive them
+*/
+template <typename Resource>
+class ResourcePool
+{
+public:
+	using Loader = std::function<Resource(const std::string& key)>;
+	using Destroyer = std::function<void(Resource& resource)>;
+
+	/*
+	* Creates an empty pool
+	* Parameters:
+	* - load: Creates the resource for a key, called the first time a handle is resolved
+	* - destroy: Frees a loaded resource
+	* Returns: ResourcePool object
+	*/
+	ResourcePool(Loader load, Destroyer destroy)
+		: m_load{ std::move(load) }
+		, m_destroy{ std::move(destroy) }
+	{
+	}
+
+	~ResourcePool()
+	{
+		for (Entry& entry : m_entries)
+		{
+			if (entry.loaded)
+				m_destroy(entry.resource);
+		}
+	}
+
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	/*
+	* Gets a handle to the resource with the key without loading it. A key that is
+	* already known shares its entry, even one waiting to be destroyed
+	* Parameters:
+	* - key: Canonical key of the resource
+	* Returns: Handle holding a reference to the resource
+	*/
+	ResourceHandle<Resource> acquire(const std::string& key)
+	{
+		auto found{ m_slots.find(key) };
+		int slot{};
+		if (found != m_slots.end())
+		{
+			slot = found->second;
+		}
+		else
+		{
+			if (m_free.empty())
+			{
+				slot = static_cast<int>(m_entries.size());
+				m_entries.emplace_back();
+			}
+			else
+			{
+				slot = m_free.back();
+				m_free.pop_back();
+			}
+			m_entries[slot].key = key;
+			m_slots.emplace(key, slot);
+		}
+
+		retain(slot);
+		return ResourceHandle<Resource>{ this, slot };
+	}
+
+	/*
+	* Resolves a handle, loading the resource on first use
+	* Parameters:
+	* - handle: Valid handle from this pool
+	* Returns: Reference to the resource, valid until the next acquire or collect
+	*/
+	Resource& get(const ResourceHandle<Resource>& handle)
+	{
+		Entry& entry{ m_entries[handle.m_slot] };
+		if (!entry.loaded)
+		{
+			entry.resource = m_load(entry.key);
+			entry.loaded = true;
+			++m_loads;
+		}
+		return entry.resource;
+	}
+
+	/*
+	* Destroys resources that have had no references for longer than the delay
+	* Parameters:
+	* - frame: Current frame number
+	* - delayFrames: Frames an unreferenced resource is kept in case it is asked for again
+	* Returns: void
+	*/
+	void collect(std::uint64_t frame, std::uint64_t delayFrames)
+	{
+		for (int slot{ 0 }; slot < static_cast<int>(m_entries.size()); ++slot)
+		{
+			Entry& entry{ m_entries[slot] };
+			if (entry.references > 0 || entry.key.empty() || entry.releasedFrame + delayFrames > frame)
+				continue;
+
+			if (entry.loaded)
+				m_destroy(entry.resource);
+			m_slots.erase(entry.key);
+			entry = Entry{};
+			m_free.push_back(slot);
+		}
+	}
+
+	// Stamps newly released resources, they become collectable from this frame on
+	void setFrame(std::uint64_t frame)
+	{
+		m_frame = frame;
+	}
+
+	// Resources loaded since the pool was created
+	std::uint64_t getLoadCount() const
+	{
+		return m_loads;
+	}
+
+	// Resources loaded and not destroyed yet, referenced or not
+	int getLoadedCount() const
+	{
+		int count{ 0 };
+		for (const Entry& entry : m_entries)
+			count += entry.loaded ? 1 : 0;
+		return count;
+	}
+
+private:
+	friend class ResourceHandle<Resource>;
+
+	struct Entry
+	{
+		std::string key{};
+		Resource resource{};
+		bool loaded{ false };
+		int references{ 0 };
+		std::uint64_t releasedFrame{};
+	};
+
+	Loader m_load;
+	Destroyer m_destroy;
+	std::vector<Entry> m_entries{};
+	std::vector<int> m_free{};
+	std::unordered_map<std::string, int> m_slots{};
+	std::uint64_t m_frame{ 0 };
+	std::uint64_t m_loads{ 0 };
+
+	void retain(int slot)
+	{
+		++m_entries[slot].references;
+	}
+
+	void release(int slot)
+	{
+		Entry& entry{ m_entries[slot] };
+		if (--entry.references == 0)
+			entry.releasedFrame = m_frame;
+	}
+};
+
+using TextureResource = ResourceHandle<TextureHandle>;
+using ShaderResource = ResourceHandle<std::unique_ptr<Shader>>;
+using MeshResource = ResourceHandle<Mesh>;
+
+class ResourceManager
+{
+public:
+	// Frames an unreferenced resource survives, long enough for every frame in flight to finish with it
+	static constexpr std::uint64_t destroyDelayFrames{ 300 };
+
+	/*
+	* Creates the manager on top of the loaders that do the actual work
+	* Parameters:
+	* - assets: Asset loader shader sources are read through
+	* - textures: Texture manager that decodes and streams the textures
+	* Returns: ResourceManager object
+	*/
+	ResourceManager(const AssetLoader& assets, TextureManager& textures)
+		: m_textures{ [&textures](const std::string& key) { return loadTexture(textures, key); },
+			[&textures](TextureHandle& texture) { textures.release(texture); } }
+		, m_shaders{ [&assets](const std::string& key) { return loadShader(assets, key); },
+			[](std::unique_ptr<Shader>& shader) { glDeleteProgram(shader->shaderProgram); } }
+		, m_meshes{ [this](const std::string& name) { return buildMesh(name); },
+			[](Mesh& mesh) { destroyMesh(mesh); } }
+	{
+	}
+
+	ResourceManager(const ResourceManager&) = delete;
+	ResourceManager& operator=(const ResourceManager&) = delete;
+
+	/*
+	* Gets a handle to an image, decoded on first use
+	* Parameters:
+	* - path: Char pointer to the image file path
+	* Returns: Handle to the texture
+	*/
+	TextureResource texture(const char* path)
+	{
+		return m_textures.acquire(canonicalPath(path));
+	}
+
+	/*
+	* Gets a handle to a 1x1 texture of a single color, for materials missing a texture
+	* Parameters:
+	* - r: Red channel value
+	* - g: Green channel value
+	* - b: Blue channel value
+	* Returns: Handle to the texture
+	*/
+	TextureResource solidTexture(unsigned char r, unsigned char g, unsigned char b)
+	{
+		// No path has this prefix, so solid colors share entries only with each other
+		char key[32]{};
+		std::snprintf(key, sizeof(key), "%s%u,%u,%u", solidPrefix, r, g, b);
+		return m_textures.acquire(key);
+	}
+
+	/*
+	* Gets a handle to a vertex and fragment shader pair, compiled on first use
+	* Parameters:
+	* - vertexPath: Char pointer to the vertex shader file path
+	* - fragmentPath: Char pointer to the fragment shader file path
+	* Returns: Handle to the shader
+	*/
+	ShaderResource shader(const char* vertexPath, const char* fragmentPath)
+	{
+		return m_shaders.acquire(canonicalPath(vertexPath) + shaderKeySeparator + canonicalPath(fragmentPath));
+	}
+
+	/*
+	* Registers how to build a mesh that has no file, keyed by name
+	* Parameters:
+	* - name: Char pointer to the mesh name
+	* - build: Callable returning the mesh, kept until the manager goes
+	* Returns: void
+	*/
+	void defineMesh(const char* name, std::function<Mesh()> build)
+	{
+		m_meshBuilders[name] = std::move(build);
+	}
+
+	/*
+	* Gets a handle to a mesh defined with defineMesh, built on first use
+	* Parameters:
+	* - name: Char pointer to the mesh name
+	* Returns: Handle to the mesh
+	*/
+	MeshResource mesh(const char* name)
+	{
+		return m_meshes.acquire(name);
+	}
+
+	// Resolves a handle, loading the resource the first time
+	TextureHandle get(const TextureResource& handle)
+	{
+		return m_textures.get(handle);
+	}
+
+	Shader& get(const ShaderResource& handle)
+	{
+		return *m_shaders.get(handle);
+	}
+
+	const Mesh& get(const MeshResource& handle)
+	{
+		return m_meshes.get(handle);
+	}
+
+	/*
+	* Destroys resources that have gone unreferenced for destroyDelayFrames. Call once
+	* per frame after drawing
+	* Parameters: None
+	* Returns: void
+	*/
+	void collect()
+	{
+		m_textures.collect(m_frame, destroyDelayFrames);
+		m_shaders.collect(m_frame, destroyDelayFrames);
+		m_meshes.collect(m_frame, destroyDelayFrames);
+
+		++m_frame;
+		m_textures.setFrame(m_frame);
+		m_shaders.setFrame(m_frame);
+		m_meshes.setFrame(m_frame);
+	}
+
+	// Resources of every type loaded since startup, loading allocates so frames that do are not steady
+	std::uint64_t getLoadCount() const
+	{
+		return m_textures.getLoadCount() + m_shaders.getLoadCount() + m_meshes.getLoadCount();
+	}
+
+	int getLoadedCount() const
+	{
+		return m_textures.getLoadedCount() + m_shaders.getLoadedCount() + m_meshes.getLoadedCount();
+	}
+
+private:
+	static constexpr char shaderKeySeparator{ '|' };
+	static constexpr const char* solidPrefix{ "solid:" };
+
+	// Builders outlive the pool's entries, so they are declared first
+	std::unordered_map<std::string, std::function<Mesh()>> m_meshBuilders{};
+	ResourcePool<TextureHandle> m_textures;
+	ResourcePool<std::unique_ptr<Shader>> m_shaders;
+	ResourcePool<Mesh> m_meshes;
+	std::uint64_t m_frame{ 0 };
+
+	// Same file, same key: "./a/../b.png" and "b.png" name one resource
+	static std::string canonicalPath(const char* path)
+	{
+		return std::filesystem::path{ path }.lexically_normal().generic_string();
+	}
+
+	static TextureHandle loadTexture(TextureManager& textures, const std::string& key)
+	{
+		unsigned int r{}, g{}, b{};
+		if (key.compare(0, std::strlen(solidPrefix), solidPrefix) == 0
+			&& std::sscanf(key.c_str() + std::strlen(solidPrefix), "%u,%u,%u", &r, &g, &b) == 3)
+			return textures.createSolid(static_cast<unsigned char>(r), static_cast<unsigned char>(g), static_cast<unsigned char>(b));
+		return textures.load(key.c_str());
+	}
+
+	static std::unique_ptr<Shader> loadShader(const AssetLoader& assets, const std::string& key)
+	{
+		std::size_t separator{ key.find(shaderKeySeparator) };
+		std::string vertexPath{ key.substr(0, separator) };
+		std::string fragmentPath{ key.substr(separator + 1) };
+		return std::make_unique<Shader>(assets, vertexPath.c_str(), fragmentPath.c_str());
+	}
+
+	Mesh buildMesh(const std::string& name)
+	{
+		auto found{ m_meshBuilders.find(name) };
+		if (found == m_meshBuilders.end())
+		{
+			std::cout << "ERROR::RESOURCE::MESH_NOT_DEFINED: " << name << '\n';
+			return Mesh{};
+		}
+		return found->second();
+	}
+
+	static void destroyMesh(Mesh& mesh)
+	{
+		glDeleteVertexArrays(1, &mesh.vertexArray);
+		glDeleteBuffers(1, &mesh.vertexBuffer);
+		if (mesh.elementBuffer)
+			glDeleteBuffers(1, &mesh.elementBuffer);
+	}
+};
+
+#endif
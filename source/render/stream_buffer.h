@@ -0,0 +1,236 @@
+/*
+* File: stream_buffer.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program defines a triple-buffered streaming buffer for transient
+			   per-frame GPU data. It maps the buffer persistently when
+			   glBufferStorage is available and falls back to orphaning on GL 3.3
+*/
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+// A slice of the current frame's region, valid until the next beginFrame
+struct StreamAllocation
+{
+	void* data{ nullptr };
+	GLintptr offset{};
+	GLsizeiptr size{};
+};
+
+class StreamBuffer
+{
+public:
+	static constexpr int frameCount{ 3 };
+
+	/*
+	* Resolves glBufferStorage, which the GL 3.3 loader does not provide
+	* Parameters:
+	* - load: Function used to look up GL entry points
+	* Returns: void
+	*/
+	static void loadExtensions(GLADloadproc load)
+	{
+		if (hasBufferStorageExtension())
+			s_bufferStorage = reinterpret_cast<BufferStorageProc>(load("glBufferStorage"));
+	}
+
+	/*
+	* Creates the buffer with one region per frame in flight
+	* Parameters:
+	* - frameSize: Bytes available for allocations each frame
+	* Returns: StreamBuffer object
+	*/
+	explicit StreamBuffer(std::size_t frameSize)
+		: m_frameSize{ frameSize }
+	{
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+		if (s_bufferStorage)
+		{
+			const GLbitfield flags{ GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+			s_bufferStorage(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_frameSize * frameCount), nullptr, flags);
+			m_persistent = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(m_frameSize * frameCount), flags));
+			if (!m_persistent)
+			{
+				// Immutable storage can't be respecified, so start over with a mutable buffer
+				std::cout << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED\n";
+				glDeleteBuffers(1, &buffer);
+				glGenBuffers(1, &buffer);
+				glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			}
+		}
+
+		if (!m_persistent)
+			glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_frameSize), nullptr, GL_STREAM_DRAW);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	~StreamBuffer()
+	{
+		for (GLsync& fence : m_fences)
+		{
+			if (fence)
+				glDeleteSync(fence);
+		}
+
+		if (m_persistent)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &buffer);
+	}
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	bool isPersistent() const
+	{
+		return m_persistent != nullptr;
+	}
+
+	/*
+	* Makes the next frame's region writable. On the persistent path it waits on the
+	* fence placed when the GPU was last handed this region, which with three frames
+	* in flight has normally already signaled. The fallback orphans the buffer instead
+	* Parameters: None
+	* Returns: void
+	*/
+	void beginFrame()
+	{
+		m_used.store(0, std::memory_order_relaxed);
+
+		if (m_persistent)
+		{
+			m_frame = (m_frame + 1) % frameCount;
+
+			GLsync& fence{ m_fences[m_frame] };
+			if (fence)
+			{
+				GLenum result{ glClientWaitSync(fence, 0, 0) };
+				while (result == GL_TIMEOUT_EXPIRED)
+					result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+				glDeleteSync(fence);
+				fence = nullptr;
+			}
+
+			m_frameData = m_persistent + m_frame * m_frameSize;
+		}
+		else
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_frameSize), nullptr, GL_STREAM_DRAW);
+			m_frameData = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(m_frameSize), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+	}
+
+	/*
+	* Reserves space in the current frame's region. Safe to call from worker threads
+	* between beginFrame and flush
+	* Parameters:
+	* - size: Number of bytes to reserve
+	* - alignment: Required alignment of the offset, must be a power of two
+	* Returns: Allocation with a null data pointer if the frame's region is exhausted
+	*/
+	StreamAllocation allocate(std::size_t size, std::size_t alignment = 16)
+	{
+		if (!m_frameData)
+			return StreamAllocation{};
+
+		std::size_t used{ m_used.load(std::memory_order_relaxed) };
+		std::size_t start{};
+		do
+		{
+			start = (used + alignment - 1) & ~(alignment - 1);
+			if (start + size > m_frameSize)
+				return StreamAllocation{};
+		} while (!m_used.compare_exchange_weak(used, start + size, std::memory_order_relaxed));
+
+		std::size_t regionStart{ m_persistent ? m_frame * m_frameSize : 0 };
+		return StreamAllocation{ m_frameData + start, static_cast<GLintptr>(regionStart + start), static_cast<GLsizeiptr>(size) };
+	}
+
+	/*
+	* Makes the frame's writes visible to the GPU, must be called before drawing with them.
+	* Coherent persistent mappings need no flush, the fallback unmaps its buffer
+	* Parameters: None
+	* Returns: void
+	*/
+	void flush()
+	{
+		if (m_persistent || !m_frameData)
+			return;
+
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		m_frameData = nullptr;
+	}
+
+	/*
+	* Fences the frame's region once all draws reading from it are submitted
+	* Parameters: None
+	* Returns: void
+	*/
+	void endFrame()
+	{
+		if (m_persistent)
+			m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	unsigned int buffer{};
+
+private:
+	typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+	static inline BufferStorageProc s_bufferStorage{ nullptr };
+
+	std::size_t m_frameSize{};
+	std::atomic<std::size_t> m_used{ 0 };
+	int m_frame{ 0 };
+
+	unsigned char* m_persistent{ nullptr };
+	unsigned char* m_frameData{ nullptr };
+	GLsync m_fences[frameCount]{};
+
+	static bool hasBufferStorageExtension()
+	{
+		int major{}, minor{};
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		glGetIntegerv(GL_MINOR_VERSION, &minor);
+		if (major > 4 || (major == 4 && minor >= 4))
+			return true;
+
+		int count{};
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i{ 0 }; i < count; ++i)
+		{
+			const char* name{ reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)) };
+			if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0)
+				return true;
+		}
+		return false;
+	}
+};
+
+#endif
@@ -0,0 +1,542 @@
+/*
+* File: texture_manager.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program keeps textures within a video memory budget. The full mip
+			   chain of every texture stays in system memory and only the levels the
+			   screen needs are resident on the GPU, finer levels are streamed in on
+			   demand through pixel unpack buffers and the least recently used
+			   textures give theirs up first. Images are decoded on the job system
+			   and drawn as a grey placeholder until they are ready
+*/
+
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include "texture_upload_queue.h"
+#include "../io/asset_archive.h"
+#include "../job/job_system.h"
+#include "../memory/linear_arena.h"
+
+#include <glad/glad.h>
+
+#include "../../external/stbi/stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Index of a managed texture, stays valid until the texture is released
+using TextureHandle = int;
+
+class TextureManager
+{
+public:
+	// Levels this size and smaller are always resident so a texture never goes missing
+	static constexpr int tailSize{ 16 };
+
+	/*
+	* Creates an empty manager
+	* Parameters:
+	* - jobs: Job system the images are decoded on
+	* - assets: Asset loader the images are read through
+	* - budgetBytes: Video memory the textures may use together
+	* - uploadBytesPerFrame: Most texel data streamed to the GPU in one frame, also the size of each staging buffer.
+	*   Both are raised to the largest level of any loaded texture, a level over them would never go up
+	* Returns: TextureManager object
+	*/
+	TextureManager(JobSystem& jobs, const AssetLoader& assets, std::size_t budgetBytes, std::size_t uploadBytesPerFrame = 4 * 1024 * 1024)
+		: m_jobs{ jobs }
+		, m_assets{ assets }
+		, m_budget{ budgetBytes }
+		, m_uploadBytesPerFrame{ uploadBytesPerFrame }
+		, m_uploadQueue{ uploadBytesPerFrame }
+	{
+	}
+
+	~TextureManager()
+	{
+		m_jobs.wait(m_decoding);
+
+		for (Texture& texture : m_textures)
+			glDeleteTextures(1, &texture.name);
+	}
+
+	TextureManager(const TextureManager&) = delete;
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	/*
+	* Starts decoding an image and building its mip chain on the job system. The handle
+	* draws a grey placeholder until update picks up the result, then only the tail levels
+	* go to the GPU until the texture is requested
+	* Parameters:
+	* - path: Char pointer to the image file path
+	* Returns: Handle of the texture, black once decoded if the file could not be read
+	*/
+	TextureHandle load(const char* path)
+	{
+		Texture placeholder{};
+		placeholder.levels.push_back(Level{ 1, 1, std::vector<unsigned char>{ 128, 128, 128, 255 } });
+		placeholder.loadId = ++m_nextLoadId;
+		TextureHandle handle{ add(std::move(placeholder)) };
+
+		m_jobs.runBackground([this, path = std::string{ path }, handle, loadId = m_nextLoadId]()
+			{
+				auto decoded{ std::make_unique<Decoded>() };
+				decoded->handle = handle;
+				decoded->loadId = loadId;
+				decoded->levels = decode(path.c_str());
+
+				std::lock_guard<std::mutex> lock{ m_decodedMutex };
+				m_decoded.push_back(std::move(decoded));
+			}, &m_decoding);
+
+		return handle;
+	}
+
+	/*
+	* Creates a 1x1 texture of a single color, for materials missing a texture
+	* Parameters:
+	* - r: Red channel value
+	* - g: Green channel value
+	* - b: Blue channel value
+	* Returns: Handle of the texture
+	*/
+	TextureHandle createSolid(unsigned char r, unsigned char g, unsigned char b)
+	{
+		Texture texture{};
+		texture.levels.push_back(Level{ 1, 1, std::vector<unsigned char>{ r, g, b, 255 } });
+		return add(std::move(texture));
+	}
+
+	/*
+	* Frees a texture's GPU memory and mip chain, its handle may be reused by a later load
+	* Parameters:
+	* - handle: Texture to free, must not be drawn again
+	* Returns: void
+	*/
+	void release(TextureHandle handle)
+	{
+		Texture& texture{ m_textures[handle] };
+		glDeleteTextures(1, &texture.name);
+		for (int level{ texture.residentLevel }; level < static_cast<int>(texture.levels.size()); ++level)
+			m_resident -= levelBytes(texture.levels[level]);
+
+		// An empty texture has nothing resident or desired, so residency passes step over it
+		texture = Texture{};
+		m_freeHandles.push_back(handle);
+	}
+
+	/*
+	* Reports how large the texture appears on screen this frame, the finest level
+	* requested during a frame is the one streamed in
+	* Parameters:
+	* - handle: Texture being drawn
+	* - screenSize: Approximate size in pixels the whole texture covers on screen
+	* Returns: void
+	*/
+	void request(TextureHandle handle, float screenSize)
+	{
+		Texture& texture{ m_textures[handle] };
+		int level{ texture.tailLevel };
+		if (screenSize > 0.0f)
+		{
+			// One texel per pixel, sharper than that is wasted memory
+			float texelsPerPixel{ static_cast<float>(texture.levels[0].width) / screenSize };
+			level = texelsPerPixel <= 1.0f ? 0 : static_cast<int>(std::floor(std::log2(texelsPerPixel)));
+		}
+
+		texture.requestedLevel = std::min({ texture.requestedLevel, level, texture.tailLevel });
+		texture.lastUsed = m_frame;
+	}
+
+	/*
+	* Binds the texture to a texture unit and marks it as used this frame. Textures
+	* that are bound but never requested stay at their tail levels
+	* Parameters:
+	* - handle: Texture to bind
+	* - unit: Texture unit index
+	* Returns: void
+	*/
+	void bind(TextureHandle handle, int unit)
+	{
+		Texture& texture{ m_textures[handle] };
+		texture.lastUsed = m_frame;
+
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, texture.name);
+	}
+
+	/*
+	* Moves residency towards the requested levels: evicts least recently used levels
+	* while over budget, then streams in the finest missing levels the budget allows.
+	* Call once per frame after drawing
+	* Parameters: None
+	* Returns: void
+	*/
+	void update()
+	{
+		finishDecodes();
+
+		for (Texture& texture : m_textures)
+		{
+			// Requests last one frame, textures unused for a while drift back to their tail
+			if (texture.lastUsed == m_frame)
+				texture.desiredLevel = texture.requestedLevel;
+			else if (texture.lastUsed + evictDelayFrames < m_frame)
+				texture.desiredLevel = texture.tailLevel;
+			texture.requestedLevel = texture.tailLevel;
+		}
+
+		evictOverBudget();
+		streamIn();
+
+		++m_frame;
+	}
+
+	std::size_t getResidentBytes() const
+	{
+		return m_resident;
+	}
+
+	std::size_t getBudget() const
+	{
+		return m_budget;
+	}
+
+	void setBudget(std::size_t budgetBytes)
+	{
+		m_budget = budgetBytes;
+	}
+
+	// Finest level of the texture currently on the GPU
+	int getResidentLevel(TextureHandle handle) const
+	{
+		return m_textures[handle].residentLevel;
+	}
+
+	// True while images are being decoded or wait for update to pick them up
+	bool isDecoding()
+	{
+		if (!m_decoding.isDone())
+			return true;
+
+		std::lock_guard<std::mutex> lock{ m_decodedMutex };
+		return !m_decoded.empty();
+	}
+
+private:
+	// Frames a texture may go unused before its finer levels are dropped even under budget
+	static constexpr std::uint64_t evictDelayFrames{ 300 };
+
+	struct Level
+	{
+		int width{};
+		int height{};
+		std::vector<unsigned char> pixels{};
+	};
+
+	struct Texture
+	{
+		unsigned int name{};
+		std::vector<Level> levels{};
+		int residentLevel{};
+		int tailLevel{};
+		int desiredLevel{};
+		int requestedLevel{};
+		std::uint64_t lastUsed{};
+		// Load the texture was created by, a decode finishing for an older one is dropped
+		std::uint64_t loadId{ 0 };
+	};
+
+	// Mip chain decoded by a job, waiting for the GL thread
+	struct Decoded
+	{
+		TextureHandle handle{};
+		std::uint64_t loadId{};
+		std::vector<Level> levels{};
+	};
+
+	JobSystem& m_jobs;
+	const AssetLoader& m_assets;
+	std::vector<Texture> m_textures{};
+	std::vector<TextureHandle> m_freeHandles{};
+	std::size_t m_budget{};
+	std::size_t m_uploadBytesPerFrame{};
+	TextureUploadQueue m_uploadQueue;
+	std::size_t m_resident{ 0 };
+	std::uint64_t m_frame{ 1 };
+
+	std::uint64_t m_nextLoadId{ 0 };
+	JobCounter m_decoding{};
+	std::mutex m_decodedMutex{};
+	std::vector<std::unique_ptr<Decoded>> m_decoded{};
+	// Swapped with m_decoded, so both keep their capacity
+	std::vector<std::unique_ptr<Decoded>> m_finishing{};
+
+	TextureHandle add(Texture texture)
+	{
+		prepare(texture);
+
+		if (!m_freeHandles.empty())
+		{
+			TextureHandle handle{ m_freeHandles.back() };
+			m_freeHandles.pop_back();
+			m_textures[handle] = std::move(texture);
+			return handle;
+		}
+
+		m_textures.push_back(std::move(texture));
+		return static_cast<TextureHandle>(m_textures.size()) - 1;
+	}
+
+	// Creates the GL texture of a mip chain and uploads its tail
+	void prepare(Texture& texture)
+	{
+		m_uploadBytesPerFrame = std::max(m_uploadBytesPerFrame, levelBytes(texture.levels[0]));
+		m_uploadQueue.reserve(m_uploadBytesPerFrame);
+
+		texture.tailLevel = 0;
+		while (texture.tailLevel + 1 < static_cast<int>(texture.levels.size())
+			&& std::max(texture.levels[texture.tailLevel].width, texture.levels[texture.tailLevel].height) > tailSize)
+			++texture.tailLevel;
+
+		texture.residentLevel = static_cast<int>(texture.levels.size());
+		texture.desiredLevel = texture.tailLevel;
+		texture.requestedLevel = texture.tailLevel;
+
+		glGenTextures(1, &texture.name);
+		glBindTexture(GL_TEXTURE_2D, texture.name);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture.levels.size() > 1 ? GL_LINEAR : GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.levels.size()) - 1);
+
+		// The tail is uploaded right away and never evicted, it is small enough to go straight from client memory
+		while (texture.residentLevel > texture.tailLevel)
+			uploadLevel(texture, texture.residentLevel - 1);
+	}
+
+	// Runs on a job: decodes an image into its full mip chain, a black texel if it can't be read
+	std::vector<Level> decode(const char* path) const
+	{
+		// Decoded straight from the asset view, the file is never copied
+		Asset file{ m_assets.open(path) };
+		int width{}, height{}, nrChannels{};
+		unsigned char* data{ nullptr };
+		if (file.isValid())
+			data = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &nrChannels, 4);
+
+		std::vector<Level> levels{};
+		if (!data)
+		{
+			std::cout << "Texture failed to load at path: " << path << '\n';
+			levels.push_back(Level{ 1, 1, std::vector<unsigned char>{ 0, 0, 0, 255 } });
+			return levels;
+		}
+
+		// Flipped here rather than by stb_image, whose flip setting is shared by every thread
+		std::size_t rowBytes{ static_cast<std::size_t>(width) * 4 };
+		levels.push_back(Level{ width, height, std::vector<unsigned char>(rowBytes * height) });
+		for (int y{ 0 }; y < height; ++y)
+			std::copy(data + y * rowBytes, data + (y + 1) * rowBytes, levels[0].pixels.begin() + (height - 1 - y) * rowBytes);
+		stbi_image_free(data);
+
+		while (levels.back().width > 1 || levels.back().height > 1)
+			levels.push_back(downsample(levels.back()));
+		return levels;
+	}
+
+	// Replaces the placeholders of the textures whose decode has finished
+	void finishDecodes()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_decodedMutex };
+			std::swap(m_decoded, m_finishing);
+		}
+
+		for (std::unique_ptr<Decoded>& decoded : m_finishing)
+		{
+			Texture& texture{ m_textures[decoded->handle] };
+			// Released while it was decoding, the handle may already belong to another texture
+			if (texture.loadId != decoded->loadId)
+				continue;
+
+			glDeleteTextures(1, &texture.name);
+			for (int level{ texture.residentLevel }; level < static_cast<int>(texture.levels.size()); ++level)
+				m_resident -= levelBytes(texture.levels[level]);
+
+			Texture loaded{};
+			loaded.levels = std::move(decoded->levels);
+			loaded.loadId = decoded->loadId;
+			loaded.lastUsed = texture.lastUsed;
+			prepare(loaded);
+			texture = std::move(loaded);
+		}
+		m_finishing.clear();
+	}
+
+	static std::size_t levelBytes(const Level& level)
+	{
+		return static_cast<std::size_t>(level.width) * level.height * 4;
+	}
+
+	// Fills the level from the open upload batch, or from client memory when there is none.
+	// The GL texture keeps the full size level numbering and BASE_LEVEL points at the finest resident one
+	void uploadLevel(Texture& texture, int level)
+	{
+		const Level& source{ texture.levels[level] };
+
+		glBindTexture(GL_TEXTURE_2D, texture.name);
+		if (m_uploadQueue.stage(texture.name, level, source.width, source.height, source.pixels.data()))
+		{
+			// Storage only, the texels follow when the batch is submitted before the next draw
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, source.width, source.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		}
+		else
+		{
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, source.width, source.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, source.pixels.data());
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+
+		texture.residentLevel = level;
+		m_resident += levelBytes(source);
+	}
+
+	void dropLevel(Texture& texture)
+	{
+		int level{ texture.residentLevel };
+
+		// Respecifying the level with no storage releases its memory
+		glBindTexture(GL_TEXTURE_2D, texture.name);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		texture.residentLevel = level + 1;
+		m_resident -= levelBytes(texture.levels[level]);
+	}
+
+	void evictOverBudget()
+	{
+		if (m_resident <= m_budget)
+			return;
+
+		// Levels finer than needed go first, then the least recently used textures
+		ArenaScope scope{ scratchArena() };
+		std::vector<Texture*, ArenaAllocator<Texture*>> order{ ArenaAllocator<Texture*>{ scratchArena() } };
+		order.reserve(m_textures.size());
+		for (Texture& texture : m_textures)
+		{
+			if (texture.residentLevel < texture.tailLevel)
+				order.push_back(&texture);
+		}
+
+		std::sort(order.begin(), order.end(), [](const Texture* a, const Texture* b)
+			{
+				bool aSurplus{ a->residentLevel < a->desiredLevel };
+				bool bSurplus{ b->residentLevel < b->desiredLevel };
+				if (aSurplus != bSurplus)
+					return aSurplus;
+				return a->lastUsed < b->lastUsed;
+			});
+
+		for (Texture* texture : order)
+		{
+			while (m_resident > m_budget && texture->residentLevel < texture->tailLevel)
+			{
+				// Used textures only give up surplus levels in this pass
+				if (texture->lastUsed == m_frame && texture->residentLevel >= texture->desiredLevel)
+					break;
+				dropLevel(*texture);
+			}
+		}
+
+		// Still over, so the textures in view give up their finest levels too
+		for (Texture* texture : order)
+		{
+			while (m_resident > m_budget && texture->residentLevel < texture->tailLevel)
+				dropLevel(*texture);
+		}
+	}
+
+	void streamIn()
+	{
+		// Textures furthest from their desired level are served first
+		ArenaScope scope{ scratchArena() };
+		std::vector<Texture*, ArenaAllocator<Texture*>> order{ ArenaAllocator<Texture*>{ scratchArena() } };
+		order.reserve(m_textures.size());
+		for (Texture& texture : m_textures)
+		{
+			if (texture.residentLevel > texture.desiredLevel)
+				order.push_back(&texture);
+			else if (texture.lastUsed + evictDelayFrames < m_frame)
+			{
+				// Unused for a while, give back what is no longer wanted even under budget
+				while (texture.residentLevel < texture.desiredLevel)
+					dropLevel(texture);
+			}
+		}
+
+		std::sort(order.begin(), order.end(), [](const Texture* a, const Texture* b)
+			{
+				return a->residentLevel - a->desiredLevel > b->residentLevel - b->desiredLevel;
+			});
+
+		// Every staging buffer still being read by the GPU, try again next frame rather than wait
+		if (order.empty() || !m_uploadQueue.begin())
+			return;
+
+		std::size_t uploaded{ 0 };
+		for (Texture* texture : order)
+		{
+			// One level per texture per frame, coarse to fine
+			const Level& next{ texture->levels[texture->residentLevel - 1] };
+			std::size_t bytes{ levelBytes(next) };
+			if (m_resident + bytes > m_budget || uploaded + bytes > m_uploadBytesPerFrame)
+				continue;
+
+			uploadLevel(*texture, texture->residentLevel - 1);
+			uploaded += bytes;
+		}
+		m_uploadQueue.submit();
+	}
+
+	static Level downsample(const Level& source)
+	{
+		Level level{ std::max(1, source.width / 2), std::max(1, source.height / 2), {} };
+		level.pixels.resize(static_cast<std::size_t>(level.width) * level.height * 4);
+
+		// Box filter over the 2x2 source texels, clamped at odd edges
+		for (int y{ 0 }; y < level.height; ++y)
+		{
+			int y0{ std::min(y * 2, source.height - 1) };
+			int y1{ std::min(y * 2 + 1, source.height - 1) };
+			for (int x{ 0 }; x < level.width; ++x)
+			{
+				int x0{ std::min(x * 2, source.width - 1) };
+				int x1{ std::min(x * 2 + 1, source.width - 1) };
+				for (int c{ 0 }; c < 4; ++c)
+				{
+					int sum{ source.pixels[(static_cast<std::size_t>(y0) * source.width + x0) * 4 + c]
+						+ source.pixels[(static_cast<std::size_t>(y0) * source.width + x1) * 4 + c]
+						+ source.pixels[(static_cast<std::size_t>(y1) * source.width + x0) * 4 + c]
+						+ source.pixels[(static_cast<std::size_t>(y1) * source.width + x1) * 4 + c] };
+					level.pixels[(static_cast<std::size_t>(y) * level.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+		return level;
+	}
+};
+
+#endif
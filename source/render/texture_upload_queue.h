@@ -0,0 +1,229 @@
+/*
+* File: texture_upload_queue.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program stages texel data in a pool of pixel unpack buffers so
+			   texture uploads are copied by the GPU instead of the driver copying
+			   client memory inside the call. Each batch fills one buffer and a fence
+			   returns it to the pool once the GPU has read it
+*/
+
+#ifndef TEXTURE_UPLOAD_QUEUE_H
+#define TEXTURE_UPLOAD_QUEUE_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class TextureUploadQueue
+{
+public:
+	// Uploads one batch can hold, reserved up front so batches never allocate
+	static constexpr int maxUploadsPerBatch{ 64 };
+
+	/*
+	* Creates the staging buffers
+	* Parameters:
+	* - bufferBytes: Size of each staging buffer, the most texel data one batch can stage
+	* - bufferCount: Number of staging buffers, batches the GPU may still be reading from
+	* Returns: TextureUploadQueue object
+	*/
+	TextureUploadQueue(std::size_t bufferBytes, int bufferCount = 3)
+		: m_bufferBytes{ bufferBytes }
+		, m_buffers(static_cast<std::size_t>(bufferCount))
+	{
+		for (Buffer& buffer : m_buffers)
+		{
+			glGenBuffers(1, &buffer.name);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.name);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(m_bufferBytes), nullptr, GL_STREAM_DRAW);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		m_uploads.reserve(maxUploadsPerBatch);
+	}
+
+	~TextureUploadQueue()
+	{
+		if (m_mapped)
+			submit();
+
+		for (Buffer& buffer : m_buffers)
+		{
+			if (buffer.fence)
+				glDeleteSync(buffer.fence);
+			glDeleteBuffers(1, &buffer.name);
+		}
+	}
+
+	TextureUploadQueue(const TextureUploadQueue&) = delete;
+	TextureUploadQueue& operator=(const TextureUploadQueue&) = delete;
+
+	/*
+	* Grows the staging buffers so one batch can hold a given size. The driver keeps the
+	* old storage of a buffer the GPU is still reading until it is done, so nothing waits.
+	* Does nothing while a batch is open
+	* Parameters:
+	* - bytes: Texel data one batch must be able to stage
+	* Returns: void
+	*/
+	void reserve(std::size_t bytes)
+	{
+		if (bytes <= m_bufferBytes || m_mapped)
+			return;
+
+		m_bufferBytes = bytes;
+		for (Buffer& buffer : m_buffers)
+		{
+			// The fence guarded the old storage, the new one is free right away
+			if (buffer.fence)
+			{
+				glDeleteSync(buffer.fence);
+				buffer.fence = nullptr;
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.name);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(m_bufferBytes), nullptr, GL_STREAM_DRAW);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	/*
+	* Maps a staging buffer the GPU has finished reading for a new batch. Never waits,
+	* when every buffer is still in flight the batch is skipped
+	* Parameters: None
+	* Returns: True if a batch was started
+	*/
+	bool begin()
+	{
+		for (std::size_t i{ 0 }; i < m_buffers.size(); ++i)
+		{
+			std::size_t index{ (m_next + i) % m_buffers.size() };
+			Buffer& buffer{ m_buffers[index] };
+			if (buffer.fence)
+			{
+				if (glClientWaitSync(buffer.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+					continue;
+				glDeleteSync(buffer.fence);
+				buffer.fence = nullptr;
+			}
+
+			// The fence already proved the GPU is done with it, so the map need not synchronize
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.name);
+			m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(m_bufferBytes),
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			if (!m_mapped)
+				return false;
+
+			m_current = index;
+			m_next = (index + 1) % m_buffers.size();
+			m_used = 0;
+			return true;
+		}
+		return false;
+	}
+
+	/*
+	* Copies a texture level into the batch. Its storage must already be specified, the
+	* level is filled with glTexSubImage2D when the batch is submitted
+	* Parameters:
+	* - texture: Name of the 2D texture
+	* - level: Mip level to fill
+	* - width: Width of the level in texels
+	* - height: Height of the level in texels
+	* - pixels: Tightly packed RGBA8 texels
+	* Returns: False if the batch has no room left for the level
+	*/
+	bool stage(unsigned int texture, int level, int width, int height, const unsigned char* pixels)
+	{
+		std::size_t bytes{ static_cast<std::size_t>(width) * height * 4 };
+		if (!m_mapped || m_used + bytes > m_bufferBytes || static_cast<int>(m_uploads.size()) == maxUploadsPerBatch)
+			return false;
+
+		std::memcpy(m_mapped + m_used, pixels, bytes);
+		m_uploads.push_back(Upload{ texture, level, width, height, m_used });
+		// Offsets stay 4 byte aligned, RGBA8 rows need nothing stricter
+		m_used += bytes;
+		return true;
+	}
+
+	/*
+	* Unmaps the batch, issues its uploads from the staging buffer and fences it. The
+	* texture binding of GL_TEXTURE_2D is left on the last uploaded texture
+	* Parameters: None
+	* Returns: void
+	*/
+	void submit()
+	{
+		if (!m_mapped)
+			return;
+
+		Buffer& buffer{ m_buffers[m_current] };
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.name);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		m_mapped = nullptr;
+
+		if (!m_uploads.empty())
+		{
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			for (const Upload& upload : m_uploads)
+			{
+				glBindTexture(GL_TEXTURE_2D, upload.texture);
+				glTexSubImage2D(GL_TEXTURE_2D, upload.level, 0, 0, upload.width, upload.height, GL_RGBA, GL_UNSIGNED_BYTE,
+					reinterpret_cast<const void*>(static_cast<std::uintptr_t>(upload.offset)));
+			}
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+			buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			m_submittedBytes += m_used;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		m_uploads.clear();
+		m_used = 0;
+	}
+
+	// Most texel data one batch can stage
+	std::size_t getBatchBytes() const
+	{
+		return m_bufferBytes;
+	}
+
+	// Texel data uploaded through the staging buffers since creation
+	std::uint64_t getSubmittedBytes() const
+	{
+		return m_submittedBytes;
+	}
+
+private:
+	struct Buffer
+	{
+		unsigned int name{};
+		// Placed after the batch's uploads, the buffer is free again once it signals
+		GLsync fence{ nullptr };
+	};
+
+	struct Upload
+	{
+		unsigned int texture{};
+		int level{};
+		int width{};
+		int height{};
+		std::size_t offset{};
+	};
+
+	std::size_t m_bufferBytes{};
+	std::vector<Buffer> m_buffers{};
+	std::size_t m_next{ 0 };
+	std::size_t m_current{ 0 };
+
+	unsigned char* m_mapped{ nullptr };
+	std::size_t m_used{ 0 };
+	std::vector<Upload> m_uploads{};
+	std::uint64_t m_submittedBytes{ 0 };
+};
+
+#endif
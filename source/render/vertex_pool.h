@@ -0,0 +1,194 @@
+/*
+* File: vertex_pool.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program suballocates the meshes of many objects from one shared
+			   vertex buffer so they can all be drawn from a single vertex array,
+			   which multi-draw submission requires
+*/
+
+#ifndef VERTEX_POOL_H
+#define VERTEX_POOL_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+class VertexPool
+{
+public:
+	// Interleaved position, normal, texture coordinates and two baked light values
+	static constexpr int floatsPerVertex{ 10 };
+
+	/*
+	* Creates the shared buffer and the vertex array reading from it
+	* Parameters:
+	* - capacity: Number of vertices the buffer starts with, it doubles when full
+	* Returns: VertexPool object
+	*/
+	explicit VertexPool(int capacity)
+	{
+		glGenVertexArrays(1, &m_vao);
+		createBuffer(capacity);
+		m_free.push_back(Block{ 0, capacity });
+	}
+
+	~VertexPool()
+	{
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_vbo);
+	}
+
+	VertexPool(const VertexPool&) = delete;
+	VertexPool& operator=(const VertexPool&) = delete;
+
+	/*
+	* Copies vertices into the first free block large enough, growing the buffer if none is
+	* Parameters:
+	* - vertices: Interleaved vertex data, floatsPerVertex floats per vertex
+	* - count: Number of vertices
+	* Returns: Index of the first vertex in the pool, -1 for an empty mesh
+	*/
+	int allocate(const float* vertices, int count)
+	{
+		if (count <= 0)
+			return -1;
+
+		auto block{ std::find_if(m_free.begin(), m_free.end(), [count](const Block& free) { return free.count >= count; }) };
+		if (block == m_free.end())
+		{
+			grow(count);
+			block = std::prev(m_free.end());
+		}
+
+		int first{ block->first };
+		block->first += count;
+		block->count -= count;
+		if (block->count == 0)
+			m_free.erase(block);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(first) * vertexSize, static_cast<GLsizeiptr>(count) * vertexSize, vertices);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		m_used += count;
+		return first;
+	}
+
+	/*
+	* Returns a block to the pool, merging it with free neighbours
+	* Parameters:
+	* - first: Index returned by allocate
+	* - count: Number of vertices that were allocated
+	* Returns: void
+	*/
+	void release(int first, int count)
+	{
+		if (first < 0 || count <= 0)
+			return;
+
+		m_used -= count;
+
+		// The free list is kept sorted by position so neighbours are adjacent
+		auto next{ std::lower_bound(m_free.begin(), m_free.end(), first, [](const Block& free, int position) { return free.first < position; }) };
+		auto block{ m_free.insert(next, Block{ first, count }) };
+
+		auto after{ std::next(block) };
+		if (after != m_free.end() && block->first + block->count == after->first)
+		{
+			block->count += after->count;
+			m_free.erase(after);
+		}
+
+		if (block != m_free.begin())
+		{
+			auto before{ std::prev(block) };
+			if (before->first + before->count == block->first)
+			{
+				before->count += block->count;
+				m_free.erase(block);
+			}
+		}
+	}
+
+	// Vertex array with position, normal and texture coordinates at locations 0-2 and light at 7
+	unsigned int getVertexArray() const
+	{
+		return m_vao;
+	}
+
+	int getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	int getUsed() const
+	{
+		return m_used;
+	}
+
+private:
+	static constexpr GLsizeiptr vertexSize{ floatsPerVertex * sizeof(float) };
+
+	struct Block
+	{
+		int first{};
+		int count{};
+	};
+
+	unsigned int m_vao{};
+	unsigned int m_vbo{};
+	int m_capacity{ 0 };
+	int m_used{ 0 };
+	std::vector<Block> m_free{};
+
+	void createBuffer(int capacity)
+	{
+		m_capacity = capacity;
+		glGenBuffers(1, &m_vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity) * vertexSize, nullptr, GL_STATIC_DRAW);
+
+		glBindVertexArray(m_vao);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(vertexSize), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(vertexSize), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(vertexSize), (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+		// Locations 3-6 are the instance model matrix of the lit shaders
+		glVertexAttribPointer(7, 2, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(vertexSize), (void*)(8 * sizeof(float)));
+		glEnableVertexAttribArray(7);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// Doubles the buffer until count more vertices fit at its end, keeping every offset valid
+	void grow(int count)
+	{
+		int oldCapacity{ m_capacity };
+		int capacity{ std::max(oldCapacity, 1) };
+		while (capacity - oldCapacity < count)
+			capacity *= 2;
+
+		unsigned int oldBuffer{ m_vbo };
+		createBuffer(capacity);
+
+		glBindBuffer(GL_COPY_READ_BUFFER, oldBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldCapacity) * vertexSize);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glDeleteBuffers(1, &oldBuffer);
+
+		// The new space joins a free block that ended the old buffer
+		if (!m_free.empty() && m_free.back().first + m_free.back().count == oldCapacity)
+			m_free.back().count += capacity - oldCapacity;
+		else
+			m_free.push_back(Block{ oldCapacity, capacity - oldCapacity });
+	}
+};
+
+#endif
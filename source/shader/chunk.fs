@@ -0,0 +1,19 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+in vec2 Light;
+
+uniform sampler2D diffuse;
+
+// Colour of full sky light and full block light, and the floor nothing falls below
+uniform vec3 skyColor;
+uniform vec3 blockColor;
+uniform vec3 ambient;
+
+void main()
+{
+    // All lighting was baked per vertex, the fragment only modulates the texture
+    vec3 light = ambient + skyColor * Light.x + blockColor * Light.y;
+    FragColor = vec4(texture(diffuse, TexCoords).rgb * min(light, vec3(1.0)), 1.0);
+}
@@ -0,0 +1,24 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoords;
+// Sky and block light baked into the mesh, ambient occlusion already applied
+layout (location = 7) in vec2 aLight;
+
+out vec2 TexCoords;
+out vec2 Light;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// The depth pre-pass links this with another fragment shader and the main pass
+// tests for equal depth, so both programs must compute the exact same position
+invariant gl_Position;
+
+void main()
+{
+    // Chunk meshes are built in world space
+    TexCoords = aTexCoords;
+    Light = aLight;
+
+    gl_Position = projection * view * vec4(aPos, 1.0);
+}
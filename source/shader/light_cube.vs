@@ -1,11 +1,15 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;
 
 uniform mat4 projection;
 uniform mat4 view;
-uniform mat4 model;
+
+// The depth pre-pass links this with another fragment shader and the main pass
+// tests for equal depth, so both programs must compute the exact same position
+invariant gl_Position;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
+	gl_Position = projection * view * aModel * vec4(aPos, 1.0f);
 }
\ No newline at end of file
@@ -54,7 +54,10 @@ in vec2 TexCoords;
 
 uniform vec3 viewPos;
 uniform DirLight dirLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
+// Point lights are streamed in as one block per frame, laid out as std140
+layout (std140) uniform PointLightBlock {
+    PointLight pointLights[NR_POINT_LIGHTS];
+};
 uniform SpotLight spotLight;
 uniform Material material;
 
@@ -2,23 +2,28 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+// Per-instance model matrix streamed in every frame
+layout (location = 3) in mat4 aModel;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// The depth pre-pass links this with another fragment shader and the main pass
+// tests for equal depth, so both programs must compute the exact same position
+invariant gl_Position;
+
 void main()
 {
     // Compute world space position of the vertex
-    FragPos = vec3(model * vec4(aPos, 1.0));
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
 
     // Properly transform the normal vector with inverse transpose of model matrix 
     // and is mostly needed for curves and inclines to display lighting properly
-    Normal = mat3(transpose(inverse(model))) * aNormal;  
+    Normal = mat3(transpose(inverse(aModel))) * aNormal;  
     TexCoords = aTexCoords;
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
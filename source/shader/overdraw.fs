@@ -0,0 +1,10 @@
+#version 330 core
+out vec4 FragColor;
+
+// Added per shaded fragment with additive blending, so brightness counts the layers
+uniform vec3 layerColor;
+
+void main()
+{
+    FragColor = vec4(layerColor, 1.0);
+}
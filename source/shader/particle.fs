@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 Corner;
+in vec4 Color;
+
+void main()
+{
+    // A soft round dot, with the colour premultiplied by its alpha
+    float alpha = Color.a * (1.0 - smoothstep(0.5, 1.0, length(Corner)));
+    if (alpha <= 0.0)
+        discard;
+    FragColor = vec4(Color.rgb * alpha, alpha);
+}
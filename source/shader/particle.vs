@@ -0,0 +1,22 @@
+#version 330 core
+// One instance per particle, the quad corners come from the vertex index
+layout (location = 0) in vec4 aPositionSize;
+layout (location = 1) in vec4 aColor;
+
+out vec2 Corner;
+out vec4 Color;
+
+uniform mat4 projection;
+uniform mat4 view;
+
+void main()
+{
+    Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    Color = aColor;
+
+    // The rows of the view rotation are the camera's right and up in world space
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 position = aPositionSize.xyz + (right * Corner.x + up * Corner.y) * aPositionSize.w;
+    gl_Position = projection * view * vec4(position, 1.0);
+}
@@ -3,22 +3,27 @@
 * Author: Simon Olesen
 * Date: 2025-05-13
 * Description: This program links a vertex shader and fragment shader to a shader program
-			   by loading from file and defines functions to bind it when needed
+			   by loading from the asset archive or loose files and defines functions
+			   to bind it when needed
 */
 
 #ifndef SHADER_H
 #define SHADER_H
 
+#include "../io/asset_archive.h"
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream>
 
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
 class Shader
 {
 public:
@@ -27,50 +32,25 @@ public:
 	/*
 	* Loads and compiles vertex and fragment shaders and links them into a shader program
 	* Parameters:
+	* - assets: Asset loader the shader sources are read through
 	* - vertexPath: Char pointer to the vertex shader file path
 	* - fragmentPath: Char pointer to the fragment shader file path
 	* Returns: Shader object containing a bindable shader program
 	*/
-	Shader(const char* vertexPath, const char* fragmentPath)
-	{
-		std::string vertexCode{};
-		std::string fragmentCode{};
-		std::ifstream vShaderFile{};
-		std::ifstream fShaderFile{};
-		vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		try
-		{
-			// Read shader files into streams
-			vShaderFile.open(vertexPath);
-			fShaderFile.open(fragmentPath);
-			std::stringstream vShaderStream{};
-			std::stringstream fShaderStream{};
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			vShaderFile.close();
-			fShaderFile.close();
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
-		}
-		catch (std::ifstream::failure e)
-		{
+	Shader(const AssetLoader& assets, const char* vertexPath, const char* fragmentPath)
+	{
+		// The sources are compiled straight from the asset views, nothing is copied
+		Asset vertexCode{ assets.open(vertexPath) };
+		Asset fragmentCode{ assets.open(fragmentPath) };
+		if (!vertexCode.isValid() || !fragmentCode.isValid())
 			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n";
-		}
-
-		const char* vShaderCode{ vertexCode.c_str() };
-		const char* fShaderCode{ fragmentCode.c_str() };
 
 		// Compile vertex shader
-		unsigned int vertexShader{ glCreateShader(GL_VERTEX_SHADER) };
-		glShaderSource(vertexShader, 1, &vShaderCode, NULL);
-		glCompileShader(vertexShader);
+		unsigned int vertexShader{ compileStage(GL_VERTEX_SHADER, vertexCode) };
 		checkCompileErrors(vertexShader, "VERTEX");
 
 		// Compile fragment shader
-		unsigned int fragmentShader{ glCreateShader(GL_FRAGMENT_SHADER) };
-		glShaderSource(fragmentShader, 1, &fShaderCode, NULL);
-		glCompileShader(fragmentShader);
+		unsigned int fragmentShader{ compileStage(GL_FRAGMENT_SHADER, fragmentCode) };
 		checkCompileErrors(fragmentShader, "FRAGMENT");
 
 		// Link shaders into a program
@@ -84,6 +64,31 @@ public:
 		glDeleteShader(fragmentShader);
 	}
 
+	/*
+	* Loads and compiles a compute shader and links it into a shader program. Needs a
+	* GL 4.3 context
+	* Parameters:
+	* - assets: Asset loader the shader source is read through
+	* - computePath: Char pointer to the compute shader file path
+	* Returns: Shader object containing a dispatchable shader program
+	*/
+	Shader(const AssetLoader& assets, const char* computePath)
+	{
+		Asset computeCode{ assets.open(computePath) };
+		if (!computeCode.isValid())
+			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n";
+
+		unsigned int computeShader{ compileStage(GL_COMPUTE_SHADER, computeCode) };
+		checkCompileErrors(computeShader, "COMPUTE");
+
+		shaderProgram = glCreateProgram();
+		glAttachShader(shaderProgram, computeShader);
+		glLinkProgram(shaderProgram);
+		checkCompileErrors(shaderProgram, "PROGRAM");
+
+		glDeleteShader(computeShader);
+	}
+
 	/*
 	* Activates the shader program for use in rendering
 	* Parameters: None
@@ -94,69 +99,81 @@ public:
 		glUseProgram(shaderProgram);
 	}
 
-	void setBool(const std::string& name, bool value) const
+	void setBool(const char* name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), (int)value);
+		glUniform1i(glGetUniformLocation(shaderProgram, name), (int)value);
 	}
 
-	void setInt(const std::string& name, int value) const
+	void setInt(const char* name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), value);
+		glUniform1i(glGetUniformLocation(shaderProgram, name), value);
 	}
 
-	void setFloat(const std::string& name, float value) const
+	void setFloat(const char* name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(shaderProgram, name.c_str()), value);
+		glUniform1f(glGetUniformLocation(shaderProgram, name), value);
 	}
 
-	void setVec2(const std::string& name, const glm::vec2& value) const
+	void setVec2(const char* name, const glm::vec2& value) const
 	{
-		glUniform2fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, &value[0]);
+		glUniform2fv(glGetUniformLocation(shaderProgram, name), 1, &value[0]);
 	}
-	void setVec2(const std::string& name, float x, float y) const
+	void setVec2(const char* name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(shaderProgram, name.c_str()), x, y);
+		glUniform2f(glGetUniformLocation(shaderProgram, name), x, y);
 	}
 
-	void setVec3(const std::string& name, const glm::vec3& value) const
+	void setVec3(const char* name, const glm::vec3& value) const
 	{
-		glUniform3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, &value[0]);
+		glUniform3fv(glGetUniformLocation(shaderProgram, name), 1, &value[0]);
 	}
-	void setVec3(const std::string& name, float x, float y, float z) const
+	void setVec3(const char* name, float x, float y, float z) const
 	{
-		glUniform3f(glGetUniformLocation(shaderProgram, name.c_str()), x, y, z);
+		glUniform3f(glGetUniformLocation(shaderProgram, name), x, y, z);
 	}
 
-	void setVec4(const std::string& name, const glm::vec4& value) const
+	void setVec4(const char* name, const glm::vec4& value) const
 	{
-		glUniform4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, &value[0]);
+		glUniform4fv(glGetUniformLocation(shaderProgram, name), 1, &value[0]);
 	}
-	void setVec4(const std::string& name, float x, float y, float z, float w) const
+	void setVec4(const char* name, float x, float y, float z, float w) const
 	{
-		glUniform4f(glGetUniformLocation(shaderProgram, name.c_str()), x, y, z, w);
+		glUniform4f(glGetUniformLocation(shaderProgram, name), x, y, z, w);
 	}
 
-	void setMat2(const std::string& name, const glm::mat2& mat)
+	void setMat2(const char* name, const glm::mat2& mat)
 	{
-		glUniformMatrix2fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		glUniformMatrix2fv(glGetUniformLocation(shaderProgram, name), 1, GL_FALSE, glm::value_ptr(mat));
 	}
 
-	void setMat3(const std::string& name, const glm::mat3& mat)
+	void setMat3(const char* name, const glm::mat3& mat)
 	{
-		glUniformMatrix3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		glUniformMatrix3fv(glGetUniformLocation(shaderProgram, name), 1, GL_FALSE, glm::value_ptr(mat));
 	}
 
-	void setMat4(const std::string& name, const glm::mat4& mat)
+	void setMat4(const char* name, const glm::mat4& mat)
 	{
-		glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name), 1, GL_FALSE, glm::value_ptr(mat));
 	}
 
 private:
+	// Source views aren't null terminated, so their length is passed along
+	static unsigned int compileStage(GLenum type, const Asset& code)
+	{
+		const char* source{ reinterpret_cast<const char*>(code.data()) };
+		GLint length{ static_cast<GLint>(code.size()) };
+
+		unsigned int shader{ glCreateShader(type) };
+		glShaderSource(shader, 1, &source, &length);
+		glCompileShader(shader);
+		return shader;
+	}
+
 	/*
 	* Checks and prints compile or linking errors for shaders
 	* Parameters:
 	* - shader: ID of the shader or program
-	* - type: String indicating "VERTEX", "FRAGMENT", or "PROGRAM"
+	* - type: String indicating "VERTEX", "FRAGMENT", "COMPUTE" or "PROGRAM"
 	* Returns: void
 	*/
 	void checkCompileErrors(unsigned int shader, std::string type)
@@ -0,0 +1,477 @@
+/*
+* File: test.cpp
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: The program entry point for the test executable, which checks the
+			   engine code that can run without a window. Build it as its own
+			   executable from this file, linked like the benchmark, and run it from
+			   the repository root. It exits with 1 if any case fails
+*/
+
+#include "test.h"
+#include "../camera/camera.h"
+#include "../input/input.h"
+#include "../job/job_system.h"
+#define ALLOCATION_TRACKER_IMPLEMENTATION
+#include "../memory/allocation_tracker.h"
+#include "../memory/linear_arena.h"
+#include "../render/draw_list.h"
+#include "../render/frustum.h"
+#include "../render/particle_system.h"
+#include "../world/particle_emitters.h"
+#include "../world/terrain.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+void testJobDeque(test::Runner& runner);
+void testJobSystem(test::Runner& runner);
+void testInputReplay(test::Runner& runner);
+void testFrameAllocations(test::Runner& runner);
+
+int main(int argc, char* argv[])
+{
+	// --filter <prefix> runs only the cases whose name starts with it, --list prints the names
+	// and --timeout <s> sets how long a case may run before it counts as hung
+	test::Options options{};
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		bool hasValue{ i + 1 < argc };
+		if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+			options.filter = argv[++i];
+		else if (std::strcmp(argv[i], "--list") == 0)
+			options.list = true;
+		else if (std::strcmp(argv[i], "--timeout") == 0 && hasValue)
+			options.timeoutSeconds = std::max(1.0, std::atof(argv[++i]));
+	}
+
+	test::Runner runner{ options };
+
+	testJobDeque(runner);
+	testJobSystem(runner);
+	testInputReplay(runner);
+	testFrameAllocations(runner);
+
+	return runner.finish();
+}
+
+/*
+* Checks that every job pushed onto a deque is taken exactly once while thieves steal
+* from it and the owner pops
+* Parameters:
+* - runner: Runner the cases are run with
+* Returns: void
+*/
+void testJobDeque(test::Runner& runner)
+{
+	runner.run("jobs/deque/push_pop_steal", []()
+		{
+			constexpr int jobCount{ 200000 };
+			constexpr int thiefCount{ 3 };
+			std::unique_ptr<Job[]> jobs{ std::make_unique<Job[]>(jobCount) };
+			std::unique_ptr<std::atomic<int>[]> taken{ std::make_unique<std::atomic<int>[]>(jobCount) };
+			auto take{ [&](Job* job)
+				{
+					taken[job - jobs.get()].fetch_add(1, std::memory_order_relaxed);
+				} };
+
+			JobDeque deque{};
+			std::atomic<bool> pushing{ true };
+			std::vector<std::thread> thieves{};
+			for (int t{ 0 }; t < thiefCount; ++t)
+			{
+				thieves.emplace_back([&]()
+					{
+						while (pushing.load(std::memory_order_acquire))
+						{
+							if (Job* job{ deque.steal() })
+								take(job);
+							else
+								std::this_thread::yield();
+						}
+						while (Job* job{ deque.steal() })
+							take(job);
+					});
+			}
+
+			// Bursts of pushes with a few pops in between keep the owner racing the thieves for the last job
+			int next{ 0 };
+			while (next < jobCount)
+			{
+				for (int i{ 0 }; i < 64 && next < jobCount; ++i)
+				{
+					if (!deque.push(&jobs[next]))
+						break;
+					++next;
+				}
+				for (int i{ 0 }; i < 48; ++i)
+				{
+					if (Job* job{ deque.pop() })
+						take(job);
+				}
+			}
+			while (Job* job{ deque.pop() })
+				take(job);
+
+			pushing.store(false, std::memory_order_release);
+			for (std::thread& thief : thieves)
+				thief.join();
+
+			int wrong{ 0 };
+			for (int i{ 0 }; i < jobCount; ++i)
+				wrong += taken[i].load() != 1;
+			TEST_CHECK(wrong == 0);
+		});
+
+	runner.run("jobs/deque/full", []()
+		{
+			std::unique_ptr<Job[]> jobs{ std::make_unique<Job[]>(JobDeque::capacity + 1) };
+			JobDeque deque{};
+			bool pushed{ true };
+			for (std::int64_t i{ 0 }; i < JobDeque::capacity; ++i)
+				pushed = pushed && deque.push(&jobs[i]);
+			TEST_CHECK(pushed);
+			TEST_CHECK(!deque.push(&jobs[JobDeque::capacity]));
+			// Newest comes back first for the owner, oldest for a thief
+			TEST_CHECK(deque.pop() == &jobs[JobDeque::capacity - 1]);
+			TEST_CHECK(deque.steal() == &jobs[0]);
+		});
+}
+
+/*
+* Checks counters, dependencies, parallelFor, nesting deeper than the job pools and
+* background jobs, with one, two and four threads
+* Parameters:
+* - runner: Runner the cases are run with
+* Returns: void
+*/
+void testJobSystem(test::Runner& runner)
+{
+	for (int threads : { 1, 2, 4 })
+	{
+		std::string suffix{ "/threads:" + std::to_string(threads) };
+
+		runner.run("jobs/counter" + suffix, [threads]()
+			{
+				JobSystem jobs{ threads };
+				JobCounter counter{};
+				std::atomic<int> sum{ 0 };
+				for (int i{ 1 }; i <= 1000; ++i)
+					jobs.run([&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); }, &counter);
+				TEST_CHECK(!counter.isDone() || sum.load() == 500500);
+				jobs.wait(counter);
+				TEST_CHECK(counter.isDone());
+				TEST_CHECK(counter.value.load() == 0);
+				TEST_CHECK(sum.load() == 500500);
+			});
+
+		runner.run("jobs/dependency" + suffix, [threads]()
+			{
+				JobSystem jobs{ threads };
+				JobCounter first{};
+				JobCounter second{};
+				std::atomic<int> firstDone{ 0 };
+				std::atomic<int> early{ 0 };
+				for (int i{ 0 }; i < 64; ++i)
+				{
+					jobs.run([&firstDone]()
+						{
+							std::this_thread::sleep_for(std::chrono::microseconds(200));
+							firstDone.fetch_add(1, std::memory_order_relaxed);
+						}, &first);
+				}
+				for (int i{ 0 }; i < 64; ++i)
+					jobs.run([&firstDone, &early]() { early.fetch_add(firstDone.load() != 64, std::memory_order_relaxed); }, &second, &first);
+				jobs.wait(second);
+				TEST_CHECK(first.isDone());
+				TEST_CHECK(early.load() == 0);
+			});
+
+		runner.run("jobs/parallel_for" + suffix, [threads]()
+			{
+				JobSystem jobs{ threads };
+				for (int chunkSize : { 0, 1, 7, 1000, 5000 })
+				{
+					std::vector<int> visits(3000, 0);
+					jobs.parallelFor(0, 3000, chunkSize, [&visits](int first, int last)
+						{
+							for (int i{ first }; i < last; ++i)
+								++visits[i];
+						});
+					TEST_CHECK(std::all_of(visits.begin(), visits.end(), [](int count) { return count == 1; }));
+				}
+
+				int calls{ 0 };
+				jobs.parallelFor(5, 5, 1, [&calls](int, int) { ++calls; });
+				TEST_CHECK(calls == 0);
+			});
+
+		// More jobs are alive at once than a pool has slots, the outer bodies hold theirs while they wait
+		runner.run("jobs/nested_past_pool" + suffix, [threads]()
+			{
+				JobSystem jobs{ threads };
+				for (int outer : { 32, 64, 128 })
+				{
+					std::atomic<int> count{ 0 };
+					jobs.parallelFor(0, outer, 1, [&jobs, &count](int, int)
+						{
+							jobs.parallelFor(0, 64, 1, [&count](int, int) { count.fetch_add(1, std::memory_order_relaxed); });
+						});
+					TEST_CHECK(count.load() == outer * 64);
+				}
+			});
+
+		// Background jobs progress while the constructing thread only waits on its own frame work
+		runner.run("jobs/background" + suffix, [threads]()
+			{
+				JobSystem jobs{ threads };
+				std::thread::id mainThread{ std::this_thread::get_id() };
+				JobCounter background{};
+				std::atomic<int> onMainThread{ 0 };
+				for (int i{ 0 }; i < 4; ++i)
+				{
+					jobs.runBackground([&onMainThread, mainThread]()
+						{
+							onMainThread.fetch_add(std::this_thread::get_id() == mainThread, std::memory_order_relaxed);
+							std::this_thread::sleep_for(std::chrono::milliseconds(2));
+						}, &background);
+				}
+
+				for (int frame{ 0 }; frame < 100 && !background.isDone(); ++frame)
+				{
+					std::atomic<int> sum{ 0 };
+					jobs.parallelFor(0, 256, 16, [&sum](int first, int last) { sum.fetch_add(last - first, std::memory_order_relaxed); });
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				TEST_CHECK(background.isDone());
+				TEST_CHECK(onMainThread.load() == 0);
+				jobs.wait(background);
+			});
+
+		// With every pool slot taken jobs run inline, which must still wait for their dependency
+		runner.run("jobs/pool_exhausted_dependency" + suffix, [threads]()
+			{
+				JobSystem jobs{ threads };
+				JobCounter gate{};
+				std::atomic<bool> opened{ false };
+				jobs.runBackground([&opened]()
+					{
+						std::this_thread::sleep_for(std::chrono::milliseconds(20));
+						opened.store(true, std::memory_order_release);
+					}, &gate);
+
+				JobCounter dependents{};
+				std::atomic<int> early{ 0 };
+				constexpr int dependentCount{ static_cast<int>(JobSystem::poolSize) + 500 };
+				for (int i{ 0 }; i < dependentCount; ++i)
+					jobs.run([&opened, &early]() { early.fetch_add(!opened.load(std::memory_order_acquire), std::memory_order_relaxed); }, &dependents, &gate);
+				jobs.wait(dependents);
+				TEST_CHECK(early.load() == 0);
+			});
+	}
+}
+
+/*
+* Checks that a truncated recording ends the replay without applying the partial frame
+* and that the quit key gets through while replaying
+* Parameters:
+* - runner: Runner the cases are run with
+* Returns: void
+*/
+void testInputReplay(test::Runner& runner)
+{
+	// GLFW key codes, the test doesn't include GLFW
+	constexpr int keyEscape{ 256 };
+	constexpr int keyA{ 65 };
+	constexpr int keyB{ 66 };
+	const std::string path{ (std::filesystem::temp_directory_path() / "freakmon_test_input.rec").string() };
+
+	// Three frames, the last one ending with a cursor event
+	auto record{ [&path]()
+		{
+			InputSystem recorder{};
+			recorder.open(InputMode::record, path.c_str());
+			recorder.onKey(0.0, keyA, 1);
+			recorder.onCursor(0.0, 10.0, 20.0);
+			recorder.beginFrame(0.25f);
+			recorder.onKey(0.1, keyA, 0);
+			recorder.beginFrame(0.5f);
+			recorder.onKey(0.2, keyB, 1);
+			recorder.onCursor(0.2, 30.0, 40.0);
+			recorder.beginFrame(0.75f);
+		} };
+
+	runner.run("input/replay_truncated", [&]()
+		{
+			record();
+			// Cuts into the cursor event, the key event of the same frame is still whole
+			std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+			InputSystem replay{};
+			TEST_CHECK(replay.open(InputMode::replay, path.c_str()));
+			TEST_CHECK(replay.beginFrame(1.0f) == 0.25f);
+			TEST_CHECK(replay.isKeyDown(keyA));
+			TEST_CHECK(replay.beginFrame(1.0f) == 0.5f);
+			TEST_CHECK(!replay.isKeyDown(keyA));
+			TEST_CHECK(replay.beginFrame(1.0f) == 1.0f);
+			TEST_CHECK(!replay.isKeyDown(keyB));
+			TEST_CHECK(replay.getFrameEvents().empty());
+			TEST_CHECK(replay.getMode() == InputMode::live);
+			std::filesystem::remove(path);
+		});
+
+	runner.run("input/replay_quit_key", [&]()
+		{
+			record();
+
+			InputSystem replay{};
+			replay.setQuitKey(keyEscape);
+			TEST_CHECK(replay.open(InputMode::replay, path.c_str()));
+			replay.onKey(0.0, keyB, 1);
+			replay.onKey(0.0, keyEscape, 1);
+			replay.beginFrame(1.0f);
+			TEST_CHECK(replay.wasKeyPressed(keyEscape));
+			TEST_CHECK(replay.isKeyDown(keyA));
+			TEST_CHECK(!replay.isKeyDown(keyB));
+			std::filesystem::remove(path);
+		});
+}
+
+/*
+* Steps the parts of the frame loop that need no window, input, camera, frame arena,
+* particles and draw list merging, and checks that once warmed up no frame allocates
+* Parameters:
+* - runner: Runner the cases are run with
+* Returns: void
+*/
+void testFrameAllocations(test::Runner& runner)
+{
+	runner.run("frame/allocations", []()
+		{
+			// Same warm up as the frame loop, containers are still growing to their working size
+			constexpr int warmupFrames{ 120 };
+			constexpr int steadyFrames{ 300 };
+			constexpr float deltaTime{ 1.0f / 60.0f };
+			// GLFW key codes, the test doesn't include GLFW
+			constexpr int keyW{ 87 };
+			constexpr int keyD{ 68 };
+
+			JobSystem jobs{ 2 };
+			InputSystem input{};
+			Camera camera{ glm::vec3(0.0f, 2.0f, 0.0f) };
+			LinearArena frameArena{ 256 * 1024 };
+			TerrainGenerator terrain{};
+
+			ParticleSystem particles{ 65536 };
+			ParticleEffect embers{};
+			embers.velocityMin = glm::vec3(-0.3f, 0.6f, -0.3f);
+			embers.velocityMax = glm::vec3(0.3f, 1.4f, 0.3f);
+			embers.lifetimeMin = 1.5f;
+			embers.lifetimeMax = 3.0f;
+			ParticleEmitters emitters{};
+			emitters.add(BlockEmitter{ BlockType::lava, particles.addEffect(embers), 0.5f, 0.0f });
+			emitters.add(BlockEmitter{ BlockType::grass, particles.addEffect(embers), 0.05f, 0.0f });
+			auto surfaceBlock{ [&terrain](int x, int z, int& height)
+				{
+					TerrainColumn column{ terrain.getColumn(x, z) };
+					height = std::max(column.height, column.lavaTop);
+					return TerrainGenerator::blockInColumn(column, height);
+				} };
+			std::vector<ParticleInstance> instances(static_cast<std::size_t>(particles.getCapacity()));
+
+			// Cubes in a grid around the camera, culled into partial lists like the draw list builder
+			std::vector<glm::vec3> cubes{};
+			for (int z{ -16 }; z < 16; ++z)
+			{
+				for (int x{ -16 }; x < 16; ++x)
+					cubes.push_back(glm::vec3(static_cast<float>(x) * 3.0f, 1.0f, static_cast<float>(z) * 3.0f));
+			}
+			constexpr int cubesPerJob{ 64 };
+			int cubeJobs{ (static_cast<int>(cubes.size()) + cubesPerJob - 1) / cubesPerJob };
+			// Sized for every cube up front, how many are visible changes as the camera turns
+			std::vector<DrawList> partials(static_cast<std::size_t>(cubeJobs));
+			for (DrawList& partial : partials)
+				partial.commands.reserve(cubesPerJob);
+			DrawList merged{};
+			merged.commands.reserve(cubes.size());
+
+			int allocatingFrames{ 0 };
+			for (int frame{ 0 }; frame < warmupFrames + steadyFrames; ++frame)
+			{
+				AllocationScope allocationScope{};
+				frameArena.reset();
+
+				// A key held for a while and a mouse circling, the events the window callbacks queue
+				double time{ frame * static_cast<double>(deltaTime) };
+				input.onKey(time, frame % 40 < 20 ? keyW : keyD, frame % 20 == 0 ? 1 : 2);
+				input.onCursor(time, 400.0 + 50.0 * std::cos(time), 300.0 + 50.0 * std::sin(time));
+				float frameDeltaTime{ input.beginFrame(deltaTime) };
+				for (const InputEvent& event : input.getFrameEvents())
+					camera.processMouseMovement(event.x, event.y);
+				if (input.isKeyDown(keyW))
+					camera.processKeyboard(forward, frameDeltaTime);
+				if (input.isKeyDown(keyD))
+					camera.processKeyboard(right, frameDeltaTime);
+
+				glm::vec3 position{ camera.getPosition() };
+				TerrainColumn ground{ terrain.getColumn(static_cast<int>(position.x), static_cast<int>(position.z)) };
+				camera.setGroundHeight(static_cast<float>(ground.height) + 2.0f);
+				camera.updateJump(frameDeltaTime);
+
+				glm::mat4 projection{ glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 500.0f) };
+				Frustum frustum{ Frustum::fromMatrix(projection * camera.getViewMatrix()) };
+
+				int* scratch{ frameArena.allocateArray<int>(1024) };
+				TEST_CHECK(scratch != nullptr);
+
+				jobs.parallelFor(0, cubeJobs, 1, [&](int first, int last)
+					{
+						for (int job{ first }; job < last; ++job)
+						{
+							DrawList& list{ partials[job] };
+							list.clear();
+							int end{ std::min(static_cast<int>(cubes.size()), (job + 1) * cubesPerJob) };
+							for (int i{ job * cubesPerJob }; i < end; ++i)
+							{
+								if (frustum.intersectsSphere(cubes[i], 0.8660254f))
+									list.add(i % 2 == 0 ? DrawPass::lit : DrawPass::unlit, i % 5, i * 64, 1, glm::length(cubes[i] - position));
+							}
+						}
+					});
+				merged.clear();
+				for (const DrawList& partial : partials)
+					merged.append(partial);
+				merged.sort(frame % 2 == 0 ? DrawOrder::frontToBack : DrawOrder::material);
+
+				emitters.emit(particles, position, frameDeltaTime, surfaceBlock);
+				particles.update(frameDeltaTime, glm::vec3(0.6f, 0.0f, 0.0f), jobs);
+				particles.writeInstances(instances.data(), jobs);
+
+				if (frame >= warmupFrames && allocationScope.getCount() > 0)
+				{
+					if (allocatingFrames == 0)
+					{
+						std::cout << "    frame " << frame << " made " << allocationScope.getCount() << " allocations ("
+							<< allocationScope.getBytes() << " bytes)\n";
+					}
+					++allocatingFrames;
+				}
+			}
+
+			TEST_CHECK(particles.getCount() > 0);
+			TEST_CHECK(allocatingFrames == 0);
+		});
+}
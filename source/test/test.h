@@ -0,0 +1,180 @@
+/*
+* File: test.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program runs the test cases of the test executable. A case is a
+			   callable that reports failed checks through TEST_CHECK, and a watchdog
+			   fails a case that hasn't returned within its time limit, so a deadlock
+			   shows up as a failure instead of a hung run
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace test
+{
+	struct Options
+	{
+		// Only cases whose name starts with this run, empty runs everything
+		std::string filter{};
+		// Print the names of the cases instead of running them
+		bool list{ false };
+		// A case still running after this long fails the whole run
+		double timeoutSeconds{ 60.0 };
+	};
+
+	// Failed checks of the case that is running
+	inline int s_failedChecks{ 0 };
+
+	inline void check(bool condition, const char* expression, const char* file, int line)
+	{
+		if (condition)
+			return;
+
+		++s_failedChecks;
+		std::printf("    check failed: %s (%s:%d)\n", expression, file, line);
+	}
+
+	class Runner
+	{
+	public:
+		explicit Runner(Options options)
+			: m_options{ std::move(options) }
+		{
+			m_watchdog = std::thread{ [this]() { watch(); } };
+		}
+
+		~Runner()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				m_stopping = true;
+			}
+			m_wakeUp.notify_one();
+			m_watchdog.join();
+		}
+
+		Runner(const Runner&) = delete;
+		Runner& operator=(const Runner&) = delete;
+
+		/*
+		* Checks a group of cases against the filter, for skipping expensive setup
+		* Parameters:
+		* - group: Name prefix shared by the cases of the group
+		* Returns: True if any case of the group may run
+		*/
+		bool wants(const std::string& group) const
+		{
+			return startsWith(group, m_options.filter) || startsWith(m_options.filter, group);
+		}
+
+		/*
+		* Runs a case and records whether all of its checks passed
+		* Parameters:
+		* - name: Unique name, groups separated by '/'
+		* - function: Callable running the case
+		* Returns: void
+		*/
+		template <typename Function>
+		void run(const std::string& name, Function&& function)
+		{
+			if (!startsWith(name, m_options.filter))
+				return;
+			if (m_options.list)
+			{
+				std::cout << name << '\n';
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				m_current = name;
+				m_deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(m_options.timeoutSeconds));
+				m_running = true;
+			}
+			m_wakeUp.notify_one();
+
+			s_failedChecks = 0;
+			auto start{ std::chrono::steady_clock::now() };
+			function();
+			double elapsedMs{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() };
+
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				m_running = false;
+			}
+
+			++m_run;
+			if (s_failedChecks > 0)
+				++m_failed;
+			std::printf("%-6s %-62s %10.1f ms\n", s_failedChecks > 0 ? "FAIL" : "ok", name.c_str(), elapsedMs);
+		}
+
+		/*
+		* Prints the summary
+		* Parameters: None
+		* Returns: The exit code of the run, 1 if any case failed
+		*/
+		int finish() const
+		{
+			if (!m_options.list)
+				std::printf("%d cases, %d failed\n", m_run, m_failed);
+			return m_failed > 0 ? 1 : 0;
+		}
+
+	private:
+		Options m_options{};
+		int m_run{ 0 };
+		int m_failed{ 0 };
+
+		std::thread m_watchdog{};
+		std::mutex m_mutex{};
+		std::condition_variable m_wakeUp{};
+		std::string m_current{};
+		std::chrono::steady_clock::time_point m_deadline{};
+		bool m_running{ false };
+		bool m_stopping{ false };
+
+		// Watchdog thread, a hung case can't be stopped so the process exits
+		void watch()
+		{
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			while (!m_stopping)
+			{
+				if (!m_running)
+				{
+					m_wakeUp.wait(lock);
+					continue;
+				}
+
+				if (m_wakeUp.wait_until(lock, m_deadline) == std::cv_status::timeout && m_running && std::chrono::steady_clock::now() >= m_deadline)
+				{
+					std::printf("FAIL   %s timed out after %.0f s\n", m_current.c_str(), m_options.timeoutSeconds);
+					std::fflush(stdout);
+					std::_Exit(1);
+				}
+			}
+		}
+
+		static bool startsWith(const std::string& text, const std::string& prefix)
+		{
+			return text.compare(0, prefix.size(), prefix) == 0;
+		}
+	};
+}
+
+// Records a failed check of the running case without stopping it
+#define TEST_CHECK(condition) test::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+#endif
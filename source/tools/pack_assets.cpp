@@ -0,0 +1,145 @@
+/*
+* File: pack_assets.cpp
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program bundles asset directories into one archive for the
+			   engine to map at startup. Paths are stored relative to the working
+			   directory, the same paths the engine opens them by. Run from the
+			   repository root:
+			   pack_assets assets.pak source/shader resource
+*/
+
+#include "../io/asset_archive.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+struct PackedFile
+{
+	std::string path{};
+	std::vector<char> data{};
+	assetArchive::Entry entry{};
+};
+
+/*
+* Pads the archive with zeros up to a multiple of the alignment
+* Parameters:
+* - out: Archive being written
+* - offset: Current size of the archive, moved to the padded size
+* - alignment: Power of two boundary
+* Returns: void
+*/
+void pad(std::ofstream& out, std::uint64_t& offset, std::uint64_t alignment)
+{
+	static const char zeros[assetArchive::alignment]{};
+	std::uint64_t padding{ (alignment - offset % alignment) % alignment };
+	out.write(zeros, static_cast<std::streamsize>(padding));
+	offset += padding;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cout << "Usage: pack_assets <archive> <directory>...\n";
+		return 1;
+	}
+
+	std::vector<PackedFile> files{};
+	for (int i{ 2 }; i < argc; ++i)
+	{
+		std::error_code error{};
+		for (std::filesystem::recursive_directory_iterator it{ argv[i], error }, end{}; !error && it != end; it.increment(error))
+		{
+			if (!it->is_regular_file())
+				continue;
+
+			PackedFile file{};
+			file.path = it->path().generic_string();
+			std::ifstream in{ it->path(), std::ios::binary };
+			file.data.assign(std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{});
+			if (!in.good() && !in.eof())
+			{
+				std::cout << "ERROR::PACK_ASSETS::READ_FAILED: " << file.path << '\n';
+				return 1;
+			}
+			files.push_back(std::move(file));
+		}
+		if (error)
+		{
+			std::cout << "ERROR::PACK_ASSETS::DIRECTORY: " << argv[i] << ": " << error.message() << '\n';
+			return 1;
+		}
+	}
+
+	for (PackedFile& file : files)
+		file.entry.hash = assetArchive::hashPath(file.path);
+
+	// The runtime binary searches the table by hash
+	std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b)
+		{
+			return a.entry.hash != b.entry.hash ? a.entry.hash < b.entry.hash : a.path < b.path;
+		});
+
+	std::ofstream out{ argv[1], std::ios::binary | std::ios::trunc };
+	if (!out)
+	{
+		std::cout << "ERROR::PACK_ASSETS::OPEN_FAILED: " << argv[1] << '\n';
+		return 1;
+	}
+
+	// Header and table are written last, once the offsets are known
+	assetArchive::Header header{};
+	std::memcpy(header.magic, assetArchive::magic, sizeof(header.magic));
+	header.version = assetArchive::version;
+	header.entryCount = static_cast<std::uint32_t>(files.size());
+
+	std::uint64_t offset{ sizeof(header) };
+	std::vector<char> placeholder(sizeof(header), 0);
+	out.write(placeholder.data(), static_cast<std::streamsize>(placeholder.size()));
+
+	std::uint64_t totalBytes{ 0 };
+	for (PackedFile& file : files)
+	{
+		pad(out, offset, assetArchive::alignment);
+		file.entry.offset = offset;
+		file.entry.size = file.data.size();
+		out.write(file.data.data(), static_cast<std::streamsize>(file.data.size()));
+		offset += file.data.size();
+		totalBytes += file.data.size();
+	}
+
+	pad(out, offset, alignof(assetArchive::Entry));
+	header.tableOffset = offset;
+	header.pathsOffset = offset + sizeof(assetArchive::Entry) * files.size();
+
+	std::uint32_t pathOffset{ 0 };
+	for (PackedFile& file : files)
+	{
+		file.entry.pathOffset = pathOffset;
+		file.entry.pathLength = static_cast<std::uint32_t>(file.path.size());
+		pathOffset += file.entry.pathLength;
+		out.write(reinterpret_cast<const char*>(&file.entry), sizeof(file.entry));
+	}
+	for (const PackedFile& file : files)
+		out.write(file.path.data(), static_cast<std::streamsize>(file.path.size()));
+
+	out.seekp(0);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.close();
+	if (!out)
+	{
+		std::cout << "ERROR::PACK_ASSETS::WRITE_FAILED: " << argv[1] << '\n';
+		return 1;
+	}
+
+	std::cout << "Packed " << files.size() << " files, " << totalBytes << " bytes, into " << argv[1] << '\n';
+	return 0;
+}
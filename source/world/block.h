@@ -0,0 +1,38 @@
+/*
+* File: block.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program defines the block types of the world. Each solid
+			   block type also indexes its material in the renderer
+*/
+
+#ifndef BLOCK_H
+#define BLOCK_H
+
+#include <cstdint>
+
+enum class BlockType : std::uint8_t
+{
+	air,
+	grass,
+	dirt,
+	snow,
+	lava,
+	pumpkin,
+	iron,
+};
+
+constexpr int blockTypeCount{ 7 };
+
+inline bool isSolid(BlockType block)
+{
+	return block != BlockType::air;
+}
+
+// Block light a block gives off, from 0 for none up to 15
+inline int lightEmission(BlockType block)
+{
+	return block == BlockType::lava ? 15 : 0;
+}
+
+#endif
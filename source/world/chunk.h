@@ -0,0 +1,174 @@
+/*
+* File: chunk.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program defines a chunk, a column of blocks that the world
+			   is generated, stored and rendered in. The column is split into
+			   palette-compressed sections, so sections of only air or only dirt
+			   cost a single palette entry
+*/
+
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include "block.h"
+#include "palette_storage.h"
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+struct ChunkCoord
+{
+	int x{};
+	int z{};
+
+	bool operator==(const ChunkCoord& other) const
+	{
+		return x == other.x && z == other.z;
+	}
+
+	bool operator!=(const ChunkCoord& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+struct ChunkCoordHash
+{
+	std::size_t operator()(const ChunkCoord& coord) const
+	{
+		return std::hash<unsigned long long>{}((static_cast<unsigned long long>(static_cast<unsigned int>(coord.x)) << 32) | static_cast<unsigned int>(coord.z));
+	}
+};
+
+class Chunk
+{
+public:
+	static constexpr int sizeX{ 16 };
+	static constexpr int sizeY{ 64 };
+	static constexpr int sizeZ{ 16 };
+	static constexpr int volume{ sizeX * sizeY * sizeZ };
+
+	static constexpr int sectionHeight{ 16 };
+	static constexpr int sectionCount{ sizeY / sectionHeight };
+	static constexpr int sectionVolume{ sizeX * sectionHeight * sizeZ };
+
+	// World y of the lowest block layer
+	static constexpr int minY{ -16 };
+
+	ChunkCoord coord{};
+
+	explicit Chunk(ChunkCoord chunkCoord = ChunkCoord{})
+		: coord{ chunkCoord }
+	{
+		for (PaletteStorage& section : m_sections)
+			section = PaletteStorage{ sectionVolume, BlockType::air };
+	}
+
+	/*
+	* Reads a block by local coordinates
+	* Parameters:
+	* - x: Local x in [0, sizeX)
+	* - y: Local y in [0, sizeY), world y minus minY
+	* - z: Local z in [0, sizeZ)
+	* Returns: The block type
+	*/
+	BlockType get(int x, int y, int z) const
+	{
+		return m_sections[y / sectionHeight].get(index(x, y % sectionHeight, z));
+	}
+
+	void set(int x, int y, int z, BlockType block)
+	{
+		m_sections[y / sectionHeight].set(index(x, y % sectionHeight, z), block);
+		m_dirty = true;
+	}
+
+	// Shrinks every section's palette after bulk edits such as generation
+	void compact()
+	{
+		for (PaletteStorage& section : m_sections)
+			section.compact();
+	}
+
+	const PaletteStorage& getSection(int section) const
+	{
+		return m_sections[section];
+	}
+
+	void setSection(int section, PaletteStorage storage)
+	{
+		m_sections[section] = std::move(storage);
+		m_dirty = true;
+	}
+
+	// True when the blocks changed since the chunk was generated, loaded or saved
+	bool isDirty() const
+	{
+		return m_dirty;
+	}
+
+	void clearDirty()
+	{
+		m_dirty = false;
+	}
+
+	std::size_t memoryUsage() const
+	{
+		std::size_t bytes{ sizeof(*this) - sizeof(m_sections) };
+		for (const PaletteStorage& section : m_sections)
+			bytes += section.memoryUsage();
+		return bytes;
+	}
+
+	static bool contains(int x, int y, int z)
+	{
+		return x >= 0 && x < sizeX && y >= 0 && y < sizeY && z >= 0 && z < sizeZ;
+	}
+
+	// World x of the chunk's local x = 0 column
+	int worldX() const
+	{
+		return coord.x * sizeX;
+	}
+
+	int worldZ() const
+	{
+		return coord.z * sizeZ;
+	}
+
+	/*
+	* Finds the chunk a world position lies in. Blocks are centered on integer
+	* coordinates, so block n spans [n - 0.5, n + 0.5)
+	* Parameters:
+	* - x: World x-coordinate
+	* - z: World z-coordinate
+	* Returns: Coordinate of the containing chunk
+	*/
+	static ChunkCoord coordAt(float x, float z)
+	{
+		int blockX{ static_cast<int>(std::floor(x + 0.5f)) };
+		int blockZ{ static_cast<int>(std::floor(z + 0.5f)) };
+		return ChunkCoord{ floorDiv(blockX, sizeX), floorDiv(blockZ, sizeZ) };
+	}
+
+	static int floorDiv(int value, int divisor)
+	{
+		return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+	}
+
+private:
+	// Filled in the constructor, sections are stacked bottom to top
+	PaletteStorage m_sections[sectionCount];
+	bool m_dirty{ false };
+
+	// Index within a section, y is local to the section
+	static int index(int x, int y, int z)
+	{
+		return (y * sizeZ + z) * sizeX + x;
+	}
+};
+
+#endif
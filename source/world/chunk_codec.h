@@ -0,0 +1,179 @@
+/*
+* File: chunk_codec.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program compresses a chunk into a self contained byte payload
+			   and back. Every section stores its palette followed by runs of
+			   palette indices, so uniform sections cost a couple of bytes
+*/
+
+#ifndef CHUNK_CODEC_H
+#define CHUNK_CODEC_H
+
+#include "block.h"
+#include "chunk.h"
+#include "palette_storage.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+* Payload layout, all values little-endian:
+* uint16 section count, then per section a uint8 palette size and the palette
+* block types. Sections with more than one palette entry follow with a uint16
+* run count and runs of uint8 palette index + uint16 length in index order
+*/
+namespace chunkcodec
+{
+	inline void writeU16(std::vector<std::uint8_t>& out, std::uint16_t value)
+	{
+		out.push_back(static_cast<std::uint8_t>(value & 0xFF));
+		out.push_back(static_cast<std::uint8_t>(value >> 8));
+	}
+
+	// Bounds checked cursor over a payload
+	struct Reader
+	{
+		const std::uint8_t* data{};
+		const std::uint8_t* end{};
+
+		bool readU8(std::uint8_t& value)
+		{
+			if (end - data < 1)
+				return false;
+			value = *data++;
+			return true;
+		}
+
+		bool readU16(std::uint16_t& value)
+		{
+			if (end - data < 2)
+				return false;
+			value = static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+			data += 2;
+			return true;
+		}
+	};
+}
+
+/*
+* Appends the compressed blocks of a chunk to a byte buffer
+* Parameters:
+* - chunk: Chunk to encode
+* - out: Buffer the payload is appended to
+* Returns: void
+*/
+inline void encodeChunk(const Chunk& chunk, std::vector<std::uint8_t>& out)
+{
+	chunkcodec::writeU16(out, static_cast<std::uint16_t>(Chunk::sectionCount));
+
+	for (int section{ 0 }; section < Chunk::sectionCount; ++section)
+	{
+		const PaletteStorage& storage{ chunk.getSection(section) };
+		const std::vector<BlockType>& palette{ storage.getPalette() };
+
+		out.push_back(static_cast<std::uint8_t>(palette.size()));
+		for (BlockType block : palette)
+			out.push_back(static_cast<std::uint8_t>(block));
+
+		if (palette.size() == 1)
+			continue;
+
+		std::uint8_t paletteIndex[blockTypeCount]{};
+		for (std::size_t i{ 0 }; i < palette.size(); ++i)
+			paletteIndex[static_cast<int>(palette[i])] = static_cast<std::uint8_t>(i);
+
+		// The run count is patched in once the runs are known
+		std::size_t runCountAt{ out.size() };
+		chunkcodec::writeU16(out, 0);
+
+		std::uint16_t runs{ 0 };
+		for (int i{ 0 }; i < Chunk::sectionVolume; )
+		{
+			BlockType block{ storage.get(i) };
+			int length{ 1 };
+			while (i + length < Chunk::sectionVolume && length < 0xFFFF && storage.get(i + length) == block)
+				++length;
+
+			out.push_back(paletteIndex[static_cast<int>(block)]);
+			chunkcodec::writeU16(out, static_cast<std::uint16_t>(length));
+			++runs;
+			i += length;
+		}
+
+		out[runCountAt] = static_cast<std::uint8_t>(runs & 0xFF);
+		out[runCountAt + 1] = static_cast<std::uint8_t>(runs >> 8);
+	}
+}
+
+/*
+* Restores the blocks of a chunk from a payload written by encodeChunk. The chunk
+* is left compacted and clean
+* Parameters:
+* - data: Pointer to the payload
+* - size: Size of the payload in bytes
+* - chunk: Chunk whose sections are replaced
+* Returns: False if the payload is truncated or malformed
+*/
+inline bool decodeChunk(const std::uint8_t* data, std::size_t size, Chunk& chunk)
+{
+	chunkcodec::Reader reader{ data, data + size };
+
+	std::uint16_t sectionCount{};
+	if (!reader.readU16(sectionCount) || sectionCount != Chunk::sectionCount)
+		return false;
+
+	for (int section{ 0 }; section < Chunk::sectionCount; ++section)
+	{
+		std::uint8_t paletteSize{};
+		if (!reader.readU8(paletteSize) || paletteSize == 0 || paletteSize > blockTypeCount)
+			return false;
+
+		BlockType palette[blockTypeCount]{};
+		for (int i{ 0 }; i < paletteSize; ++i)
+		{
+			std::uint8_t block{};
+			if (!reader.readU8(block) || block >= blockTypeCount)
+				return false;
+			palette[i] = static_cast<BlockType>(block);
+		}
+
+		PaletteStorage storage{ Chunk::sectionVolume, palette[0] };
+		if (paletteSize > 1)
+		{
+			std::uint16_t runs{};
+			if (!reader.readU16(runs))
+				return false;
+
+			int next{ 0 };
+			for (int run{ 0 }; run < runs; ++run)
+			{
+				std::uint8_t paletteIndex{};
+				std::uint16_t length{};
+				if (!reader.readU8(paletteIndex) || !reader.readU16(length) || paletteIndex >= paletteSize || length > Chunk::sectionVolume - next)
+					return false;
+
+				// The storage starts filled with the first entry, those runs are already in place
+				if (paletteIndex != 0)
+				{
+					for (int i{ next }; i < next + length; ++i)
+						storage.set(i, palette[paletteIndex]);
+				}
+				next += length;
+			}
+
+			if (next != Chunk::sectionVolume)
+				return false;
+			storage.compact();
+		}
+
+		chunk.setSection(section, std::move(storage));
+	}
+
+	chunk.clearDirty();
+	return true;
+}
+
+#endif
@@ -0,0 +1,156 @@
+/*
+* File: chunk_light.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program propagates sky light and block light through a chunk
+			   with a breadth first flood fill. Sky light falls straight down from
+			   the top of the world and spreads sideways under overhangs, block light
+			   spreads out from emitting blocks such as lava. Each step away from a
+			   source costs one of the 15 levels
+*/
+
+#ifndef CHUNK_LIGHT_H
+#define CHUNK_LIGHT_H
+
+#include "block.h"
+#include "chunk.h"
+
+#include <cstdint>
+#include <vector>
+
+class ChunkLight
+{
+public:
+	static constexpr int maxLevel{ 15 };
+
+	// Blocks of the neighbouring chunks included around the chunk, enough for face
+	// culling and ambient occlusion. Light from further into a neighbour doesn't cross
+	static constexpr int border{ 1 };
+	static constexpr int sizeX{ Chunk::sizeX + 2 * border };
+	static constexpr int sizeY{ Chunk::sizeY };
+	static constexpr int sizeZ{ Chunk::sizeZ + 2 * border };
+	static constexpr int volume{ sizeX * sizeY * sizeZ };
+
+	/*
+	* Lights a chunk and the border around it
+	* Parameters:
+	* - chunk: Chunk to light
+	* - outside: Callable returning the BlockType at world (x, y, z) for blocks outside the chunk
+	* Returns: void
+	*/
+	template <typename OutsideBlock>
+	void compute(const Chunk& chunk, const OutsideBlock& outside)
+	{
+		m_opaque.assign(volume, 0);
+		m_sky.assign(volume, 0);
+		m_block.assign(volume, 0);
+		m_queue.clear();
+
+		for (int y{ 0 }; y < sizeY; ++y)
+		{
+			for (int z{ -border }; z < Chunk::sizeZ + border; ++z)
+			{
+				for (int x{ -border }; x < Chunk::sizeX + border; ++x)
+				{
+					BlockType block{ Chunk::contains(x, y, z) ? chunk.get(x, y, z) : outside(chunk.worldX() + x, Chunk::minY + y, chunk.worldZ() + z) };
+					int cell{ index(x, y, z) };
+					m_opaque[cell] = isSolid(block) ? 1 : 0;
+					m_block[cell] = static_cast<std::uint8_t>(lightEmission(block));
+				}
+			}
+		}
+
+		// Full sky light down every column until the first opaque block
+		for (int z{ -border }; z < Chunk::sizeZ + border; ++z)
+		{
+			for (int x{ -border }; x < Chunk::sizeX + border; ++x)
+			{
+				for (int y{ sizeY - 1 }; y >= 0 && !m_opaque[index(x, y, z)]; --y)
+				{
+					m_sky[index(x, y, z)] = maxLevel;
+					m_queue.push_back(index(x, y, z));
+				}
+			}
+		}
+		propagate(m_sky);
+
+		for (int cell{ 0 }; cell < volume; ++cell)
+		{
+			if (m_block[cell] > 0)
+				m_queue.push_back(cell);
+		}
+		propagate(m_block);
+	}
+
+	/*
+	* Local coordinates may reach border blocks into the neighbours. Below the world
+	* counts as solid ground and above it as open sky
+	*/
+	bool isOpaque(int x, int y, int z) const
+	{
+		if (y < 0)
+			return true;
+		if (y >= sizeY)
+			return false;
+		return m_opaque[index(x, y, z)] != 0;
+	}
+
+	int getSkyLight(int x, int y, int z) const
+	{
+		if (y < 0)
+			return 0;
+		if (y >= sizeY)
+			return maxLevel;
+		return m_sky[index(x, y, z)];
+	}
+
+	int getBlockLight(int x, int y, int z) const
+	{
+		if (y < 0 || y >= sizeY)
+			return 0;
+		return m_block[index(x, y, z)];
+	}
+
+private:
+	std::vector<std::uint8_t> m_opaque{};
+	std::vector<std::uint8_t> m_sky{};
+	std::vector<std::uint8_t> m_block{};
+	std::vector<int> m_queue{};
+
+	static int index(int x, int y, int z)
+	{
+		return ((y * sizeZ) + (z + border)) * sizeX + (x + border);
+	}
+
+	// Spreads the queued cells' light to their neighbours, one level lost per step
+	void propagate(std::vector<std::uint8_t>& levels)
+	{
+		constexpr int steps[6]{ 1, -1, sizeX, -sizeX, sizeX * sizeZ, -sizeX * sizeZ };
+
+		for (std::size_t head{ 0 }; head < m_queue.size(); ++head)
+		{
+			int cell{ m_queue[head] };
+			int level{ levels[cell] };
+			if (level <= 1)
+				continue;
+
+			int x{ cell % sizeX };
+			int z{ (cell / sizeX) % sizeZ };
+			int y{ cell / (sizeX * sizeZ) };
+			const bool inside[6]{ x + 1 < sizeX, x > 0, z + 1 < sizeZ, z > 0, y + 1 < sizeY, y > 0 };
+
+			for (int i{ 0 }; i < 6; ++i)
+			{
+				int neighbour{ cell + steps[i] };
+				if (!inside[i] || m_opaque[neighbour] || levels[neighbour] >= level - 1)
+					continue;
+
+				levels[neighbour] = static_cast<std::uint8_t>(level - 1);
+				m_queue.push_back(neighbour);
+			}
+		}
+		m_queue.clear();
+	}
+};
+
+#endif
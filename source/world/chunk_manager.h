@@ -0,0 +1,867 @@
+/*
+* File: chunk_manager.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program streams chunks in a radius around the camera. Chunks are
+			   loaded from their region file or generated and meshed on the job system,
+			   uploaded a few per frame into a shared vertex pool and unloaded least
+			   recently used first once the cache is full, saving edited chunks in the
+			   background. Visible chunks are culled on the job system or, with GL 4.3, on the GPU
+*/
+
+#ifndef CHUNK_MANAGER_H
+#define CHUNK_MANAGER_H
+
+#include "chunk.h"
+#include "chunk_mesher.h"
+#include "region_file.h"
+#include "terrain.h"
+#include "../job/job_system.h"
+#include "../memory/linear_arena.h"
+#include "../render/frustum.h"
+#include "../render/gpu_culling.h"
+#include "../render/vertex_pool.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class ChunkManager
+{
+public:
+	static_assert(blockTypeCount <= CullObject::maxMaterials, "Every block type needs a material slot in the cull objects");
+	static_assert(ChunkMesh::floatsPerVertex == VertexPool::floatsPerVertex, "Chunk meshes are copied into the pool as they are");
+
+	/*
+	* Creates the manager, nothing is loaded until the first update
+	* Parameters:
+	* - jobs: Job system generation and meshing run on
+	* - generator: Terrain generator the chunks are filled by
+	* - regions: Region files chunks are loaded from and saved to, nullptr keeps the world in memory only
+	* - viewRadius: Radius in chunks that is kept loaded around the camera
+	* - uploadsPerFrame: Maximum number of chunk meshes uploaded to the GPU per frame
+	* Returns: ChunkManager object
+	*/
+	ChunkManager(JobSystem& jobs, const TerrainGenerator& generator, RegionStore* regions = nullptr, int viewRadius = 6, int uploadsPerFrame = 2)
+		: m_jobs{ jobs }
+		, m_generator{ generator }
+		, m_regions{ regions }
+		, m_uploadsPerFrame{ uploadsPerFrame }
+		, m_viewRadius{ viewRadius }
+		, m_maxInFlight{ std::max(2, jobs.getThreadCount() * 2) }
+	{
+		for (int dz{ -viewRadius }; dz <= viewRadius; ++dz)
+		{
+			for (int dx{ -viewRadius }; dx <= viewRadius; ++dx)
+			{
+				if (dx * dx + dz * dz <= viewRadius * viewRadius)
+					m_offsets.push_back(ChunkCoord{ dx, dz });
+			}
+		}
+
+		// Nearest chunks are requested first
+		std::sort(m_offsets.begin(), m_offsets.end(), [](const ChunkCoord& a, const ChunkCoord& b)
+			{
+				return a.x * a.x + a.z * a.z < b.x * b.x + b.z * b.z;
+			});
+
+		// Room for the view area plus a ring, so turning back doesn't regenerate everything
+		int cacheRadius{ viewRadius + 2 };
+		m_capacity = static_cast<std::size_t>(3.1416f * cacheRadius * cacheRadius);
+		m_cullObjects.reserve(m_capacity + static_cast<std::size_t>(uploadsPerFrame));
+	}
+
+	~ChunkManager()
+	{
+		m_jobs.wait(m_inFlight);
+
+		for (auto& [coord, loaded] : m_loaded)
+		{
+			if (loaded.chunk->isDirty())
+				saveChunk(std::move(loaded.chunk));
+			unload(loaded);
+		}
+		m_jobs.wait(m_saving);
+	}
+
+	ChunkManager(const ChunkManager&) = delete;
+	ChunkManager& operator=(const ChunkManager&) = delete;
+
+	/*
+	* Requests missing chunks around the camera, uploads finished ones and
+	* evicts the least recently used chunks when over capacity
+	* Parameters:
+	* - cameraPosition: World position of the camera
+	* Returns: void
+	*/
+	void update(const glm::vec3& cameraPosition)
+	{
+		++m_frame;
+		m_center = Chunk::coordAt(cameraPosition.x, cameraPosition.z);
+		if (!m_drawCenterPinned && m_center != m_drawCenter)
+		{
+			m_drawCenter = m_center;
+			updateDrawn();
+		}
+
+		for (const ChunkCoord& offset : m_offsets)
+		{
+			ChunkCoord coord{ m_center.x + offset.x, m_center.z + offset.z };
+
+			auto loaded{ m_loaded.find(coord) };
+			if (loaded != m_loaded.end())
+			{
+				loaded->second.lastUsed = m_frame;
+				continue;
+			}
+
+			// A chunk still being saved is loaded once its save has landed
+			if (m_inFlight.value.load(std::memory_order_relaxed) < m_maxInFlight && !isSaving(coord) && m_pending.insert(coord).second)
+				requestChunk(coord);
+		}
+
+		uploadFinished();
+		evictLeastRecentlyUsed();
+	}
+
+	/*
+	* Draws the visible chunks grouped by block type so each material is bound once,
+	* nearest chunk first within a type. The chunk shader must be in use, the chunks
+	* are already lit
+	* Parameters:
+	* - frustum: View frustum of the camera
+	* - position: World position of the camera
+	* - bindMaterial: Callable taking a BlockType that binds its textures
+	* Returns: void
+	*/
+	template <typename BindMaterial>
+	void draw(const Frustum& frustum, const glm::vec3& position, const BindMaterial& bindMaterial)
+	{
+		bindVertexArray();
+		collectVisible(frustum, position);
+
+		for (int type{ 1 }; type < blockTypeCount; ++type)
+		{
+			bool bound{ false };
+			for (const VisibleChunk& visible : m_visible)
+			{
+				const LoadedChunk* loaded{ visible.chunk };
+				const ChunkMeshRange& range{ loaded->ranges[type] };
+				if (range.count == 0)
+					continue;
+
+				if (!bound)
+				{
+					bindMaterial(static_cast<BlockType>(type));
+					bound = true;
+				}
+
+				glDrawArrays(GL_TRIANGLES, loaded->first + range.first, range.count);
+			}
+		}
+		glBindVertexArray(0);
+	}
+
+	/*
+	* Draws the whole mesh of every visible chunk, nearest first with one call per chunk.
+	* For passes that bind no material, such as the depth pre-pass
+	* Parameters:
+	* - frustum: View frustum of the camera
+	* - position: World position of the camera
+	* Returns: void
+	*/
+	void drawDepth(const Frustum& frustum, const glm::vec3& position)
+	{
+		bindVertexArray();
+		collectVisible(frustum, position);
+
+		for (const VisibleChunk& visible : m_visible)
+			glDrawArrays(GL_TRIANGLES, visible.chunk->first, visible.chunk->vertexCount);
+		glBindVertexArray(0);
+	}
+
+	/*
+	* Culls every loaded chunk on the GPU. Must come before the chunk shader is put in
+	* use, the cull runs a compute shader
+	* Parameters:
+	* - culling: GPU culling the chunk bounds are handed to
+	* - viewProjection: Projection matrix multiplied by view matrix of the camera
+	* Returns: void
+	*/
+	void cull(GpuCulling& culling, const glm::mat4& viewProjection) const
+	{
+		culling.cull(m_cullObjects.data(), static_cast<int>(m_cullObjects.size()), m_cullVersion, viewProjection);
+	}
+
+	/*
+	* Draws the chunks that survived the last GPU cull with one indirect multi-draw per
+	* block type, so the CPU cost doesn't grow with the number of chunks. The chunk
+	* shader must be in use as for draw
+	* Parameters:
+	* - culling: GPU culling that culled the chunks this frame
+	* - bindMaterial: Callable taking a BlockType that binds its textures
+	* Returns: void
+	*/
+	template <typename BindMaterial>
+	void drawCulled(const GpuCulling& culling, const BindMaterial& bindMaterial)
+	{
+		bindVertexArray();
+
+		for (int type{ 1 }; type < blockTypeCount; ++type)
+		{
+			if (m_typeVertices[type] == 0)
+				continue;
+
+			bindMaterial(static_cast<BlockType>(type));
+			culling.draw(type);
+		}
+		glBindVertexArray(0);
+	}
+
+	/*
+	* Finds how close each block type comes to the camera among the loaded chunks in
+	* view, for picking texture detail
+	* Parameters:
+	* - frustum: View frustum of the camera
+	* - position: World position of the camera
+	* - distances: Receives the distance per BlockType, a large value for types not in view
+	* Returns: void
+	*/
+	void getNearestDistances(const Frustum& frustum, const glm::vec3& position, float distances[blockTypeCount]) const
+	{
+		std::fill(distances, distances + blockTypeCount, 1.0e9f);
+		for (const auto& [coord, loaded] : m_loaded)
+		{
+			if (!frustum.intersectsBox(loaded.boundsMin, loaded.boundsMax))
+				continue;
+
+			glm::vec3 closest{ glm::clamp(position, loaded.boundsMin, loaded.boundsMax) };
+			float distance{ glm::length(closest - position) };
+			for (int type{ 1 }; type < blockTypeCount; ++type)
+			{
+				if (loaded.ranges[type].count > 0)
+					distances[type] = std::min(distances[type], distance);
+			}
+		}
+	}
+
+	/*
+	* Changes a block of a loaded chunk and rebuilds its mesh in the background, along
+	* with the meshes of the neighbours whose border the block lies on
+	* Parameters:
+	* - x: World block x-coordinate
+	* - y: World block y-coordinate
+	* - z: World block z-coordinate
+	* - block: New block type
+	* Returns: False if the chunk isn't loaded or y is outside the world
+	*/
+	bool setBlock(int x, int y, int z, BlockType block)
+	{
+		ChunkCoord coord{ Chunk::floorDiv(x, Chunk::sizeX), Chunk::floorDiv(z, Chunk::sizeZ) };
+		auto loaded{ m_loaded.find(coord) };
+		if (loaded == m_loaded.end() || y < Chunk::minY || y >= Chunk::minY + Chunk::sizeY)
+			return false;
+
+		Chunk& chunk{ *loaded->second.chunk };
+		chunk.set(x - chunk.worldX(), y - Chunk::minY, z - chunk.worldZ(), block);
+		requestRemesh(loaded->second);
+		invalidateBorders(coord, x, z, x, z);
+		return true;
+	}
+
+	/*
+	* Finds the top solid block of a column, falling back to the generator if the
+	* chunk isn't loaded yet
+	* Parameters:
+	* - x: World x-coordinate
+	* - z: World z-coordinate
+	* Returns: World y of the top block
+	*/
+	int getSurfaceHeight(float x, float z) const
+	{
+		int blockX{ static_cast<int>(std::floor(x + 0.5f)) };
+		int blockZ{ static_cast<int>(std::floor(z + 0.5f)) };
+
+		auto loaded{ m_loaded.find(Chunk::coordAt(x, z)) };
+		if (loaded != m_loaded.end())
+		{
+			const Chunk& chunk{ *loaded->second.chunk };
+			int localX{ blockX - chunk.worldX() };
+			int localZ{ blockZ - chunk.worldZ() };
+			for (int y{ Chunk::sizeY - 1 }; y >= 0; --y)
+			{
+				if (isSolid(chunk.get(localX, y, localZ)))
+					return y + Chunk::minY;
+			}
+			return Chunk::minY;
+		}
+
+		TerrainColumn column{ m_generator.getColumn(blockX, blockZ) };
+		return std::max(column.height, column.lavaTop);
+	}
+
+	/*
+	* Reads a block, falling back to the generator if its chunk isn't loaded
+	* Parameters:
+	* - x: World block x-coordinate
+	* - y: World block y-coordinate
+	* - z: World block z-coordinate
+	* Returns: The block type, air outside the world
+	*/
+	BlockType getBlock(int x, int y, int z) const
+	{
+		if (y < Chunk::minY || y >= Chunk::minY + Chunk::sizeY)
+			return BlockType::air;
+
+		auto loaded{ m_loaded.find(ChunkCoord{ Chunk::floorDiv(x, Chunk::sizeX), Chunk::floorDiv(z, Chunk::sizeZ) }) };
+		if (loaded == m_loaded.end())
+			return m_generator.getBlock(x, y, z);
+
+		const Chunk& chunk{ *loaded->second.chunk };
+		return chunk.get(x - chunk.worldX(), y - Chunk::minY, z - chunk.worldZ());
+	}
+
+	std::size_t getLoadedCount() const
+	{
+		return m_loaded.size();
+	}
+
+	// Radius in chunks of the chunks drawn around the camera, loaded chunks past it are only cached
+	int getViewRadius() const
+	{
+		return m_viewRadius;
+	}
+
+	/*
+	* Pins the centre of the drawn chunks instead of following the camera, so whatever
+	* draws the terrain past the view radius can hand over without gaps or overlap
+	* Parameters:
+	* - center: Chunk the view radius of drawn chunks is measured from
+	* Returns: void
+	*/
+	void setDrawCenter(const ChunkCoord& center)
+	{
+		m_drawCenterPinned = true;
+		if (center == m_drawCenter)
+			return;
+
+		m_drawCenter = center;
+		updateDrawn();
+	}
+
+	// True while chunks are being built, uploaded or saved
+	bool isStreaming()
+	{
+		if (!m_pending.empty() || !m_uploading.empty() || !m_inFlight.isDone())
+			return true;
+
+		std::lock_guard<std::mutex> lock{ m_savingMutex };
+		return !m_savingCoords.empty();
+	}
+
+private:
+	struct LoadedChunk
+	{
+		std::unique_ptr<Chunk> chunk{};
+		// Position of the mesh in the vertex pool, the ranges are relative to it
+		int first{ -1 };
+		int vertexCount{ 0 };
+		// Index of the chunk's entry in the cull objects
+		int slot{ -1 };
+		// Index of the chunk in the list the CPU cull splits over the jobs
+		int listIndex{ -1 };
+		ChunkMeshRange ranges[blockTypeCount]{};
+		glm::vec3 boundsMin{};
+		glm::vec3 boundsMax{};
+		std::uint64_t lastUsed{};
+		// Generation of the latest remesh requested, meshes of older ones are dropped
+		std::uint64_t generation{ 0 };
+		// Within the view radius of the draw centre, cached chunks outside it are not drawn
+		bool drawn{ true };
+	};
+
+	struct VisibleChunk
+	{
+		float distance{};
+		const LoadedChunk* chunk{};
+	};
+
+	struct BuiltChunk
+	{
+		std::unique_ptr<Chunk> chunk{};
+		ChunkMesh mesh{};
+		// Only the mesh of an already loaded chunk is replaced
+		bool remesh{ false };
+		// Remesh request the mesh was built for
+		std::uint64_t generation{ 0 };
+		// Loaded from a region file, so it may differ from the terrain its neighbours were meshed against
+		bool edited{ false };
+	};
+
+	// Blocks of the loaded neighbours around a chunk, copied on the main thread so a job can
+	// mesh against them while the frame goes on editing
+	struct ChunkBorder
+	{
+		static constexpr int sizeX{ Chunk::sizeX + 2 * ChunkLight::border };
+		static constexpr int sizeZ{ Chunk::sizeZ + 2 * ChunkLight::border };
+
+		// Columns without a loaded neighbour are read from the generator instead
+		bool loaded[sizeX * sizeZ]{};
+		BlockType blocks[sizeX * sizeZ * Chunk::sizeY]{};
+	};
+
+	JobSystem& m_jobs;
+	const TerrainGenerator& m_generator;
+	RegionStore* m_regions{};
+	int m_uploadsPerFrame{};
+	int m_viewRadius{};
+	int m_maxInFlight{};
+	std::size_t m_capacity{};
+
+	std::vector<ChunkCoord> m_offsets{};
+	ChunkCoord m_center{};
+	ChunkCoord m_drawCenter{};
+	bool m_drawCenterPinned{ false };
+	std::uint64_t m_frame{ 0 };
+
+	std::unordered_map<ChunkCoord, LoadedChunk, ChunkCoordHash> m_loaded{};
+	std::unordered_set<ChunkCoord, ChunkCoordHash> m_pending{};
+	// Pending chunks whose neighbours changed after their border was copied, remeshed once loaded
+	std::unordered_set<ChunkCoord, ChunkCoordHash> m_staleBorders{};
+	std::uint64_t m_generation{ 0 };
+	// Nearest first
+	std::vector<VisibleChunk> m_visible{};
+	// Every loaded chunk, map nodes don't move so the pointers stay valid until unloaded
+	std::vector<LoadedChunk*> m_chunkList{};
+	// Visible chunks found by each cull job, merged into m_visible in job order
+	std::vector<std::vector<VisibleChunk>> m_visiblePartials{};
+
+	// Chunks tested by one job of the CPU cull
+	static constexpr int chunksPerCullJob{ 32 };
+
+	// Every loaded mesh lives in one buffer so a block type can be drawn with one call
+	static constexpr int initialPoolVertices{ 512 * 1024 };
+	VertexPool m_vertexPool{ initialPoolVertices };
+	int m_typeVertices[blockTypeCount]{};
+
+	// Bounds and pool ranges the GPU cull reads, freed slots are zeroed and reused
+	std::vector<CullObject> m_cullObjects{};
+	std::vector<int> m_freeSlots{};
+	std::uint64_t m_cullVersion{ 0 };
+
+	JobCounter m_inFlight{};
+	std::mutex m_finishedMutex{};
+	std::vector<std::unique_ptr<BuiltChunk>> m_finished{};
+	std::vector<std::unique_ptr<BuiltChunk>> m_uploading{};
+
+	JobCounter m_saving{};
+	std::mutex m_savingMutex{};
+	std::unordered_set<ChunkCoord, ChunkCoordHash> m_savingCoords{};
+
+	void requestChunk(ChunkCoord coord)
+	{
+		auto border{ std::make_shared<ChunkBorder>() };
+		copyBorder(coord, *border);
+
+		m_jobs.runBackground([this, coord, border]()
+			{
+				auto built{ std::make_unique<BuiltChunk>() };
+				built->chunk = std::make_unique<Chunk>(coord);
+				built->edited = m_regions && m_regions->load(*built->chunk);
+				if (!built->edited)
+				{
+					// Missing or corrupt, start over from fresh terrain
+					*built->chunk = Chunk{ coord };
+					m_generator.generate(*built->chunk);
+					built->chunk->clearDirty();
+				}
+
+				buildChunkMesh(*built->chunk, [this, coord, &border](int x, int y, int z) { return getBorderBlock(coord, *border, x, y, z); }, built->mesh);
+
+				std::lock_guard<std::mutex> lock{ m_finishedMutex };
+				m_finished.push_back(std::move(built));
+			}, &m_inFlight);
+	}
+
+	void requestRemesh(LoadedChunk& loaded)
+	{
+		loaded.generation = ++m_generation;
+		auto border{ std::make_shared<ChunkBorder>() };
+		copyBorder(loaded.chunk->coord, *border);
+
+		// The copies keep the job off the chunks the frame goes on editing
+		m_jobs.runBackground([this, copy = std::make_shared<Chunk>(*loaded.chunk), border, generation = loaded.generation]()
+			{
+				auto built{ std::make_unique<BuiltChunk>() };
+				built->remesh = true;
+				built->generation = generation;
+				buildChunkMesh(*copy, [this, &copy, &border](int x, int y, int z) { return getBorderBlock(copy->coord, *border, x, y, z); }, built->mesh);
+
+				std::lock_guard<std::mutex> lock{ m_finishedMutex };
+				m_finished.push_back(std::move(built));
+			}, &m_inFlight);
+	}
+
+	// Copies the border columns of the neighbours that are loaded
+	void copyBorder(const ChunkCoord& coord, ChunkBorder& border) const
+	{
+		int minX{ coord.x * Chunk::sizeX - ChunkLight::border };
+		int minZ{ coord.z * Chunk::sizeZ - ChunkLight::border };
+		for (int z{ 0 }; z < ChunkBorder::sizeZ; ++z)
+		{
+			for (int x{ 0 }; x < ChunkBorder::sizeX; ++x)
+			{
+				int localX{ x - ChunkLight::border };
+				int localZ{ z - ChunkLight::border };
+				if (localX >= 0 && localX < Chunk::sizeX && localZ >= 0 && localZ < Chunk::sizeZ)
+					continue;
+
+				int worldX{ minX + x };
+				int worldZ{ minZ + z };
+				auto neighbour{ m_loaded.find(ChunkCoord{ Chunk::floorDiv(worldX, Chunk::sizeX), Chunk::floorDiv(worldZ, Chunk::sizeZ) }) };
+				int column{ z * ChunkBorder::sizeX + x };
+				border.loaded[column] = neighbour != m_loaded.end();
+				if (!border.loaded[column])
+					continue;
+
+				const Chunk& chunk{ *neighbour->second.chunk };
+				for (int y{ 0 }; y < Chunk::sizeY; ++y)
+					border.blocks[column * Chunk::sizeY + y] = chunk.get(worldX - chunk.worldX(), y, worldZ - chunk.worldZ());
+			}
+		}
+	}
+
+	// Reads a block next to a chunk from its copied border, falling back to the generator
+	BlockType getBorderBlock(const ChunkCoord& coord, const ChunkBorder& border, int x, int y, int z) const
+	{
+		int column{ (z - coord.z * Chunk::sizeZ + ChunkLight::border) * ChunkBorder::sizeX + (x - coord.x * Chunk::sizeX + ChunkLight::border) };
+		if (!border.loaded[column])
+			return m_generator.getBlock(x, y, z);
+		return border.blocks[column * Chunk::sizeY + (y - Chunk::minY)];
+	}
+
+	/*
+	* Rebuilds the loaded neighbours whose border overlaps a block area, neighbours still
+	* being built are rebuilt once they are loaded
+	* Parameters:
+	* - coord: Chunk the area lies in, it isn't rebuilt here
+	* - minX: Lowest world block x of the area
+	* - minZ: Lowest world block z of the area
+	* - maxX: Highest world block x of the area
+	* - maxZ: Highest world block z of the area
+	* Returns: void
+	*/
+	void invalidateBorders(const ChunkCoord& coord, int minX, int minZ, int maxX, int maxZ)
+	{
+		for (int z{ Chunk::floorDiv(minZ - ChunkLight::border, Chunk::sizeZ) }; z <= Chunk::floorDiv(maxZ + ChunkLight::border, Chunk::sizeZ); ++z)
+		{
+			for (int x{ Chunk::floorDiv(minX - ChunkLight::border, Chunk::sizeX) }; x <= Chunk::floorDiv(maxX + ChunkLight::border, Chunk::sizeX); ++x)
+			{
+				ChunkCoord neighbour{ x, z };
+				if (neighbour == coord)
+					continue;
+
+				auto loaded{ m_loaded.find(neighbour) };
+				if (loaded != m_loaded.end())
+					requestRemesh(loaded->second);
+				else if (m_pending.count(neighbour) != 0)
+					m_staleBorders.insert(neighbour);
+			}
+		}
+	}
+
+	// Writes an edited chunk on the job system, generated chunks are never saved
+	void saveChunk(std::unique_ptr<Chunk> chunk)
+	{
+		if (!m_regions)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock{ m_savingMutex };
+			m_savingCoords.insert(chunk->coord);
+		}
+
+		m_jobs.runBackground([this, saved = std::shared_ptr<Chunk>{ std::move(chunk) }]()
+			{
+				m_regions->save(*saved);
+
+				std::lock_guard<std::mutex> lock{ m_savingMutex };
+				m_savingCoords.erase(saved->coord);
+			}, &m_saving);
+	}
+
+	bool isSaving(const ChunkCoord& coord)
+	{
+		std::lock_guard<std::mutex> lock{ m_savingMutex };
+		return m_savingCoords.count(coord) != 0;
+	}
+
+	void uploadFinished()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_finishedMutex };
+			for (std::unique_ptr<BuiltChunk>& built : m_finished)
+				m_uploading.push_back(std::move(built));
+			m_finished.clear();
+		}
+
+		// Closest chunks go up first, the rest wait for the next frames
+		std::sort(m_uploading.begin(), m_uploading.end(), [this](const std::unique_ptr<BuiltChunk>& a, const std::unique_ptr<BuiltChunk>& b)
+			{
+				return distanceToCenter(a->mesh.coord) > distanceToCenter(b->mesh.coord);
+			});
+
+		for (int uploads{ 0 }; uploads < m_uploadsPerFrame && !m_uploading.empty(); )
+		{
+			std::unique_ptr<BuiltChunk> built{ std::move(m_uploading.back()) };
+			m_uploading.pop_back();
+
+			ChunkCoord coord{ built->mesh.coord };
+			if (built->remesh)
+			{
+				// Unloaded since, or a newer remesh was requested and this one may have finished last
+				auto loaded{ m_loaded.find(coord) };
+				if (loaded != m_loaded.end() && loaded->second.generation == built->generation)
+				{
+					release(loaded->second);
+					uploadMesh(loaded->second, built->mesh);
+					++uploads;
+				}
+				continue;
+			}
+
+			m_pending.erase(coord);
+			bool staleBorder{ m_staleBorders.erase(coord) != 0 };
+
+			// The camera moved on while it was being built
+			if (!isInRange(coord))
+				continue;
+
+			LoadedChunk& loaded{ m_loaded[coord] };
+			upload(loaded, *built);
+			++uploads;
+
+			if (staleBorder)
+				requestRemesh(loaded);
+			// Neighbours meshed against generated terrain where this chunk's saved edits are
+			if (built->edited)
+				invalidateBorders(coord, coord.x * Chunk::sizeX, coord.z * Chunk::sizeZ, (coord.x + 1) * Chunk::sizeX - 1, (coord.z + 1) * Chunk::sizeZ - 1);
+		}
+	}
+
+	void upload(LoadedChunk& loaded, BuiltChunk& built)
+	{
+		loaded.chunk = std::move(built.chunk);
+		loaded.lastUsed = m_frame;
+		loaded.listIndex = static_cast<int>(m_chunkList.size());
+		m_chunkList.push_back(&loaded);
+
+		float minX{ static_cast<float>(loaded.chunk->worldX()) - 0.5f };
+		float minZ{ static_cast<float>(loaded.chunk->worldZ()) - 0.5f };
+		loaded.boundsMin = glm::vec3(minX, Chunk::minY - 0.5f, minZ);
+		loaded.boundsMax = glm::vec3(minX + Chunk::sizeX, Chunk::minY + Chunk::sizeY - 0.5f, minZ + Chunk::sizeZ);
+
+		uploadMesh(loaded, built.mesh);
+	}
+
+	void uploadMesh(LoadedChunk& loaded, const ChunkMesh& mesh)
+	{
+		std::copy(std::begin(mesh.ranges), std::end(mesh.ranges), std::begin(loaded.ranges));
+
+		loaded.vertexCount = static_cast<int>(mesh.vertices.size()) / VertexPool::floatsPerVertex;
+		loaded.first = m_vertexPool.allocate(mesh.vertices.data(), loaded.vertexCount);
+
+		if (loaded.slot < 0)
+		{
+			if (m_freeSlots.empty())
+			{
+				loaded.slot = static_cast<int>(m_cullObjects.size());
+				m_cullObjects.emplace_back();
+			}
+			else
+			{
+				loaded.slot = m_freeSlots.back();
+				m_freeSlots.pop_back();
+			}
+		}
+
+		for (int type{ 1 }; type < blockTypeCount; ++type)
+			m_typeVertices[type] += loaded.ranges[type].count;
+		loaded.drawn = isDrawn(loaded.chunk->coord);
+		writeCullObject(loaded);
+	}
+
+	// Chunks not drawn keep their slot with nothing to draw
+	void writeCullObject(const LoadedChunk& loaded)
+	{
+		CullObject& object{ m_cullObjects[loaded.slot] };
+		object = CullObject{};
+		if (loaded.drawn)
+		{
+			object.boundsMin = glm::vec4(loaded.boundsMin, 0.0f);
+			object.boundsMax = glm::vec4(loaded.boundsMax, 0.0f);
+			for (int type{ 1 }; type < blockTypeCount; ++type)
+			{
+				object.first[type] = loaded.first + loaded.ranges[type].first;
+				object.count[type] = loaded.ranges[type].count;
+			}
+		}
+		++m_cullVersion;
+	}
+
+	// Hides cached chunks the draw centre left behind and shows those it came back to
+	void updateDrawn()
+	{
+		for (auto& [coord, loaded] : m_loaded)
+		{
+			bool drawn{ isDrawn(coord) };
+			if (drawn == loaded.drawn)
+				continue;
+
+			loaded.drawn = drawn;
+			if (loaded.slot >= 0)
+				writeCullObject(loaded);
+		}
+	}
+
+	// Frees the mesh, the chunk keeps its cull slot for the mesh that replaces it
+	void release(LoadedChunk& loaded)
+	{
+		m_vertexPool.release(loaded.first, loaded.vertexCount);
+		loaded.first = -1;
+		loaded.vertexCount = 0;
+
+		for (int type{ 1 }; type < blockTypeCount; ++type)
+			m_typeVertices[type] -= loaded.ranges[type].count;
+
+		if (loaded.slot >= 0)
+		{
+			m_cullObjects[loaded.slot] = CullObject{};
+			++m_cullVersion;
+		}
+	}
+
+	// Frees the mesh and the cull slot of a chunk that is unloaded
+	void unload(LoadedChunk& loaded)
+	{
+		release(loaded);
+		if (loaded.slot >= 0)
+			m_freeSlots.push_back(loaded.slot);
+		loaded.slot = -1;
+	}
+
+	// Swaps the last chunk of the list into the place of one that is unloaded
+	void removeFromList(LoadedChunk& loaded)
+	{
+		LoadedChunk* last{ m_chunkList.back() };
+		m_chunkList[loaded.listIndex] = last;
+		last->listIndex = loaded.listIndex;
+		m_chunkList.pop_back();
+		loaded.listIndex = -1;
+	}
+
+	// Gathers the drawn chunks in the frustum into m_visible on the job system, sorted by distance to their bounds
+	void collectVisible(const Frustum& frustum, const glm::vec3& position)
+	{
+		int chunkCount{ static_cast<int>(m_chunkList.size()) };
+		int jobCount{ (chunkCount + chunksPerCullJob - 1) / chunksPerCullJob };
+		if (static_cast<int>(m_visiblePartials.size()) < jobCount)
+			m_visiblePartials.resize(jobCount);
+
+		m_jobs.parallelFor(0, jobCount, 1, [&](int first, int last)
+			{
+				for (int job{ first }; job < last; ++job)
+				{
+					std::vector<VisibleChunk>& partial{ m_visiblePartials[job] };
+					partial.clear();
+					for (int i{ job * chunksPerCullJob }; i < std::min(chunkCount, (job + 1) * chunksPerCullJob); ++i)
+					{
+						const LoadedChunk& loaded{ *m_chunkList[i] };
+						if (loaded.drawn && loaded.vertexCount > 0 && frustum.intersectsBox(loaded.boundsMin, loaded.boundsMax))
+							partial.push_back(VisibleChunk{ glm::length(glm::clamp(position, loaded.boundsMin, loaded.boundsMax) - position), &loaded });
+					}
+				}
+			});
+
+		// Merging in job order keeps the list the same no matter which thread culled what
+		m_visible.clear();
+		for (int job{ 0 }; job < jobCount; ++job)
+			m_visible.insert(m_visible.end(), m_visiblePartials[job].begin(), m_visiblePartials[job].end());
+
+		std::sort(m_visible.begin(), m_visible.end(), [](const VisibleChunk& a, const VisibleChunk& b)
+			{
+				return a.distance < b.distance;
+			});
+	}
+
+	void bindVertexArray() const
+	{
+		glBindVertexArray(m_vertexPool.getVertexArray());
+	}
+
+	void evictLeastRecentlyUsed()
+	{
+		if (m_loaded.size() <= m_capacity)
+			return;
+
+		ArenaScope scope{ scratchArena() };
+		using Candidate = std::pair<std::uint64_t, ChunkCoord>;
+		std::vector<Candidate, ArenaAllocator<Candidate>> candidates{ ArenaAllocator<Candidate>{ scratchArena() } };
+		candidates.reserve(m_loaded.size());
+		for (const auto& [coord, loaded] : m_loaded)
+		{
+			if (loaded.lastUsed < m_frame)
+				candidates.emplace_back(loaded.lastUsed, coord);
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b)
+			{
+				return a.first < b.first;
+			});
+
+		for (const auto& [lastUsed, coord] : candidates)
+		{
+			if (m_loaded.size() <= m_capacity)
+				break;
+
+			auto loaded{ m_loaded.find(coord) };
+			if (loaded->second.chunk->isDirty())
+				saveChunk(std::move(loaded->second.chunk));
+			unload(loaded->second);
+			removeFromList(loaded->second);
+			m_loaded.erase(loaded);
+		}
+	}
+
+	int distanceToCenter(const ChunkCoord& coord) const
+	{
+		int dx{ coord.x - m_center.x };
+		int dz{ coord.z - m_center.z };
+		return dx * dx + dz * dz;
+	}
+
+	bool isInRange(const ChunkCoord& coord) const
+	{
+		const ChunkCoord& farthest{ m_offsets.back() };
+		return distanceToCenter(coord) <= farthest.x * farthest.x + farthest.z * farthest.z;
+	}
+
+	bool isDrawn(const ChunkCoord& coord) const
+	{
+		const ChunkCoord& farthest{ m_offsets.back() };
+		int dx{ coord.x - m_drawCenter.x };
+		int dz{ coord.z - m_drawCenter.z };
+		return dx * dx + dz * dz <= farthest.x * farthest.x + farthest.z * farthest.z;
+	}
+};
+
+#endif
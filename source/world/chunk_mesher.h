@@ -0,0 +1,219 @@
+/*
+* File: chunk_mesher.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program turns the blocks of a chunk into a mesh holding only
+			   the faces that border air, grouped by block type so each group can be
+			   drawn with its own material. Smooth light and ambient occlusion are
+			   baked into the vertices so shading them costs one texture fetch
+*/
+
+#ifndef CHUNK_MESHER_H
+#define CHUNK_MESHER_H
+
+#include "block.h"
+#include "chunk.h"
+#include "chunk_light.h"
+
+#include <cmath>
+#include <vector>
+
+struct ChunkMeshRange
+{
+	int first{};
+	int count{};
+};
+
+// Interleaved position, normal, texture coordinates and baked sky and block light
+struct ChunkMesh
+{
+	static constexpr int floatsPerVertex{ 10 };
+
+	ChunkCoord coord{};
+	std::vector<float> vertices{};
+	// Vertex range of each block type, indexed by BlockType
+	ChunkMeshRange ranges[blockTypeCount]{};
+};
+
+namespace mesher
+{
+	struct Face
+	{
+		int dx, dy, dz;
+		float corners[4][3];
+	};
+
+	// Corners are counter-clockwise seen from outside, starting bottom left
+	constexpr Face faces[6]{
+		{ 1, 0, 0, { { 0.5f, -0.5f, 0.5f }, { 0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f } } },
+		{ -1, 0, 0, { { -0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f, 0.5f }, { -0.5f, 0.5f, 0.5f }, { -0.5f, 0.5f, -0.5f } } },
+		{ 0, 1, 0, { { -0.5f, 0.5f, 0.5f }, { 0.5f, 0.5f, 0.5f }, { 0.5f, 0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f } } },
+		{ 0, -1, 0, { { -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, 0.5f }, { -0.5f, -0.5f, 0.5f } } },
+		{ 0, 0, 1, { { -0.5f, -0.5f, 0.5f }, { 0.5f, -0.5f, 0.5f }, { 0.5f, 0.5f, 0.5f }, { -0.5f, 0.5f, 0.5f } } },
+		{ 0, 0, -1, { { 0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f } } },
+	};
+
+	constexpr float texCoords[4][2]{ { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+	constexpr int triangleCorners[6]{ 0, 1, 2, 2, 3, 0 };
+	// Splits the quad along the other diagonal, so occlusion interpolates without a crease
+	constexpr int flippedTriangleCorners[6]{ 1, 2, 3, 3, 0, 1 };
+
+	// Fixed sun shading per face in the order of faces: sides dimmer than tops, bottoms darkest
+	constexpr float faceShade[6]{ 0.8f, 0.8f, 1.0f, 0.5f, 0.9f, 0.9f };
+
+	// Brightness by number of occluding neighbours at a corner, three means fully enclosed
+	constexpr float occlusionShade[4]{ 1.0f, 0.8f, 0.65f, 0.5f };
+
+	// Light levels fall off geometrically so a few steps from a source are visibly darker
+	inline float brightness(float level)
+	{
+		return std::pow(0.8f, static_cast<float>(ChunkLight::maxLevel) - level);
+	}
+
+	struct CornerLight
+	{
+		float sky{};
+		float block{};
+		int occluders{};
+	};
+
+	/*
+	* Averages the light of the air cells touching a face corner and counts the solid
+	* ones for ambient occlusion
+	* Parameters:
+	* - light: Light and occupancy around the chunk
+	* - face: Face being emitted
+	* - corner: Corner index of the face
+	* - x: Local x of the block
+	* - y: Local y of the block
+	* - z: Local z of the block
+	* Returns: Light and occluder count of the corner
+	*/
+	inline CornerLight lightCorner(const ChunkLight& light, const Face& face, int corner, int x, int y, int z)
+	{
+		// The cell in front of the face and the two steps along the face towards the corner
+		int front[3]{ x + face.dx, y + face.dy, z + face.dz };
+		int normal[3]{ face.dx, face.dy, face.dz };
+		int tangents[2][3]{};
+		int tangentCount{ 0 };
+		for (int axis{ 0 }; axis < 3; ++axis)
+		{
+			if (normal[axis] == 0)
+				tangents[tangentCount++][axis] = face.corners[corner][axis] > 0.0f ? 1 : -1;
+		}
+
+		const int* a{ tangents[0] };
+		const int* b{ tangents[1] };
+		bool sideA{ light.isOpaque(front[0] + a[0], front[1] + a[1], front[2] + a[2]) };
+		bool sideB{ light.isOpaque(front[0] + b[0], front[1] + b[1], front[2] + b[2]) };
+		// With both sides solid the diagonal cell can't be seen from the corner
+		bool diagonal{ (sideA && sideB) || light.isOpaque(front[0] + a[0] + b[0], front[1] + a[1] + b[1], front[2] + a[2] + b[2]) };
+
+		CornerLight result{};
+		result.occluders = static_cast<int>(sideA) + static_cast<int>(sideB) + static_cast<int>(diagonal);
+
+		int samples{ 0 };
+		auto sample = [&](int sx, int sy, int sz)
+			{
+				result.sky += static_cast<float>(light.getSkyLight(sx, sy, sz));
+				result.block += static_cast<float>(light.getBlockLight(sx, sy, sz));
+				++samples;
+			};
+		sample(front[0], front[1], front[2]);
+		if (!sideA)
+			sample(front[0] + a[0], front[1] + a[1], front[2] + a[2]);
+		if (!sideB)
+			sample(front[0] + b[0], front[1] + b[1], front[2] + b[2]);
+		if (!diagonal)
+			sample(front[0] + a[0] + b[0], front[1] + a[1] + b[1], front[2] + a[2] + b[2]);
+
+		result.sky /= static_cast<float>(samples);
+		result.block /= static_cast<float>(samples);
+		return result;
+	}
+
+	inline void emitFace(std::vector<float>& out, const ChunkLight& light, int faceIndex, int x, int y, int z, float worldX, float worldY, float worldZ)
+	{
+		const Face& face{ faces[faceIndex] };
+
+		float sky[4]{};
+		float block[4]{};
+		int occluders[4]{};
+		for (int corner{ 0 }; corner < 4; ++corner)
+		{
+			CornerLight cornerLight{ lightCorner(light, face, corner, x, y, z) };
+			float shade{ occlusionShade[cornerLight.occluders] };
+			sky[corner] = brightness(cornerLight.sky) * shade * faceShade[faceIndex];
+			// Unlike the sky, which always leaves some ambient, no emitter means no block light
+			block[corner] = cornerLight.block > 0.0f ? brightness(cornerLight.block) * shade : 0.0f;
+			occluders[corner] = cornerLight.occluders;
+		}
+
+		bool flip{ occluders[0] + occluders[2] > occluders[1] + occluders[3] };
+		for (int corner : flip ? flippedTriangleCorners : triangleCorners)
+		{
+			out.push_back(worldX + face.corners[corner][0]);
+			out.push_back(worldY + face.corners[corner][1]);
+			out.push_back(worldZ + face.corners[corner][2]);
+			out.push_back(static_cast<float>(face.dx));
+			out.push_back(static_cast<float>(face.dy));
+			out.push_back(static_cast<float>(face.dz));
+			out.push_back(texCoords[corner][0]);
+			out.push_back(texCoords[corner][1]);
+			out.push_back(sky[corner]);
+			out.push_back(block[corner]);
+		}
+	}
+}
+
+/*
+* Lights a chunk and builds its mesh in world space
+* Parameters:
+* - chunk: Chunk to mesh
+* - outside: Callable returning the BlockType at world (x, y, z) for neighbours outside the chunk
+* - mesh: Receives the vertices and per block type ranges
+* Returns: void
+*/
+template <typename OutsideBlock>
+void buildChunkMesh(const Chunk& chunk, const OutsideBlock& outside, ChunkMesh& mesh)
+{
+	std::vector<float> perType[blockTypeCount]{};
+
+	ChunkLight light{};
+	light.compute(chunk, outside);
+
+	for (int y{ 0 }; y < Chunk::sizeY; ++y)
+	{
+		for (int z{ 0 }; z < Chunk::sizeZ; ++z)
+		{
+			for (int x{ 0 }; x < Chunk::sizeX; ++x)
+			{
+				BlockType block{ chunk.get(x, y, z) };
+				if (!isSolid(block))
+					continue;
+
+				float worldX{ static_cast<float>(chunk.worldX() + x) };
+				float worldY{ static_cast<float>(Chunk::minY + y) };
+				float worldZ{ static_cast<float>(chunk.worldZ() + z) };
+
+				for (int face{ 0 }; face < 6; ++face)
+				{
+					const mesher::Face& direction{ mesher::faces[face] };
+					if (!light.isOpaque(x + direction.dx, y + direction.dy, z + direction.dz))
+						mesher::emitFace(perType[static_cast<int>(block)], light, face, x, y, z, worldX, worldY, worldZ);
+				}
+			}
+		}
+	}
+
+	mesh.coord = chunk.coord;
+	mesh.vertices.clear();
+	for (int type{ 0 }; type < blockTypeCount; ++type)
+	{
+		mesh.ranges[type].first = static_cast<int>(mesh.vertices.size()) / ChunkMesh::floatsPerVertex;
+		mesh.ranges[type].count = static_cast<int>(perType[type].size()) / ChunkMesh::floatsPerVertex;
+		mesh.vertices.insert(mesh.vertices.end(), perType[type].begin(), perType[type].end());
+	}
+}
+
+#endif
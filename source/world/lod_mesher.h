@@ -0,0 +1,429 @@
+/*
+* File: lod_mesher.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program meshes distant terrain at reduced resolution. A level
+			   of detail merges cubes of 2, 4 or 8 blocks into one cell, solid when
+			   most of its blocks are, and builds one mesh for a tile of 8 by 8
+			   chunks. Where a tile borders finer terrain it closes its side with
+			   skirt faces, so the step between levels never opens a gap
+*/
+
+#ifndef LOD_MESHER_H
+#define LOD_MESHER_H
+
+#include "block.h"
+#include "chunk.h"
+#include "chunk_mesher.h"
+#include "terrain.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace lod
+{
+	// Coarsest level, cells of 8 blocks
+	constexpr int maxLevel{ 3 };
+	// Tiles are squares of this many chunks, aligned to multiples of it
+	constexpr int tileChunks{ 8 };
+
+	inline int cellSize(int level)
+	{
+		return 1 << level;
+	}
+
+	// Bit of a chunk in a tile's chunk masks, from its position relative to the tile's corner
+	inline std::uint64_t chunkBit(int x, int z)
+	{
+		return std::uint64_t{ 1 } << (z * tileChunks + x);
+	}
+
+	// Bit of the chunk just outside a tile's side in its border mask. Sides are -x, +x, -z, +z
+	inline std::uint32_t borderBit(int side, int along)
+	{
+		return std::uint32_t{ 1 } << (side * tileChunks + along);
+	}
+
+	// Rings of chunk distance around the camera, one per level of detail
+	struct Rings
+	{
+		// Squared outer radius in chunks of each level, level 0 is the full detail chunks
+		int radiusSquared[maxLevel + 1]{};
+		int levels{};
+
+		/*
+		* Sets up rings doubling in radius from the full detail view radius
+		* Parameters:
+		* - nearRadius: View radius in chunks of the full detail chunks
+		* - levelCount: Number of reduced levels, at most maxLevel
+		* Returns: Rings object
+		*/
+		static Rings doubling(int nearRadius, int levelCount)
+		{
+			Rings rings{};
+			rings.levels = std::clamp(levelCount, 0, maxLevel);
+			for (int level{ 0 }; level <= rings.levels; ++level)
+			{
+				int radius{ nearRadius << level };
+				rings.radiusSquared[level] = radius * radius;
+			}
+			return rings;
+		}
+
+		// Level a chunk is drawn at, from its offset to the camera's chunk, -1 beyond the last ring
+		int levelOf(int dx, int dz) const
+		{
+			int distance{ dx * dx + dz * dz };
+			for (int level{ 0 }; level <= levels; ++level)
+			{
+				if (distance <= radiusSquared[level])
+					return level;
+			}
+			return -1;
+		}
+	};
+
+	// What a tile's mesh is built from, two tiles with equal descriptions have equal meshes
+	struct TileDesc
+	{
+		int level{};
+		// Chunk in the lowest x and z corner
+		ChunkCoord origin{};
+		// Chunks of the tile drawn at this level
+		std::uint64_t members{};
+		// Chunks of the tile drawn at a finer level
+		std::uint64_t finer{};
+		// Chunks bordering the tile drawn at a finer level
+		std::uint32_t finerBorder{};
+
+		bool operator==(const TileDesc& other) const
+		{
+			return level == other.level && origin == other.origin && members == other.members && finer == other.finer && finerBorder == other.finerBorder;
+		}
+
+		bool operator!=(const TileDesc& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	/*
+	* Works out what a tile holds for the camera in a given chunk
+	* Parameters:
+	* - rings: Rings levels are picked by
+	* - center: Chunk the camera is in
+	* - level: Level of the tile
+	* - origin: Chunk in the tile's lowest x and z corner
+	* Returns: The tile's description, with no members if none of its chunks are at its level
+	*/
+	inline TileDesc describeTile(const Rings& rings, ChunkCoord center, int level, ChunkCoord origin)
+	{
+		TileDesc desc{ level, origin };
+		auto levelAt{ [&rings, &center](int x, int z) { return rings.levelOf(x - center.x, z - center.z); } };
+		auto isFiner{ [level](int other) { return other >= 0 && other < level; } };
+
+		std::uint64_t finer{ 0 };
+		for (int z{ 0 }; z < tileChunks; ++z)
+		{
+			for (int x{ 0 }; x < tileChunks; ++x)
+			{
+				int chunkLevel{ levelAt(origin.x + x, origin.z + z) };
+				if (chunkLevel == level)
+					desc.members |= chunkBit(x, z);
+				else if (isFiner(chunkLevel))
+					finer |= chunkBit(x, z);
+			}
+		}
+		if (desc.members == 0)
+			return desc;
+
+		desc.finer = finer;
+		for (int along{ 0 }; along < tileChunks; ++along)
+		{
+			const int sides[4][2]{
+				{ origin.x - 1, origin.z + along },
+				{ origin.x + tileChunks, origin.z + along },
+				{ origin.x + along, origin.z - 1 },
+				{ origin.x + along, origin.z + tileChunks },
+			};
+			for (int side{ 0 }; side < 4; ++side)
+			{
+				if (isFiner(levelAt(sides[side][0], sides[side][1])))
+					desc.finerBorder |= borderBit(side, along);
+			}
+		}
+		return desc;
+	}
+
+	// One merged cell, solid when at least half of its blocks are
+	struct Cell
+	{
+		BlockType block{ BlockType::air };
+	};
+
+	/*
+	* Downsamples one column of cells. Only a few block columns per cell are read, each
+	* standing for the columns around it
+	* Parameters:
+	* - generator: Terrain generator the blocks come from
+	* - x: World x of the column's lowest block column
+	* - z: World z of the column's lowest block column
+	* - size: Cell size in blocks
+	* - cells: Receives Chunk::sizeY / size cells, bottom to top
+	* Returns: void
+	*/
+	inline void sampleColumn(const TerrainGenerator& generator, int x, int z, int size, Cell* cells)
+	{
+		// Two by two samples per cell, so every size reads four generator columns
+		const int stride{ std::max(1, size / 2) };
+		const int perAxis{ size / stride };
+		const int weight{ stride * stride };
+		const int volume{ size * size * size };
+		const int cellCount{ Chunk::sizeY / size };
+
+		TerrainColumn columns[4]{};
+		int tops[4]{};
+		int count{ 0 };
+		for (int sz{ 0 }; sz < perAxis; ++sz)
+		{
+			for (int sx{ 0 }; sx < perAxis; ++sx)
+			{
+				columns[count] = generator.getColumn(x + sx * stride + stride / 2, z + sz * stride + stride / 2);
+				tops[count] = std::max(columns[count].height, columns[count].lavaTop);
+				++count;
+			}
+		}
+
+		for (int cy{ 0 }; cy < cellCount; ++cy)
+		{
+			const int bottom{ Chunk::minY + cy * size };
+			const int top{ bottom + size - 1 };
+
+			int solid{ 0 };
+			for (int i{ 0 }; i < count; ++i)
+			{
+				if (tops[i] >= bottom)
+					solid += (std::min(tops[i], top) - bottom + 1) * weight;
+			}
+			cells[cy].block = solid * 2 < volume ? BlockType::air : BlockType::dirt;
+		}
+
+		for (int cy{ 0 }; cy < cellCount; ++cy)
+		{
+			if (!isSolid(cells[cy].block))
+				continue;
+
+			// The top cell shows the surface even where the thin top layer lost the vote to
+			// the cell above, lower ones show the highest block inside them
+			const int bottom{ Chunk::minY + cy * size };
+			const int top{ bottom + size - 1 };
+			const bool exposed{ cy + 1 == cellCount || !isSolid(cells[cy + 1].block) };
+
+			BlockType visible[4]{};
+			int visibleCount{ 0 };
+			for (int i{ 0 }; i < count; ++i)
+			{
+				if (tops[i] >= bottom)
+					visible[visibleCount++] = TerrainGenerator::blockInColumn(columns[i], exposed ? tops[i] : std::min(tops[i], top));
+			}
+
+			// The most common visible block, ties going to the first seen
+			int best{ 0 };
+			int bestVotes{ 0 };
+			for (int i{ 0 }; i < visibleCount; ++i)
+			{
+				int votes{ static_cast<int>(std::count(visible, visible + visibleCount, visible[i])) };
+				if (votes > bestVotes)
+				{
+					best = i;
+					bestVotes = votes;
+				}
+			}
+			cells[cy].block = visible[best];
+		}
+	}
+
+	inline void emitFace(std::vector<float>& out, int faceIndex, float x, float y, float z, float size, BlockType block)
+	{
+		const mesher::Face& face{ mesher::faces[faceIndex] };
+
+		// No neighbourhood to light from at this distance: full sky with the fixed face shading
+		float sky{ mesher::faceShade[faceIndex] };
+		float blockLight{ lightEmission(block) > 0 ? 1.0f : 0.0f };
+		for (int corner : mesher::triangleCorners)
+		{
+			// Corners are at +-0.5 around a block, a cell spans size blocks from its lowest one
+			out.push_back(x + (face.corners[corner][0] + 0.5f) * size - 0.5f);
+			out.push_back(y + (face.corners[corner][1] + 0.5f) * size - 0.5f);
+			out.push_back(z + (face.corners[corner][2] + 0.5f) * size - 0.5f);
+			out.push_back(static_cast<float>(face.dx));
+			out.push_back(static_cast<float>(face.dy));
+			out.push_back(static_cast<float>(face.dz));
+			// Repeated once per block, so textures keep their scale
+			out.push_back(mesher::texCoords[corner][0] * size);
+			out.push_back(mesher::texCoords[corner][1] * size);
+			out.push_back(sky);
+			out.push_back(blockLight);
+		}
+	}
+
+	// The cells of a tile and the ring around it, sampled once and meshed again whenever the rings move
+	struct TileCells
+	{
+		int level{};
+		ChunkCoord origin{};
+		int width{};
+		int height{};
+		std::vector<Cell> cells{};
+
+		// Cells bottom to top of a column, the tile's own columns start at 1
+		const Cell* column(int cx, int cz) const
+		{
+			return &cells[(static_cast<std::size_t>(cz) * width + cx) * height];
+		}
+	};
+
+	/*
+	* Samples every cell column of a tile and of the ring around it
+	* Parameters:
+	* - generator: Terrain generator the blocks come from
+	* - level: Level of the tile
+	* - origin: Chunk in the tile's lowest x and z corner
+	* - tile: Receives the cells
+	* Returns: void
+	*/
+	inline void sampleTile(const TerrainGenerator& generator, int level, ChunkCoord origin, TileCells& tile)
+	{
+		const int size{ cellSize(level) };
+		tile.level = level;
+		tile.origin = origin;
+		tile.width = tileChunks * (Chunk::sizeX / size) + 2;
+		tile.height = Chunk::sizeY / size;
+		tile.cells.assign(static_cast<std::size_t>(tile.width) * tile.width * tile.height, Cell{});
+
+		for (int cz{ 0 }; cz < tile.width; ++cz)
+		{
+			for (int cx{ 0 }; cx < tile.width; ++cx)
+			{
+				// Corners of the ring touch no cell of the tile
+				bool corner{ (cx == 0 || cx == tile.width - 1) && (cz == 0 || cz == tile.width - 1) };
+				if (!corner)
+					sampleColumn(generator, origin.x * Chunk::sizeX + (cx - 1) * size, origin.z * Chunk::sizeZ + (cz - 1) * size, size, &tile.cells[(static_cast<std::size_t>(cz) * tile.width + cx) * tile.height]);
+			}
+		}
+	}
+}
+
+/*
+* Builds the mesh of a level of detail tile in world space. Faces between cells are
+* dropped as in a full detail chunk. Towards finer chunks the neighbours count as air,
+* so the tile shows its side down to where the finer terrain takes over. The finer
+* side is always the one nearer the camera, so it needs no skirt of its own
+* Parameters:
+* - tile: Cells sampled for the tile's level and origin
+* - desc: Tile to build
+* - mesh: Receives the vertices and per block type ranges, its coord is the tile's origin
+* Returns: void
+*/
+inline void buildLodMesh(const lod::TileCells& tile, const lod::TileDesc& desc, ChunkMesh& mesh)
+{
+	const int size{ lod::cellSize(desc.level) };
+	const int cellsPerChunk{ Chunk::sizeX / size };
+	const int height{ tile.height };
+	// A ring of cells around the tile holds the neighbours
+	const int width{ tile.width };
+	const int originX{ desc.origin.x * Chunk::sizeX };
+	const int originZ{ desc.origin.z * Chunk::sizeZ };
+
+	// Where a cell column sits relative to the tile: 1 drawn here, 2 finer, 0 neither
+	auto columnRole{ [&desc, cellsPerChunk](int cx, int cz)
+		{
+			int chunkX{ Chunk::floorDiv(cx - 1, cellsPerChunk) };
+			int chunkZ{ Chunk::floorDiv(cz - 1, cellsPerChunk) };
+			bool insideX{ chunkX >= 0 && chunkX < lod::tileChunks };
+			bool insideZ{ chunkZ >= 0 && chunkZ < lod::tileChunks };
+			if (insideX && insideZ)
+			{
+				std::uint64_t bit{ lod::chunkBit(chunkX, chunkZ) };
+				return (desc.members & bit) != 0 ? 1 : (desc.finer & bit) != 0 ? 2 : 0;
+			}
+
+			// Border cells, the corners are never looked at
+			std::uint32_t bit{};
+			if (!insideX && insideZ)
+				bit = lod::borderBit(chunkX < 0 ? 0 : 1, chunkZ);
+			else if (insideX && !insideZ)
+				bit = lod::borderBit(chunkZ < 0 ? 2 : 3, chunkX);
+			return (desc.finerBorder & bit) != 0 ? 2 : 0;
+		} };
+
+	std::vector<std::uint8_t> roles(static_cast<std::size_t>(width) * width);
+	for (int cz{ 0 }; cz < width; ++cz)
+		for (int cx{ 0 }; cx < width; ++cx)
+			roles[static_cast<std::size_t>(cz) * width + cx] = static_cast<std::uint8_t>(columnRole(cx, cz));
+
+	auto role{ [&roles, width](int cx, int cz) { return roles[static_cast<std::size_t>(cz) * width + cx]; } };
+
+	std::vector<float> perType[blockTypeCount]{};
+	for (int cz{ 1 }; cz < width - 1; ++cz)
+	{
+		for (int cx{ 1 }; cx < width - 1; ++cx)
+		{
+			if (role(cx, cz) != 1)
+				continue;
+
+			const lod::Cell* cellColumn{ tile.column(cx, cz) };
+			float worldX{ static_cast<float>(originX + (cx - 1) * size) };
+			float worldZ{ static_cast<float>(originZ + (cz - 1) * size) };
+			for (int cy{ 0 }; cy < height; ++cy)
+			{
+				BlockType block{ cellColumn[cy].block };
+				if (!isSolid(block))
+					continue;
+
+				float worldY{ static_cast<float>(Chunk::minY + cy * size) };
+				for (int face{ 0 }; face < 6; ++face)
+				{
+					const mesher::Face& direction{ mesher::faces[face] };
+					int nx{ cx + direction.dx };
+					int ny{ cy + direction.dy };
+					int nz{ cz + direction.dz };
+
+					// The world's floor is never seen and its roof is open
+					bool open;
+					if (ny < 0)
+						open = false;
+					else if (ny >= height)
+						open = true;
+					else if (role(nx, nz) == 2)
+						open = true;
+					else
+						open = !isSolid(tile.column(nx, nz)[ny].block);
+
+					if (open)
+						lod::emitFace(perType[static_cast<int>(block)], face, worldX, worldY, worldZ, static_cast<float>(size), block);
+				}
+			}
+		}
+	}
+
+	mesh.coord = desc.origin;
+	mesh.vertices.clear();
+	for (int type{ 0 }; type < blockTypeCount; ++type)
+	{
+		mesh.ranges[type].first = static_cast<int>(mesh.vertices.size()) / ChunkMesh::floatsPerVertex;
+		mesh.ranges[type].count = static_cast<int>(perType[type].size()) / ChunkMesh::floatsPerVertex;
+		mesh.vertices.insert(mesh.vertices.end(), perType[type].begin(), perType[type].end());
+	}
+}
+
+// Samples and meshes a tile in one go
+inline void buildLodMesh(const TerrainGenerator& generator, const lod::TileDesc& desc, ChunkMesh& mesh)
+{
+	lod::TileCells tile{};
+	lod::sampleTile(generator, desc.level, desc.origin, tile);
+	buildLodMesh(tile, desc, mesh);
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*
+* File: noise.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program defines deterministic 2D value noise and layered
+			   fractal noise used by the terrain generator
+*/
+
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <cmath>
+#include <cstdint>
+
+namespace noise
+{
+	/*
+	* Hashes integer lattice coordinates and a seed into 32 well mixed bits
+	* Parameters:
+	* - x: Lattice x-coordinate
+	* - z: Lattice z-coordinate
+	* - seed: World seed
+	* Returns: Hash value
+	*/
+	inline std::uint32_t hash(int x, int z, std::uint32_t seed)
+	{
+		std::uint32_t h{ seed };
+		h ^= static_cast<std::uint32_t>(x) * 0x27d4eb2du;
+		h ^= static_cast<std::uint32_t>(z) * 0x165667b1u;
+		h ^= h >> 15;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	// Lattice value in [-1, 1]
+	inline float lattice(int x, int z, std::uint32_t seed)
+	{
+		return static_cast<float>(hash(x, z, seed) & 0xFFFFFF) / static_cast<float>(0x7FFFFF) - 1.0f;
+	}
+
+	/*
+	* Smoothly interpolated value noise
+	* Parameters:
+	* - x: Sample x-coordinate in lattice units
+	* - z: Sample z-coordinate in lattice units
+	* - seed: World seed
+	* Returns: Noise value in [-1, 1]
+	*/
+	inline float value(float x, float z, std::uint32_t seed)
+	{
+		float floorX{ std::floor(x) };
+		float floorZ{ std::floor(z) };
+		int x0{ static_cast<int>(floorX) };
+		int z0{ static_cast<int>(floorZ) };
+
+		// Quintic fade for continuous slopes between cells
+		float tx{ x - floorX };
+		float tz{ z - floorZ };
+		tx = tx * tx * tx * (tx * (tx * 6.0f - 15.0f) + 10.0f);
+		tz = tz * tz * tz * (tz * (tz * 6.0f - 15.0f) + 10.0f);
+
+		float a{ lattice(x0, z0, seed) };
+		float b{ lattice(x0 + 1, z0, seed) };
+		float c{ lattice(x0, z0 + 1, seed) };
+		float d{ lattice(x0 + 1, z0 + 1, seed) };
+
+		float top{ a + (b - a) * tx };
+		float bottom{ c + (d - c) * tx };
+		return top + (bottom - top) * tz;
+	}
+
+	/*
+	* Sums octaves of value noise with rising frequency and falling amplitude
+	* Parameters:
+	* - x: Sample x-coordinate in world units
+	* - z: Sample z-coordinate in world units
+	* - seed: World seed
+	* - octaves: Number of layers
+	* - frequency: Frequency of the first layer
+	* Returns: Noise value roughly in [-1, 1]
+	*/
+	inline float fractal(float x, float z, std::uint32_t seed, int octaves, float frequency)
+	{
+		float sum{ 0.0f };
+		float amplitude{ 1.0f };
+		float total{ 0.0f };
+
+		for (int i{ 0 }; i < octaves; ++i)
+		{
+			sum += value(x * frequency, z * frequency, seed + static_cast<std::uint32_t>(i) * 1013u) * amplitude;
+			total += amplitude;
+			amplitude *= 0.5f;
+			frequency *= 2.0f;
+		}
+
+		return sum / total;
+	}
+}
+
+#endif
@@ -0,0 +1,181 @@
+/*
+* File: palette_storage.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program stores a fixed number of blocks as a small local palette
+			   of block types plus bit-packed palette indices. The index width grows
+			   with the palette and a single-value storage keeps no indices at all
+*/
+
+#ifndef PALETTE_STORAGE_H
+#define PALETTE_STORAGE_H
+
+#include "block.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class PaletteStorage
+{
+public:
+	/*
+	* Creates storage where every entry holds the same block
+	* Parameters:
+	* - size: Number of entries
+	* - fill: Block every entry starts as
+	* Returns: PaletteStorage object
+	*/
+	explicit PaletteStorage(int size = 0, BlockType fill = BlockType::air)
+		: m_size{ size }
+		, m_palette{ fill }
+	{
+	}
+
+	BlockType get(int index) const
+	{
+		if (m_bits == 0)
+			return m_palette[0];
+		return m_palette[readIndex(index)];
+	}
+
+	/*
+	* Writes an entry, adding the block to the palette and widening the indices if needed
+	* Parameters:
+	* - index: Entry to write
+	* - block: New block type
+	* Returns: void
+	*/
+	void set(int index, BlockType block)
+	{
+		int paletteIndex{ find(block) };
+		if (paletteIndex < 0)
+		{
+			if (static_cast<int>(m_palette.size()) == (1 << m_bits))
+				repack(m_bits == 0 ? 1 : m_bits * 2);
+
+			m_palette.push_back(block);
+			paletteIndex = static_cast<int>(m_palette.size()) - 1;
+		}
+
+		if (m_bits != 0)
+			writeIndex(index, paletteIndex);
+	}
+
+	/*
+	* Drops palette entries no longer referenced and narrows the indices to fit,
+	* collapsing to a single value when only one block type is left
+	* Parameters: None
+	* Returns: void
+	*/
+	void compact()
+	{
+		if (m_bits == 0)
+			return;
+
+		std::vector<int> usage(m_palette.size(), 0);
+		for (int i{ 0 }; i < m_size; ++i)
+			++usage[readIndex(i)];
+
+		std::vector<int> remap(m_palette.size(), -1);
+		std::vector<BlockType> palette{};
+		for (std::size_t i{ 0 }; i < m_palette.size(); ++i)
+		{
+			if (usage[i] > 0)
+			{
+				remap[i] = static_cast<int>(palette.size());
+				palette.push_back(m_palette[i]);
+			}
+		}
+
+		int bits{ bitsFor(static_cast<int>(palette.size())) };
+		if (palette.size() == m_palette.size() && bits == m_bits)
+			return;
+
+		std::vector<std::uint64_t> words(wordCount(bits), 0);
+		for (int i{ 0 }; bits != 0 && i < m_size; ++i)
+			writeIndex(words, bits, i, remap[readIndex(i)]);
+
+		m_palette = std::move(palette);
+		m_words = std::move(words);
+		m_bits = bits;
+	}
+
+	int getBits() const
+	{
+		return m_bits;
+	}
+
+	const std::vector<BlockType>& getPalette() const
+	{
+		return m_palette;
+	}
+
+	// Heap and inline bytes used by this storage
+	std::size_t memoryUsage() const
+	{
+		return sizeof(*this) + m_palette.capacity() * sizeof(BlockType) + m_words.capacity() * sizeof(std::uint64_t);
+	}
+
+private:
+	int m_size{};
+	int m_bits{ 0 };
+	std::vector<BlockType> m_palette{};
+	std::vector<std::uint64_t> m_words{};
+
+	int find(BlockType block) const
+	{
+		for (std::size_t i{ 0 }; i < m_palette.size(); ++i)
+		{
+			if (m_palette[i] == block)
+				return static_cast<int>(i);
+		}
+		return -1;
+	}
+
+	// Index widths are powers of two so no index straddles two words
+	static int bitsFor(int paletteSize)
+	{
+		int bits{ 0 };
+		while ((1 << bits) < paletteSize)
+			bits = bits == 0 ? 1 : bits * 2;
+		return bits;
+	}
+
+	std::size_t wordCount(int bits) const
+	{
+		return (static_cast<std::size_t>(m_size) * bits + 63) / 64;
+	}
+
+	int readIndex(int index) const
+	{
+		std::size_t bit{ static_cast<std::size_t>(index) * m_bits };
+		return static_cast<int>((m_words[bit >> 6] >> (bit & 63)) & ((1ull << m_bits) - 1));
+	}
+
+	void writeIndex(int index, int value)
+	{
+		writeIndex(m_words, m_bits, index, value);
+	}
+
+	static void writeIndex(std::vector<std::uint64_t>& words, int bits, int index, int value)
+	{
+		std::size_t bit{ static_cast<std::size_t>(index) * bits };
+		std::uint64_t mask{ ((1ull << bits) - 1) << (bit & 63) };
+		std::uint64_t& word{ words[bit >> 6] };
+		word = (word & ~mask) | (static_cast<std::uint64_t>(value) << (bit & 63));
+	}
+
+	void repack(int bits)
+	{
+		std::vector<std::uint64_t> words(wordCount(bits), 0);
+		for (int i{ 0 }; m_bits != 0 && i < m_size; ++i)
+			writeIndex(words, bits, i, readIndex(i));
+
+		m_words = std::move(words);
+		m_bits = bits;
+	}
+};
+
+#endif
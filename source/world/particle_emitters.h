@@ -0,0 +1,125 @@
+/*
+* File: particle_emitters.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program ties particle effects to block types. Every frame it
+			   samples surface columns around the camera and spawns an emitter's
+			   effect above the columns topped by its block, so embers rise from
+			   lava and snow falls over snowy ground wherever the terrain has them
+*/
+
+#ifndef PARTICLE_EMITTERS_H
+#define PARTICLE_EMITTERS_H
+
+#include "block.h"
+#include "../render/particle_system.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Spawns an effect above the top face of every surface block of one type
+struct BlockEmitter
+{
+	BlockType block{};
+	// Index returned by ParticleSystem::addEffect
+	int effect{};
+	// Particles per second per surface block
+	float rate{};
+	// Spawn height above the top face
+	float height{};
+};
+
+class ParticleEmitters
+{
+public:
+	/*
+	* Creates the emitters, none are active until added
+	* Parameters:
+	* - radius: Horizontal distance from the camera particles are spawned within
+	* - samplesPerFrame: Surface columns examined each frame, more gives smoother emission
+	* - seed: Seed of the sampling, the same seed and time steps sample the same columns
+	* Returns: ParticleEmitters object
+	*/
+	explicit ParticleEmitters(float radius = 32.0f, int samplesPerFrame = 128, std::uint32_t seed = 7331)
+		: m_radius{ radius }
+		, m_samplesPerFrame{ samplesPerFrame }
+		, m_random{ seed != 0 ? seed : 1u }
+	{
+	}
+
+	void add(const BlockEmitter& emitter)
+	{
+		m_emitters.push_back(emitter);
+		m_pending.push_back(0.0f);
+	}
+
+	/*
+	* Spawns this frame's particles. Each sampled column stands for an equal share of the
+	* area around the camera, so emission follows how much of each block is in range
+	* Parameters:
+	* - particles: Particle system the effects were added to
+	* - center: World position emission is centred on, usually the camera
+	* - deltaTime: Seconds since the last frame
+	* - surfaceBlock: Callable taking (x, z, int& height) for a world column, returning its
+	*   top BlockType and setting height to that block's world y
+	* Returns: void
+	*/
+	template <typename SurfaceBlock>
+	void emit(ParticleSystem& particles, const glm::vec3& center, float deltaTime, const SurfaceBlock& surfaceBlock)
+	{
+		if (m_emitters.empty() || m_samplesPerFrame <= 0)
+			return;
+
+		const float area{ 3.14159265f * m_radius * m_radius };
+		const float columnsPerSample{ area / static_cast<float>(m_samplesPerFrame) };
+
+		for (int sample{ 0 }; sample < m_samplesPerFrame; ++sample)
+		{
+			// Uniform over the disc around the centre
+			float distance{ m_radius * std::sqrt(random()) };
+			float angle{ 6.28318531f * random() };
+			int x{ static_cast<int>(std::floor(center.x + distance * std::cos(angle) + 0.5f)) };
+			int z{ static_cast<int>(std::floor(center.z + distance * std::sin(angle) + 0.5f)) };
+
+			int height{};
+			BlockType block{ surfaceBlock(x, z, height) };
+			for (std::size_t i{ 0 }; i < m_emitters.size(); ++i)
+			{
+				const BlockEmitter& emitter{ m_emitters[i] };
+				if (emitter.block != block)
+					continue;
+
+				m_pending[i] += emitter.rate * deltaTime * columnsPerSample;
+				int count{ static_cast<int>(m_pending[i]) };
+				if (count == 0)
+					continue;
+
+				m_pending[i] -= static_cast<float>(count);
+				glm::vec3 position{ static_cast<float>(x), static_cast<float>(height) + 0.5f + emitter.height, static_cast<float>(z) };
+				particles.spawn(emitter.effect, position, count);
+			}
+		}
+	}
+
+private:
+	std::vector<BlockEmitter> m_emitters{};
+	// Fractional particles carried over to later frames, per emitter
+	std::vector<float> m_pending{};
+	float m_radius{};
+	int m_samplesPerFrame{};
+	std::uint32_t m_random{};
+
+	// Uniform float in [0, 1) from a xorshift generator
+	float random()
+	{
+		m_random ^= m_random << 13;
+		m_random ^= m_random >> 17;
+		m_random ^= m_random << 5;
+		return static_cast<float>(m_random >> 8) * (1.0f / 16777216.0f);
+	}
+};
+
+#endif
@@ -0,0 +1,379 @@
+/*
+* File: region_file.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program persists chunks in region files. A region file holds a
+			   32 x 32 area of chunks behind an offset table, so any single chunk can
+			   be read straight out of the memory mapped file without touching the rest
+*/
+
+#ifndef REGION_FILE_H
+#define REGION_FILE_H
+
+#include "chunk.h"
+#include "chunk_codec.h"
+#include "../io/mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+* File layout, all values little-endian:
+* char[4] "FRRG", uint16 version, uint16 chunks per side, then one entry of uint32
+* offset + uint32 size per chunk in z-major order. An offset of 0 means the chunk
+* was never saved. A payload is never written over a live one: it goes into space no
+* entry points at, or is appended, and only then is its entry switched over and the old
+* space freed. A torn write leaves the previous payload in place. Free space is only
+* reused while no load is decoding from the file, so a load never reads a payload that
+* is being rewritten
+*/
+class RegionFile
+{
+public:
+	static constexpr int chunksPerSide{ 32 };
+	static constexpr int chunkCount{ chunksPerSide * chunksPerSide };
+
+	/*
+	* Opens a region file, reading its offset table if it already exists
+	* Parameters:
+	* - path: Path of the region file
+	* Returns: RegionFile object
+	*/
+	explicit RegionFile(std::string path)
+		: m_path{ std::move(path) }
+	{
+		auto mapping{ std::make_shared<MappedFile>() };
+		if (!mapping->open(m_path.c_str()) || mapping->size() == 0)
+			return;
+
+		if (mapping->size() < headerSize || std::memcmp(mapping->data(), s_magic, sizeof(s_magic)) != 0
+			|| readU16(mapping->data() + 4) != s_version || readU16(mapping->data() + 6) != chunksPerSide)
+		{
+			std::cout << "ERROR::REGION::FILE_NOT_READABLE: " << m_path << '\n';
+			m_broken = true;
+			return;
+		}
+
+		for (int i{ 0 }; i < chunkCount; ++i)
+		{
+			m_table[i].offset = readU32(mapping->data() + tableOffset + i * 8);
+			m_table[i].size = readU32(mapping->data() + tableOffset + i * 8 + 4);
+			if (static_cast<std::uint64_t>(m_table[i].offset) + m_table[i].size > mapping->size())
+				m_table[i] = TableEntry{};
+		}
+		findFreeSpace(mapping->size());
+		m_mapping = std::move(mapping);
+	}
+
+	RegionFile(const RegionFile&) = delete;
+	RegionFile& operator=(const RegionFile&) = delete;
+
+	/*
+	* Decodes a chunk from the mapped file, safe to call from any thread
+	* Parameters:
+	* - chunk: Chunk whose coord selects the entry, receives the blocks
+	* Returns: False if the chunk was never saved or its payload is corrupt
+	*/
+	bool load(Chunk& chunk)
+	{
+		TableEntry entry{};
+		std::shared_ptr<MappedFile> mapping{};
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			entry = m_table[localIndex(chunk.coord)];
+			if (entry.offset == 0)
+				return false;
+
+			// Saves drop the mapping so the next load sees the grown file
+			if (!m_mapping)
+			{
+				m_mapping = std::make_shared<MappedFile>();
+				if (!m_mapping->open(m_path.c_str()))
+				{
+					m_mapping.reset();
+					return false;
+				}
+			}
+			mapping = m_mapping;
+			m_loading.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		bool decoded{ decodeChunk(mapping->data() + entry.offset, entry.size, chunk) };
+		m_loading.fetch_sub(1, std::memory_order_release);
+		if (!decoded)
+		{
+			std::cout << "ERROR::REGION::CHUNK_CORRUPT: " << chunk.coord.x << ' ' << chunk.coord.z << '\n';
+			return false;
+		}
+		return true;
+	}
+
+	/*
+	* Writes an encoded chunk into free space or at the end of the file, then points its
+	* table entry at it and frees the previous payload. Safe to call from any thread
+	* Parameters:
+	* - coord: Coordinate of the chunk
+	* - payload: Bytes written by encodeChunk
+	* Returns: False if the file could not be written
+	*/
+	bool save(ChunkCoord coord, const std::vector<std::uint8_t>& payload)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		if (m_broken)
+			return false;
+
+		std::fstream file{ m_path, std::ios::in | std::ios::out | std::ios::binary };
+		if (!file)
+		{
+			// New file, write the header with an empty table first
+			file.open(m_path, std::ios::out | std::ios::binary | std::ios::trunc);
+			std::vector<char> header(headerSize, 0);
+			std::memcpy(header.data(), s_magic, sizeof(s_magic));
+			writeU16(reinterpret_cast<std::uint8_t*>(header.data()) + 4, s_version);
+			writeU16(reinterpret_cast<std::uint8_t*>(header.data()) + 6, chunksPerSide);
+			file.write(header.data(), header.size());
+		}
+
+		// Without reuse every save of a chunk would leave its old payload behind and the file only grows
+		TableEntry entry{ 0, static_cast<std::uint32_t>(payload.size()) };
+		if (m_loading.load(std::memory_order_acquire) == 0)
+			entry.offset = takeFreeSpace(entry.size);
+		if (entry.offset != 0)
+			file.seekp(entry.offset);
+		else
+		{
+			file.seekp(0, std::ios::end);
+			entry.offset = static_cast<std::uint32_t>(file.tellp());
+		}
+		file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+		// The payload lands before the entry points at it
+		file.flush();
+
+		std::uint8_t bytes[8]{};
+		writeU32(bytes, entry.offset);
+		writeU32(bytes + 4, entry.size);
+		file.seekp(tableOffset + localIndex(coord) * 8);
+		file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+		file.close();
+
+		if (!file)
+		{
+			// The old entry may still be the one on disk, only the new space is given back
+			std::cout << "ERROR::REGION::WRITE_FAILED: " << m_path << '\n';
+			freeSpace(entry);
+			return false;
+		}
+
+		freeSpace(m_table[localIndex(coord)]);
+		m_table[localIndex(coord)] = entry;
+		m_mapping.reset();
+		return true;
+	}
+
+	// Coordinate of the region a chunk belongs to
+	static ChunkCoord regionOf(ChunkCoord coord)
+	{
+		return ChunkCoord{ Chunk::floorDiv(coord.x, chunksPerSide), Chunk::floorDiv(coord.z, chunksPerSide) };
+	}
+
+private:
+	struct TableEntry
+	{
+		std::uint32_t offset{};
+		std::uint32_t size{};
+	};
+
+	static constexpr char s_magic[4]{ 'F', 'R', 'R', 'G' };
+	static constexpr std::uint16_t s_version{ 1 };
+	static constexpr std::size_t tableOffset{ 8 };
+	static constexpr std::size_t headerSize{ tableOffset + chunkCount * 8 };
+
+	std::string m_path{};
+	std::mutex m_mutex{};
+	TableEntry m_table[chunkCount]{};
+	std::shared_ptr<MappedFile> m_mapping{};
+	// Byte ranges after the table no entry points at, sorted by offset and never adjacent
+	std::vector<TableEntry> m_free{};
+	// Loads decoding outside the lock, their payloads must not be overwritten
+	std::atomic<int> m_loading{ 0 };
+	bool m_broken{ false };
+
+	// Collects the gaps between the payloads of an opened file, left by payloads that were replaced
+	void findFreeSpace(std::uint64_t fileSize)
+	{
+		std::vector<TableEntry> used{};
+		for (const TableEntry& entry : m_table)
+		{
+			if (entry.offset != 0)
+				used.push_back(entry);
+		}
+		std::sort(used.begin(), used.end(), [](const TableEntry& a, const TableEntry& b) { return a.offset < b.offset; });
+
+		std::uint64_t end{ headerSize };
+		for (const TableEntry& entry : used)
+		{
+			if (entry.offset > end)
+				m_free.push_back(TableEntry{ static_cast<std::uint32_t>(end), static_cast<std::uint32_t>(entry.offset - end) });
+			end = std::max(end, static_cast<std::uint64_t>(entry.offset) + entry.size);
+		}
+		if (fileSize > end)
+			m_free.push_back(TableEntry{ static_cast<std::uint32_t>(end), static_cast<std::uint32_t>(fileSize - end) });
+	}
+
+	// First fit, returns 0 when no free range is large enough
+	std::uint32_t takeFreeSpace(std::uint32_t size)
+	{
+		for (std::size_t i{ 0 }; i < m_free.size(); ++i)
+		{
+			TableEntry& range{ m_free[i] };
+			if (range.size < size)
+				continue;
+
+			std::uint32_t offset{ range.offset };
+			range.offset += size;
+			range.size -= size;
+			if (range.size == 0)
+				m_free.erase(m_free.begin() + static_cast<std::ptrdiff_t>(i));
+			return offset;
+		}
+		return 0;
+	}
+
+	// Returns a range to the free list, merging it with its neighbours
+	void freeSpace(const TableEntry& range)
+	{
+		if (range.offset == 0 || range.size == 0)
+			return;
+
+		auto next{ std::lower_bound(m_free.begin(), m_free.end(), range, [](const TableEntry& a, const TableEntry& b) { return a.offset < b.offset; }) };
+		next = m_free.insert(next, range);
+		if (next + 1 != m_free.end() && next->offset + next->size == (next + 1)->offset)
+		{
+			next->size += (next + 1)->size;
+			m_free.erase(next + 1);
+		}
+		if (next != m_free.begin() && (next - 1)->offset + (next - 1)->size == next->offset)
+		{
+			(next - 1)->size += next->size;
+			m_free.erase(next);
+		}
+	}
+
+	static int localIndex(ChunkCoord coord)
+	{
+		int x{ coord.x - Chunk::floorDiv(coord.x, chunksPerSide) * chunksPerSide };
+		int z{ coord.z - Chunk::floorDiv(coord.z, chunksPerSide) * chunksPerSide };
+		return z * chunksPerSide + x;
+	}
+
+	static std::uint16_t readU16(const std::uint8_t* bytes)
+	{
+		return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+	}
+
+	static std::uint32_t readU32(const std::uint8_t* bytes)
+	{
+		return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8)
+			| (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+	}
+
+	static void writeU16(std::uint8_t* bytes, std::uint16_t value)
+	{
+		bytes[0] = static_cast<std::uint8_t>(value & 0xFF);
+		bytes[1] = static_cast<std::uint8_t>(value >> 8);
+	}
+
+	static void writeU32(std::uint8_t* bytes, std::uint32_t value)
+	{
+		for (int i{ 0 }; i < 4; ++i)
+			bytes[i] = static_cast<std::uint8_t>(value >> (i * 8));
+	}
+};
+
+/*
+* The region files of one world, opened lazily as chunks in them are requested
+*/
+class RegionStore
+{
+public:
+	/*
+	* Creates the store, the directory is created on the first save
+	* Parameters:
+	* - directory: Directory the region files live in
+	* Returns: RegionStore object
+	*/
+	explicit RegionStore(std::string directory)
+		: m_directory{ std::move(directory) }
+	{
+	}
+
+	RegionStore(const RegionStore&) = delete;
+	RegionStore& operator=(const RegionStore&) = delete;
+
+	/*
+	* Loads a saved chunk, safe to call from streaming threads
+	* Parameters:
+	* - chunk: Chunk whose coord is set, receives the saved blocks
+	* Returns: False if the chunk has never been saved
+	*/
+	bool load(Chunk& chunk)
+	{
+		return getRegion(chunk.coord).load(chunk);
+	}
+
+	/*
+	* Encodes and writes a chunk, marking it clean on success
+	* Parameters:
+	* - chunk: Chunk to save
+	* Returns: False if the region file could not be written
+	*/
+	bool save(Chunk& chunk)
+	{
+		std::vector<std::uint8_t> payload{};
+		encodeChunk(chunk, payload);
+
+		if (!m_directoryCreated.load(std::memory_order_acquire))
+		{
+			std::error_code error{};
+			std::filesystem::create_directories(m_directory, error);
+			m_directoryCreated.store(true, std::memory_order_release);
+		}
+
+		if (!getRegion(chunk.coord).save(chunk.coord, payload))
+			return false;
+
+		chunk.clearDirty();
+		return true;
+	}
+
+private:
+	std::string m_directory{};
+	std::atomic<bool> m_directoryCreated{ false };
+	std::mutex m_mutex{};
+	std::unordered_map<ChunkCoord, std::unique_ptr<RegionFile>, ChunkCoordHash> m_regions{};
+
+	RegionFile& getRegion(ChunkCoord coord)
+	{
+		ChunkCoord region{ RegionFile::regionOf(coord) };
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		std::unique_ptr<RegionFile>& file{ m_regions[region] };
+		if (!file)
+			file = std::make_unique<RegionFile>(m_directory + "/r." + std::to_string(region.x) + '.' + std::to_string(region.z) + ".region");
+		return *file;
+	}
+};
+
+#endif
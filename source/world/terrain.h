@@ -0,0 +1,132 @@
+/*
+* File: terrain.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program generates endless terrain from layered noise. A low
+			   frequency temperature map picks the biome of each column, which decides
+			   whether it is topped with grass, snow or dirt with pools of lava
+*/
+
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include "block.h"
+#include "chunk.h"
+#include "noise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Everything the generator knows about one column of blocks
+struct TerrainColumn
+{
+	int height{};
+	BlockType surface{ BlockType::grass };
+	// Lava fills the column from height + 1 up to this y
+	int lavaTop{};
+};
+
+class TerrainGenerator
+{
+public:
+	// Lava pools fill volcanic valleys up to this height
+	static constexpr int lavaLevel{ -2 };
+
+	explicit TerrainGenerator(std::uint32_t seed = 1337)
+		: m_seed{ seed }
+	{
+	}
+
+	/*
+	* Computes height, surface and lava of a column
+	* Parameters:
+	* - x: World block x-coordinate
+	* - z: World block z-coordinate
+	* Returns: The column description
+	*/
+	TerrainColumn getColumn(int x, int z) const
+	{
+		// The original hand built spawn area: a grass slab with a strip of lava along its edge
+		if (x >= spawnMinX && x <= spawnMaxX && z >= spawnMinZ && z <= spawnMaxZ)
+			return TerrainColumn{ 0, z == spawnMinZ ? BlockType::lava : BlockType::grass, 0 };
+
+		float fx{ static_cast<float>(x) };
+		float fz{ static_cast<float>(z) };
+
+		float hills{ noise::fractal(fx, fz, m_seed, 5, 1.0f / 64.0f) * 12.0f };
+		float mountains{ std::max(0.0f, noise::fractal(fx, fz, m_seed + 31u, 3, 1.0f / 192.0f)) * 24.0f };
+
+		// Blend towards flat ground close to spawn so the slab sits in a clearing
+		float dx{ static_cast<float>(std::max({ spawnMinX - x, x - spawnMaxX, 0 })) };
+		float dz{ static_cast<float>(std::max({ spawnMinZ - z, z - spawnMaxZ, 0 })) };
+		float t{ std::min(1.0f, std::sqrt(dx * dx + dz * dz) / 16.0f) };
+		t = t * t * (3.0f - 2.0f * t);
+
+		TerrainColumn column{};
+		column.height = static_cast<int>(std::round((hills + mountains) * t));
+		column.height = std::clamp(column.height, Chunk::minY + 1, Chunk::minY + Chunk::sizeY - 2);
+		column.lavaTop = column.height;
+
+		float temperature{ noise::fractal(fx, fz, m_seed + 7u, 3, 1.0f / 256.0f) };
+		if (temperature < -0.3f || column.height > 20)
+		{
+			column.surface = BlockType::snow;
+		}
+		else if (temperature > 0.3f)
+		{
+			column.surface = BlockType::dirt;
+			column.lavaTop = std::max(column.height, lavaLevel);
+		}
+
+		return column;
+	}
+
+	static BlockType blockInColumn(const TerrainColumn& column, int y)
+	{
+		if (y < column.height)
+			return BlockType::dirt;
+		if (y == column.height)
+			return column.surface;
+		if (y <= column.lavaTop)
+			return BlockType::lava;
+		return BlockType::air;
+	}
+
+	BlockType getBlock(int x, int y, int z) const
+	{
+		return blockInColumn(getColumn(x, z), y);
+	}
+
+	/*
+	* Fills a chunk with generated blocks
+	* Parameters:
+	* - chunk: Chunk whose coord is already set
+	* Returns: void
+	*/
+	void generate(Chunk& chunk) const
+	{
+		for (int z{ 0 }; z < Chunk::sizeZ; ++z)
+		{
+			for (int x{ 0 }; x < Chunk::sizeX; ++x)
+			{
+				TerrainColumn column{ getColumn(chunk.worldX() + x, chunk.worldZ() + z) };
+				int top{ std::max(column.height, column.lavaTop) - Chunk::minY };
+				for (int y{ 0 }; y <= top && y < Chunk::sizeY; ++y)
+					chunk.set(x, y, z, blockInColumn(column, y + Chunk::minY));
+			}
+		}
+
+		chunk.compact();
+	}
+
+private:
+	static constexpr int spawnMinX{ -8 };
+	static constexpr int spawnMaxX{ 7 };
+	static constexpr int spawnMinZ{ -9 };
+	static constexpr int spawnMaxZ{ 7 };
+
+	std::uint32_t m_seed{};
+};
+
+#endif
@@ -0,0 +1,415 @@
+/*
+* File: terrain_lod.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program draws the terrain beyond the full detail chunks at
+			   reduced resolution. Rings of chunk distance around the camera pick
+			   each chunk's level, every ring twice as wide as the one before at a
+			   quarter of the cost per chunk, so each ring costs about the same
+			   number of triangles. When the camera enters another chunk the tiles
+			   the rings moved over are rebuilt on the job system and swapped in
+			   together, so the rings never show half moved
+*/
+
+#ifndef TERRAIN_LOD_H
+#define TERRAIN_LOD_H
+
+#include "chunk.h"
+#include "chunk_mesher.h"
+#include "lod_mesher.h"
+#include "terrain.h"
+#include "../job/job_system.h"
+#include "../render/frustum.h"
+#include "../render/vertex_pool.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class TerrainLod
+{
+public:
+	/*
+	* Creates the level of detail terrain, nothing is built until the first update
+	* Parameters:
+	* - jobs: Job system the tiles are built on
+	* - generator: Terrain generator the tiles are sampled from
+	* - nearRadius: View radius in chunks of the full detail chunks, the first ring starts past it
+	* - levels: Number of reduced levels, at most lod::maxLevel
+	* Returns: TerrainLod object
+	*/
+	TerrainLod(JobSystem& jobs, const TerrainGenerator& generator, int nearRadius, int levels = lod::maxLevel)
+		: m_jobs{ jobs }
+		, m_generator{ generator }
+		, m_rings{ lod::Rings::doubling(nearRadius, levels) }
+		, m_maxInFlight{ std::max(2, jobs.getThreadCount() * 2) }
+	{
+		m_farRadius = nearRadius << m_rings.levels;
+		for (int dz{ -m_farRadius }; dz <= m_farRadius; ++dz)
+		{
+			for (int dx{ -m_farRadius }; dx <= m_farRadius; ++dx)
+			{
+				if (m_rings.levelOf(dx, dz) > 0)
+					m_offsets.push_back(ChunkCoord{ dx, dz });
+			}
+		}
+	}
+
+	~TerrainLod()
+	{
+		m_jobs.wait(m_inFlight);
+	}
+
+	TerrainLod(const TerrainLod&) = delete;
+	TerrainLod& operator=(const TerrainLod&) = delete;
+
+	/*
+	* Swaps in the rings around the last centre once all of their tiles are built, then
+	* starts on the camera's current chunk if it has moved on. Until a swap the tiles
+	* keep drawing the rings of the centre before
+	* Parameters:
+	* - cameraPosition: World position of the camera
+	* Returns: void
+	*/
+	void update(const glm::vec3& cameraPosition)
+	{
+		m_target = Chunk::coordAt(cameraPosition.x, cameraPosition.z);
+
+		collectFinished();
+		if (m_placing && m_pending == 0)
+			swapRings();
+
+		if (!m_placing && (!m_shown || m_target != m_center))
+			placeRings(m_target);
+
+		requestTiles();
+	}
+
+	/*
+	* Draws the tiles in view grouped by block type, nearest tile first within a type.
+	* The chunk shader must be in use, the tiles share the chunk vertex layout
+	* Parameters:
+	* - frustum: View frustum of the camera
+	* - position: World position of the camera
+	* - bindMaterial: Callable taking a BlockType that binds its textures
+	* Returns: void
+	*/
+	template <typename BindMaterial>
+	void draw(const Frustum& frustum, const glm::vec3& position, const BindMaterial& bindMaterial)
+	{
+		glBindVertexArray(m_vertexPool.getVertexArray());
+		collectVisible(frustum, position);
+
+		for (int type{ 1 }; type < blockTypeCount; ++type)
+		{
+			bool bound{ false };
+			for (const VisibleTile& visible : m_visible)
+			{
+				const Tile* tile{ visible.tile };
+				const ChunkMeshRange& range{ tile->ranges[type] };
+				if (range.count == 0)
+					continue;
+
+				if (!bound)
+				{
+					bindMaterial(static_cast<BlockType>(type));
+					bound = true;
+				}
+
+				glDrawArrays(GL_TRIANGLES, tile->first + range.first, range.count);
+			}
+		}
+		glBindVertexArray(0);
+	}
+
+	/*
+	* Draws the whole mesh of every tile in view, nearest first with one call per tile.
+	* For passes that bind no material, such as the depth pre-pass
+	* Parameters:
+	* - frustum: View frustum of the camera
+	* - position: World position of the camera
+	* Returns: void
+	*/
+	void drawDepth(const Frustum& frustum, const glm::vec3& position)
+	{
+		glBindVertexArray(m_vertexPool.getVertexArray());
+		collectVisible(frustum, position);
+
+		for (const VisibleTile& visible : m_visible)
+			glDrawArrays(GL_TRIANGLES, visible.tile->first, visible.tile->vertexCount);
+		glBindVertexArray(0);
+	}
+
+	/*
+	* Returns the chunk the drawn rings are centred on, the camera's chunk until the first
+	* rings are in. The full detail chunks must be drawn around the same chunk to meet
+	* the first ring without gaps or overlap
+	* Returns: Centre chunk of the drawn rings
+	*/
+	ChunkCoord getCenter() const
+	{
+		return m_shown ? m_center : m_target;
+	}
+
+	// Distance in blocks from the camera's chunk to the edge of the last ring
+	float getViewDistance() const
+	{
+		return static_cast<float>((m_farRadius + 1) * Chunk::sizeX);
+	}
+
+	std::size_t getTileCount() const
+	{
+		return m_tiles.size();
+	}
+
+	// Triangles of every uploaded tile, whether in view or not
+	int getTriangleCount() const
+	{
+		return m_vertices / 3;
+	}
+
+	// True while the rings around a new centre are being built
+	bool isStreaming() const
+	{
+		return m_placing;
+	}
+
+private:
+	struct TileKey
+	{
+		int level{};
+		ChunkCoord origin{};
+
+		bool operator==(const TileKey& other) const
+		{
+			return level == other.level && origin == other.origin;
+		}
+	};
+
+	struct TileKeyHash
+	{
+		std::size_t operator()(const TileKey& key) const
+		{
+			return ChunkCoordHash{}(key.origin) * 31u + static_cast<std::size_t>(key.level);
+		}
+	};
+
+	struct Tile
+	{
+		// What the tile should show and what its mesh was built from
+		lod::TileDesc wanted{};
+		lod::TileDesc built{};
+		// Sampled by the first build, every later build only meshes
+		std::shared_ptr<const lod::TileCells> cells{};
+		int first{ -1 };
+		int vertexCount{ 0 };
+		ChunkMeshRange ranges[blockTypeCount]{};
+		glm::vec3 boundsMin{};
+		glm::vec3 boundsMax{};
+	};
+
+	struct VisibleTile
+	{
+		float distance{};
+		const Tile* tile{};
+	};
+
+	struct BuiltTile
+	{
+		lod::TileDesc desc{};
+		std::shared_ptr<const lod::TileCells> cells{};
+		ChunkMesh mesh{};
+	};
+
+	JobSystem& m_jobs;
+	const TerrainGenerator& m_generator;
+	lod::Rings m_rings{};
+	int m_maxInFlight{};
+	int m_farRadius{};
+
+	// Chunk offsets drawn at a reduced level
+	std::vector<ChunkCoord> m_offsets{};
+	// Camera chunk, centre of the drawn rings and whether any are drawn yet
+	ChunkCoord m_target{};
+	ChunkCoord m_center{};
+	bool m_shown{ false };
+
+	std::unordered_map<TileKey, Tile, TileKeyHash> m_tiles{};
+	// Nearest first
+	std::vector<VisibleTile> m_visible{};
+
+	// Rings being built around m_placed, swapped in when no tile is pending
+	ChunkCoord m_placed{};
+	bool m_placing{ false };
+	int m_pending{ 0 };
+	std::vector<Tile*> m_queued{};
+	std::vector<std::unique_ptr<BuiltTile>> m_staged{};
+
+	// Reduced chunks are small, the pool starts at the size of a few full detail ones
+	static constexpr int initialPoolVertices{ 256 * 1024 };
+	VertexPool m_vertexPool{ initialPoolVertices };
+	int m_vertices{ 0 };
+
+	JobCounter m_inFlight{};
+	std::mutex m_finishedMutex{};
+	std::vector<std::unique_ptr<BuiltTile>> m_finished{};
+
+	static ChunkCoord tileOrigin(const ChunkCoord& coord)
+	{
+		return ChunkCoord{ Chunk::floorDiv(coord.x, lod::tileChunks) * lod::tileChunks, Chunk::floorDiv(coord.z, lod::tileChunks) * lod::tileChunks };
+	}
+
+	// Gathers the tiles in the frustum into m_visible, sorted by distance to their bounds
+	void collectVisible(const Frustum& frustum, const glm::vec3& position)
+	{
+		m_visible.clear();
+		for (const auto& [key, tile] : m_tiles)
+		{
+			if (tile.vertexCount > 0 && frustum.intersectsBox(tile.boundsMin, tile.boundsMax))
+				m_visible.push_back(VisibleTile{ glm::length(glm::clamp(position, tile.boundsMin, tile.boundsMax) - position), &tile });
+		}
+
+		std::sort(m_visible.begin(), m_visible.end(), [](const VisibleTile& a, const VisibleTile& b)
+			{
+				return a.distance < b.distance;
+			});
+	}
+
+	// Works out what every tile holds around the new centre and queues the ones that change
+	void placeRings(const ChunkCoord& center)
+	{
+		m_placed = center;
+		m_placing = true;
+
+		// Tiles the rings moved off stay until the swap empties them
+		for (const ChunkCoord& offset : m_offsets)
+		{
+			ChunkCoord coord{ center.x + offset.x, center.z + offset.z };
+			m_tiles[TileKey{ m_rings.levelOf(offset.x, offset.z), tileOrigin(coord) }];
+		}
+
+		for (auto& [key, tile] : m_tiles)
+		{
+			tile.wanted = lod::describeTile(m_rings, center, key.level, key.origin);
+			if (tile.wanted == tile.built)
+				continue;
+
+			if (tile.wanted.members == 0)
+			{
+				// Emptied tiles need no job, their mesh just goes at the swap
+				auto built{ std::make_unique<BuiltTile>() };
+				built->desc = tile.wanted;
+				m_staged.push_back(std::move(built));
+				continue;
+			}
+
+			m_queued.push_back(&tile);
+			++m_pending;
+		}
+	}
+
+	// Starts queued builds within the in-flight limit so chunk streaming keeps its share of the workers
+	void requestTiles()
+	{
+		while (!m_queued.empty() && m_inFlight.value.load(std::memory_order_relaxed) < m_maxInFlight)
+		{
+			const Tile& tile{ *m_queued.back() };
+			m_queued.pop_back();
+
+			m_jobs.runBackground([this, desc = tile.wanted, cells = tile.cells]()
+				{
+					auto built{ std::make_unique<BuiltTile>() };
+					built->desc = desc;
+					built->cells = cells;
+					if (!built->cells)
+					{
+						auto sampled{ std::make_shared<lod::TileCells>() };
+						lod::sampleTile(m_generator, desc.level, desc.origin, *sampled);
+						built->cells = std::move(sampled);
+					}
+					buildLodMesh(*built->cells, desc, built->mesh);
+
+					std::lock_guard<std::mutex> lock{ m_finishedMutex };
+					m_finished.push_back(std::move(built));
+				}, &m_inFlight);
+		}
+	}
+
+	// Moves finished builds to the main thread, keeping the cells for the tile's next build
+	void collectFinished()
+	{
+		std::lock_guard<std::mutex> lock{ m_finishedMutex };
+		for (std::unique_ptr<BuiltTile>& built : m_finished)
+		{
+			// Tiles are only erased at a swap, which waits for every build
+			Tile& tile{ m_tiles.find(TileKey{ built->desc.level, built->desc.origin })->second };
+			if (!tile.cells)
+				tile.cells = built->cells;
+			m_staged.push_back(std::move(built));
+			--m_pending;
+		}
+		m_finished.clear();
+	}
+
+	// Replaces the meshes of every changed tile in one frame and drops emptied tiles
+	void swapRings()
+	{
+		for (const std::unique_ptr<BuiltTile>& built : m_staged)
+		{
+			Tile& tile{ m_tiles.find(TileKey{ built->desc.level, built->desc.origin })->second };
+			release(tile);
+			uploadMesh(tile, *built);
+		}
+		m_staged.clear();
+
+		for (auto it{ m_tiles.begin() }; it != m_tiles.end(); )
+		{
+			if (it->second.built.members == 0)
+				it = m_tiles.erase(it);
+			else
+				++it;
+		}
+
+		m_center = m_placed;
+		m_shown = true;
+		m_placing = false;
+	}
+
+	void uploadMesh(Tile& tile, const BuiltTile& built)
+	{
+		tile.built = built.desc;
+		std::copy(std::begin(built.mesh.ranges), std::end(built.mesh.ranges), std::begin(tile.ranges));
+		tile.vertexCount = static_cast<int>(built.mesh.vertices.size()) / VertexPool::floatsPerVertex;
+		if (tile.vertexCount == 0)
+			return;
+
+		tile.first = m_vertexPool.allocate(built.mesh.vertices.data(), tile.vertexCount);
+		m_vertices += tile.vertexCount;
+
+		float minX{ static_cast<float>(built.desc.origin.x * Chunk::sizeX) - 0.5f };
+		float minZ{ static_cast<float>(built.desc.origin.z * Chunk::sizeZ) - 0.5f };
+		float side{ static_cast<float>(lod::tileChunks * Chunk::sizeX) };
+		tile.boundsMin = glm::vec3(minX, Chunk::minY - 0.5f, minZ);
+		tile.boundsMax = glm::vec3(minX + side, Chunk::minY + Chunk::sizeY - 0.5f, minZ + side);
+	}
+
+	void release(Tile& tile)
+	{
+		if (tile.vertexCount > 0)
+			m_vertexPool.release(tile.first, tile.vertexCount);
+		m_vertices -= tile.vertexCount;
+		tile.first = -1;
+		tile.vertexCount = 0;
+		std::fill(std::begin(tile.ranges), std::end(tile.ranges), ChunkMeshRange{});
+	}
+};
+
+#endif
@@ -0,0 +1,457 @@
+/*
+* File: voxel_octree.h
+* Author: Simon Olesen
+* Date: 2026-10-18
+* Description: This program stores a region of the world as a sparse voxel octree.
+			   Regions of a single block type collapse into one node, and nodes are
+			   32-bit values in one flat array with the eight children of a node
+			   stored next to each other, so no node holds pointers. Ray and box
+			   queries step over whole empty nodes instead of single blocks, which
+			   keeps long raycasts and far-field lookups cheap
+*/
+
+#ifndef VOXEL_OCTREE_H
+#define VOXEL_OCTREE_H
+
+#include "block.h"
+#include "chunk.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+struct OctreeRayHit
+{
+	bool hit{ false };
+	// World coordinates of the block that was hit
+	glm::ivec3 block{};
+	// Outward normal of the face the ray entered through, zero if it started inside the block
+	glm::ivec3 normal{};
+	float distance{};
+	BlockType type{ BlockType::air };
+};
+
+class VoxelOctree
+{
+public:
+	// Deepest tree supported, a 65536 block wide cube
+	static constexpr int maxDepth{ 16 };
+
+	/*
+	* Builds the tree over a box of blocks, replacing any previous contents. The tree is a
+	* cube with a power of two side covering the box, blocks outside the box are air
+	* Parameters:
+	* - origin: World coordinates of the box's lowest corner block
+	* - size: Size of the box in blocks
+	* - sample: Callable taking world (x, y, z) and returning its BlockType
+	* - uniform: Callable taking a cube's world lowest corner, its side and a BlockType&, returning
+	*   true and setting the block if the whole cube is known to be that block without sampling it
+	* Returns: void
+	*/
+	template <typename Sample, typename Uniform>
+	void build(const glm::ivec3& origin, const glm::ivec3& size, const Sample& sample, const Uniform& uniform)
+	{
+		m_origin = origin;
+		m_size = glm::max(size, glm::ivec3(1));
+		m_depth = 0;
+		while ((1 << m_depth) < std::max({ m_size.x, m_size.y, m_size.z }) && m_depth < maxDepth)
+			++m_depth;
+		m_side = 1 << m_depth;
+
+		m_nodes.clear();
+		m_root = buildNode(glm::ivec3(0), m_side, sample, uniform);
+		m_nodes.shrink_to_fit();
+	}
+
+	template <typename Sample>
+	void build(const glm::ivec3& origin, const glm::ivec3& size, const Sample& sample)
+	{
+		build(origin, size, sample, [](const glm::ivec3&, int, BlockType&) { return false; });
+	}
+
+	/*
+	* Builds the tree over a rectangle of chunks. Sections holding a single block type are
+	* taken whole instead of being read block by block
+	* Parameters:
+	* - minCoord: Coordinate of the chunk in the lowest x and z corner
+	* - chunksX: Number of chunks along x
+	* - chunksZ: Number of chunks along z
+	* - chunkAt: Callable taking a ChunkCoord and returning a const Chunk*, nullptr for air
+	* Returns: void
+	*/
+	template <typename ChunkAt>
+	void buildFromChunks(ChunkCoord minCoord, int chunksX, int chunksZ, const ChunkAt& chunkAt)
+	{
+		const glm::ivec3 origin{ minCoord.x * Chunk::sizeX, Chunk::minY, minCoord.z * Chunk::sizeZ };
+
+		auto sample{ [&chunkAt](int x, int y, int z)
+			{
+				const Chunk* chunk{ chunkAt(ChunkCoord{ Chunk::floorDiv(x, Chunk::sizeX), Chunk::floorDiv(z, Chunk::sizeZ) }) };
+				return chunk ? chunk->get(x - chunk->worldX(), y - Chunk::minY, z - chunk->worldZ()) : BlockType::air;
+			} };
+
+		// The tree is aligned to the chunks, so cubes up to a section's height lie within one section
+		auto uniform{ [&chunkAt](const glm::ivec3& min, int side, BlockType& block)
+			{
+				if (side > Chunk::sectionHeight || side > Chunk::sizeX || side > Chunk::sizeZ)
+					return false;
+
+				const Chunk* chunk{ chunkAt(ChunkCoord{ Chunk::floorDiv(min.x, Chunk::sizeX), Chunk::floorDiv(min.z, Chunk::sizeZ) }) };
+				if (!chunk)
+				{
+					block = BlockType::air;
+					return true;
+				}
+
+				const PaletteStorage& section{ chunk->getSection((min.y - Chunk::minY) / Chunk::sectionHeight) };
+				if (section.getBits() != 0)
+					return false;
+				block = section.getPalette()[0];
+				return true;
+			} };
+
+		build(origin, glm::ivec3(chunksX * Chunk::sizeX, Chunk::sizeY, chunksZ * Chunk::sizeZ), sample, uniform);
+	}
+
+	/*
+	* Reads a block by world coordinates
+	* Parameters:
+	* - x: World x-coordinate
+	* - y: World y-coordinate
+	* - z: World z-coordinate
+	* Returns: The block type, air outside the tree
+	*/
+	BlockType get(int x, int y, int z) const
+	{
+		glm::ivec3 cell{ x - m_origin.x, y - m_origin.y, z - m_origin.z };
+		if (!insideTree(cell))
+			return BlockType::air;
+
+		std::uint32_t node{ m_root };
+		int side{ m_side };
+		while (!isLeaf(node))
+		{
+			side >>= 1;
+			node = m_nodes[node + childIndex(cell, side)];
+		}
+		return leafBlock(node);
+	}
+
+	/*
+	* Finds the first solid block along a ray, stepping over empty nodes whole. Blocks are
+	* centered on integer coordinates like everywhere else in the world
+	* Parameters:
+	* - origin: World position the ray starts at
+	* - direction: Direction of the ray, does not need to be normalized
+	* - maxDistance: Furthest distance a hit is reported at
+	* Returns: The hit, hit is false if nothing solid is within reach
+	*/
+	OctreeRayHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+	{
+		OctreeRayHit result{};
+		float length{ glm::length(direction) };
+		if (length == 0.0f || m_side == 0)
+			return result;
+
+		const glm::vec3 dir{ direction / length };
+		const glm::vec3 start{ origin + 0.5f - glm::vec3(m_origin) };
+		const float side{ static_cast<float>(m_side) };
+
+		// Clip the ray to the tree's cube
+		float t{ 0.0f };
+		float tLeave{ maxDistance };
+		int axis{ -1 };
+		for (int a{ 0 }; a < 3; ++a)
+		{
+			if (dir[a] == 0.0f)
+			{
+				if (start[a] < 0.0f || start[a] >= side)
+					return result;
+				continue;
+			}
+
+			float t0{ -start[a] / dir[a] };
+			float t1{ (side - start[a]) / dir[a] };
+			if (t0 > t1)
+				std::swap(t0, t1);
+			if (t0 > t)
+			{
+				t = t0;
+				axis = a;
+			}
+			tLeave = std::min(tLeave, t1);
+		}
+		if (t > tLeave)
+			return result;
+
+		glm::ivec3 cell{};
+		for (int a{ 0 }; a < 3; ++a)
+			cell[a] = std::clamp(static_cast<int>(std::floor(start[a] + dir[a] * t)), 0, m_side - 1);
+
+		while (true)
+		{
+			std::uint32_t node{ m_root };
+			glm::ivec3 nodeMin{ 0 };
+			int nodeSide{ m_side };
+			while (!isLeaf(node))
+			{
+				nodeSide >>= 1;
+				int child{ childIndex(cell, nodeSide) };
+				nodeMin += childOffset(child, nodeSide);
+				node = m_nodes[node + child];
+			}
+
+			BlockType block{ leafBlock(node) };
+			if (isSolid(block))
+			{
+				result.hit = true;
+				result.block = cell + m_origin;
+				if (axis >= 0)
+					result.normal[axis] = dir[axis] > 0.0f ? -1 : 1;
+				result.distance = t;
+				result.type = block;
+				return result;
+			}
+
+			// Leave the whole node through its nearest exit face
+			float tExit{ std::numeric_limits<float>::infinity() };
+			int exitAxis{ 0 };
+			for (int a{ 0 }; a < 3; ++a)
+			{
+				float face;
+				if (dir[a] > 0.0f)
+					face = static_cast<float>(nodeMin[a] + nodeSide);
+				else if (dir[a] < 0.0f)
+					face = static_cast<float>(nodeMin[a]);
+				else
+					continue;
+
+				float tFace{ (face - start[a]) / dir[a] };
+				if (tFace < tExit)
+				{
+					tExit = tFace;
+					exitAxis = a;
+				}
+			}
+			if (tExit > maxDistance)
+				return result;
+
+			t = std::max(t, tExit);
+			axis = exitAxis;
+			int next{ dir[axis] > 0.0f ? nodeMin[axis] + nodeSide : nodeMin[axis] - 1 };
+			if (next < 0 || next >= m_side)
+				return result;
+
+			// The other axes stay on the exit face, which rounding could otherwise push off it
+			for (int a{ 0 }; a < 3; ++a)
+			{
+				if (a != axis)
+					cell[a] = std::clamp(static_cast<int>(std::floor(start[a] + dir[a] * t)), nodeMin[a], nodeMin[a] + nodeSide - 1);
+			}
+			cell[axis] = next;
+		}
+	}
+
+	/*
+	* Checks a box of blocks for solid ones, stopping at the first
+	* Parameters:
+	* - min: World coordinates of the box's lowest corner block
+	* - max: World coordinates of the box's highest corner block, inclusive
+	* Returns: True if any block in the box is solid
+	*/
+	bool overlapsSolid(const glm::ivec3& min, const glm::ivec3& max) const
+	{
+		return !query(min, max, [](const glm::ivec3&, int, BlockType) { return false; });
+	}
+
+	/*
+	* Counts the solid blocks in a box, whole nodes at a time
+	* Parameters:
+	* - min: World coordinates of the box's lowest corner block
+	* - max: World coordinates of the box's highest corner block, inclusive
+	* Returns: Number of solid blocks
+	*/
+	long long countSolid(const glm::ivec3& min, const glm::ivec3& max) const
+	{
+		long long count{ 0 };
+		query(min, max, [&min, &max, &count](const glm::ivec3& nodeMin, int side, BlockType)
+			{
+				glm::ivec3 low{ glm::max(nodeMin, min) };
+				glm::ivec3 high{ glm::min(nodeMin + side - 1, max) };
+				count += static_cast<long long>(high.x - low.x + 1) * (high.y - low.y + 1) * (high.z - low.z + 1);
+				return true;
+			});
+		return count;
+	}
+
+	/*
+	* Visits every solid node overlapping a box. Nodes are reported whole, callers wanting
+	* single blocks clip them to the box
+	* Parameters:
+	* - min: World coordinates of the box's lowest corner block
+	* - max: World coordinates of the box's highest corner block, inclusive
+	* - visit: Callable taking the node's world lowest corner, its side and its BlockType
+	* Returns: void
+	*/
+	template <typename Visit>
+	void forEachSolid(const glm::ivec3& min, const glm::ivec3& max, const Visit& visit) const
+	{
+		query(min, max, [&visit](const glm::ivec3& nodeMin, int side, BlockType block)
+			{
+				visit(nodeMin, side, block);
+				return true;
+			});
+	}
+
+	glm::ivec3 getOrigin() const
+	{
+		return m_origin;
+	}
+
+	// Side of the tree's cube in blocks
+	int getSide() const
+	{
+		return m_side;
+	}
+
+	std::size_t getNodeCount() const
+	{
+		return m_nodes.size() + 1;
+	}
+
+	std::size_t memoryUsage() const
+	{
+		return sizeof(*this) + m_nodes.capacity() * sizeof(std::uint32_t);
+	}
+
+private:
+	// A node is a leaf holding its block type when the top bit is set, else the index of its first child
+	static constexpr std::uint32_t leafFlag{ 0x80000000u };
+
+	struct QueryNode
+	{
+		std::uint32_t node{};
+		glm::ivec3 min{};
+		int side{};
+	};
+
+	std::vector<std::uint32_t> m_nodes{};
+	std::uint32_t m_root{ leafFlag };
+	glm::ivec3 m_origin{};
+	glm::ivec3 m_size{};
+	int m_depth{};
+	int m_side{};
+
+	static bool isLeaf(std::uint32_t node)
+	{
+		return (node & leafFlag) != 0;
+	}
+
+	static std::uint32_t makeLeaf(BlockType block)
+	{
+		return leafFlag | static_cast<std::uint32_t>(block);
+	}
+
+	static BlockType leafBlock(std::uint32_t node)
+	{
+		return static_cast<BlockType>(node & 0xffu);
+	}
+
+	// Children are ordered by x in bit 0, y in bit 1 and z in bit 2
+	static int childIndex(const glm::ivec3& cell, int childSide)
+	{
+		return ((cell.x & childSide) != 0) | (((cell.y & childSide) != 0) << 1) | (((cell.z & childSide) != 0) << 2);
+	}
+
+	static glm::ivec3 childOffset(int child, int childSide)
+	{
+		return glm::ivec3(child & 1, (child >> 1) & 1, (child >> 2) & 1) * childSide;
+	}
+
+	bool insideTree(const glm::ivec3& cell) const
+	{
+		return cell.x >= 0 && cell.y >= 0 && cell.z >= 0 && cell.x < m_side && cell.y < m_side && cell.z < m_side;
+	}
+
+	// Builds the subtree of a cube local to the tree, collapsing children that are all one block
+	template <typename Sample, typename Uniform>
+	std::uint32_t buildNode(const glm::ivec3& min, int side, const Sample& sample, const Uniform& uniform)
+	{
+		if (min.x >= m_size.x || min.y >= m_size.y || min.z >= m_size.z)
+			return makeLeaf(BlockType::air);
+
+		const glm::ivec3 world{ min + m_origin };
+		if (side == 1)
+			return makeLeaf(sample(world.x, world.y, world.z));
+
+		BlockType block{};
+		bool inside{ min.x + side <= m_size.x && min.y + side <= m_size.y && min.z + side <= m_size.z };
+		if (inside && uniform(world, side, block))
+			return makeLeaf(block);
+
+		const int childSide{ side / 2 };
+		std::uint32_t children[8];
+		bool collapse{ true };
+		for (int child{ 0 }; child < 8; ++child)
+		{
+			children[child] = buildNode(min + childOffset(child, childSide), childSide, sample, uniform);
+			collapse = collapse && isLeaf(children[child]) && children[child] == children[0];
+		}
+		if (collapse)
+			return children[0];
+
+		std::uint32_t first{ static_cast<std::uint32_t>(m_nodes.size()) };
+		m_nodes.insert(m_nodes.end(), children, children + 8);
+		return first;
+	}
+
+	// Walks the solid leaves overlapping a box until visit returns false, returning false if it stopped early
+	template <typename Visit>
+	bool query(const glm::ivec3& min, const glm::ivec3& max, const Visit& visit) const
+	{
+		const glm::ivec3 low{ min - m_origin };
+		const glm::ivec3 high{ max - m_origin };
+		if (m_side == 0 || high.x < 0 || high.y < 0 || high.z < 0 || low.x >= m_side || low.y >= m_side || low.z >= m_side)
+			return true;
+
+		if (isLeaf(m_root))
+			return !isSolid(leafBlock(m_root)) || visit(m_origin, m_side, leafBlock(m_root));
+
+		// Depth first over interior nodes, leaves are visited straight from their parent
+		QueryNode stack[7 * maxDepth + 1];
+		int top{ 0 };
+		stack[top++] = QueryNode{ m_root, glm::ivec3(0), m_side };
+		while (top > 0)
+		{
+			const QueryNode current{ stack[--top] };
+			const int childSide{ current.side >> 1 };
+			const glm::ivec3 middle{ current.min + childSide };
+
+			// Bit 0 is set when the box reaches into the lower half of an axis, bit 1 the upper
+			int halves[3];
+			for (int a{ 0 }; a < 3; ++a)
+				halves[a] = (low[a] < middle[a] ? 1 : 0) | (high[a] >= middle[a] ? 2 : 0);
+
+			for (int child{ 0 }; child < 8; ++child)
+			{
+				if (!(halves[0] & (1 << (child & 1))) || !(halves[1] & (1 << ((child >> 1) & 1))) || !(halves[2] & (1 << (child >> 2))))
+					continue;
+
+				std::uint32_t node{ m_nodes[current.node + child] };
+				glm::ivec3 childMin{ current.min + childOffset(child, childSide) };
+				if (!isLeaf(node))
+					stack[top++] = QueryNode{ node, childMin, childSide };
+				else if (isSolid(leafBlock(node)) && !visit(childMin + m_origin, childSide, leafBlock(node)))
+					return false;
+			}
+		}
+		return true;
+	}
+};
+
+#endif